@@ -3,53 +3,48 @@
 #include <string>
 #include <filesystem>
 #include <vector>
+#include <chrono>
 
 namespace AarRtsaSdkWrapper
 {
 
     std::wstring AaroniaRtsaSdkWrapper::string_to_wstring(const std::string& str)
     {
-        try
+        std::wstring wstr(str.size(), L'\0');
+        size_t needed = Utf8ToWide(str.data(), str.size(), &wstr[0], wstr.size() + 1);
+        if (needed > wstr.size())
         {
-            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-            return converter.from_bytes(str);
-        }
-        catch (const std::range_error& e)
-        {
-            std::cerr << "Warning: string_to_wstring conversion failed for: " << str << " Error: " << e.what() << std::endl;
-            return L"";
+            // Only reachable on Windows, code points above U+FFFF take two UTF-16 units
+            wstr.resize(needed);
+            Utf8ToWide(str.data(), str.size(), &wstr[0], needed + 1);
         }
+        wstr.resize(needed);
+        return wstr;
     }
 
     std::string AaroniaRtsaSdkWrapper::wstring_to_string(const std::wstring& wstr)
     {
-        try
-        {
-            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-            return converter.to_bytes(wstr);
-        }
-        catch (const std::range_error& e)
-        {
-            std::cerr << "Warning: wstring_to_string conversion failed. Error: " << e.what() << std::endl;
-            return "";
-        }
+        std::string str;
+        WideToUtf8(wstr.data(), wstr.size(), str);
+        return str;
     }
 
     std::string AaroniaRtsaSdkWrapper::wchar_array_to_string(const wchar_t* wc_array, size_t array_capacity)
     {
-        if (!wc_array || array_capacity == 0)
-        {
-            return "";
-        }
+        std::string str;
+        wchar_array_to_string(wc_array, array_capacity, str);
+        return str;
+    }
 
-        size_t len = 0;
-        while (len < array_capacity && wc_array[len] != L'\0')
+    void AaroniaRtsaSdkWrapper::wchar_array_to_string(const wchar_t* wc_array, size_t array_capacity, std::string& str_out)
+    {
+        if (!wc_array || array_capacity == 0)
         {
-            len++;
+            str_out.clear();
+            return;
         }
 
-        std::wstring wstr_val(wc_array, len);
-        return wstring_to_string(wstr_val);
+        WideToUtf8(wc_array, WideLength(wc_array, array_capacity), str_out);
     }
 
 #if defined(_WIN32)
@@ -121,19 +116,31 @@ namespace AarRtsaSdkWrapper
 #endif
 
 
-    AaroniaRtsaSdkWrapper::AaroniaRtsaSdkWrapper(const std::string& libPathOverride)
-        : m_libHandle(nullptr), m_loadedSuccessfully(false)
+    // The override may name the library file itself or the directory containing it,
+    // e.g. the output directory of the simulated backend. Without a usable override
+    // the library is loaded from the configured installation.
+    std::string ResolveLibraryPath(const std::string& libPathOverride, const std::string& defaultDirectory)
     {
-        std::string libPathToUse = libPathOverride;
-        if (libPathToUse.empty())
+        if (!libPathOverride.empty())
         {
-           std::cerr << "Library Path not provided";
+            std::error_code ec;
+            std::filesystem::path overridePath(libPathOverride);
+            if (std::filesystem::is_regular_file(overridePath, ec))
+                return overridePath.string();
+            if (std::filesystem::is_directory(overridePath, ec))
+                return (overridePath / CFG_CPP_RTSAAPI_DLIB).string();
+
+            std::cerr << "Library path override not found: " << libPathOverride << ", using " << defaultDirectory << std::endl;
         }
+        return (std::filesystem::path(defaultDirectory) / CFG_CPP_RTSAAPI_DLIB).string();
+    }
 
-
+    AaroniaRtsaSdkWrapper::AaroniaRtsaSdkWrapper(const std::string& libPathOverride)
+        : m_libHandle(nullptr), m_loadedSuccessfully(false), m_packetRecorder(nullptr), m_recordedDevice(nullptr)
+    {
 #if defined(_WIN32)
 
-        std::string libPath = (std::filesystem::path(CFG_AARONIA_SDK_DIRECTORY) / CFG_CPP_RTSAAPI_DLIB).string();
+        std::string libPath = ResolveLibraryPath(libPathOverride, CFG_AARONIA_SDK_DIRECTORY);
 
         std::vector<std::string> depDirs = {
             CFG_AARONIA_RTSA_INSTALL_DIRECTORY
@@ -142,7 +149,7 @@ namespace AarRtsaSdkWrapper
         m_libHandle = LoadLibraryWithDependencies(libPath, depDirs);
 
 #else
-        libPathToUse = (std::filesystem::path(CFG_AARONIA_RTSA_INSTALL_DIRECTORY) / CFG_CPP_RTSAAPI_DLIB).string();
+        std::string libPathToUse = ResolveLibraryPath(libPathOverride, CFG_AARONIA_RTSA_INSTALL_DIRECTORY);
 
         m_libHandle = dlopen(libPathToUse.c_str(), RTLD_LAZY);
         if (!m_libHandle)
@@ -390,6 +397,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::Init(uint32_t memory)
     {
+        WRAPPER_PROFILE_CALL(Init);
         if (!m_Init)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_Init(memory);
@@ -397,14 +405,16 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::Init_With_Path(uint32_t memory, const std::string& pathXmlLocation)
     {
+        WRAPPER_PROFILE_CALL(Init_With_Path);
         if (!m_Init_With_Path)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
-        std::wstring wPath = string_to_wstring(pathXmlLocation);
+        WideStringBuffer wPath(pathXmlLocation);
         return m_Init_With_Path(memory, wPath.c_str());
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::Shutdown(void)
     {
+        WRAPPER_PROFILE_CALL(Shutdown);
         if (!m_Shutdown)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_Shutdown();
@@ -412,6 +422,7 @@ namespace AarRtsaSdkWrapper
 
     uint32_t AaroniaRtsaSdkWrapper::Version(void)
     {
+        WRAPPER_PROFILE_CALL(Version);
         if (!m_Version)
             return 0;
         return m_Version();
@@ -419,6 +430,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::Open(AARTSAAPI_Handle* handle)
     {
+        WRAPPER_PROFILE_CALL(Open);
         if (!m_Open)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_Open(handle);
@@ -426,6 +438,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::Close(AARTSAAPI_Handle* handle)
     {
+        WRAPPER_PROFILE_CALL(Close);
         if (!m_Close)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_Close(handle);
@@ -433,6 +446,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::RescanDevices(AARTSAAPI_Handle* handle, int timeout)
     {
+        WRAPPER_PROFILE_CALL(RescanDevices);
         if (!m_RescanDevices)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_RescanDevices(handle, timeout);
@@ -440,6 +454,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ResetDevices(AARTSAAPI_Handle* handle)
     {
+        WRAPPER_PROFILE_CALL(ResetDevices);
         if (!m_ResetDevices)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ResetDevices(handle);
@@ -447,13 +462,14 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::EnumDevice(AARTSAAPI_Handle* handle, const std::string& type, int32_t index, Wrapper_DeviceInfo* dinfo_wrapper)
     {
+        WRAPPER_PROFILE_CALL(EnumDevice);
         if (!m_EnumDevice || !dinfo_wrapper)
             return AARTSAAPI_ERROR_INVALID_PARAMETR;
 
         AARTSAAPI_DeviceInfo orig_dinfo;
         orig_dinfo.cbsize = sizeof(AARTSAAPI_DeviceInfo);
 
-        std::wstring wType = string_to_wstring(type);
+        WideStringBuffer wType(type);
         AARTSAAPI_Result res = m_EnumDevice(handle, wType.c_str(), index, &orig_dinfo);
 
         if (res == AARTSAAPI_OK)
@@ -465,22 +481,27 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::OpenDevice(AARTSAAPI_Handle* handle, AARTSAAPI_Device* dhandle, const std::string& type, const std::string& serialNumber)
     {
+        WRAPPER_PROFILE_CALL(OpenDevice);
         if (!m_OpenDevice)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
-        std::wstring wType = string_to_wstring(type);
-        std::wstring wSerial = string_to_wstring(serialNumber);
+        WideStringBuffer wType(type);
+        WideStringBuffer wSerial(serialNumber);
         return m_OpenDevice(handle, dhandle, wType.c_str(), wSerial.c_str());
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::CloseDevice(AARTSAAPI_Handle* handle, AARTSAAPI_Device* dhandle)
     {
+        WRAPPER_PROFILE_CALL(CloseDevice);
         if (!m_CloseDevice)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        if (dhandle)
+            m_configHandles.removeDevice(*dhandle);
         return m_CloseDevice(handle, dhandle);
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConnectDevice(AARTSAAPI_Device* dhandle)
     {
+        WRAPPER_PROFILE_CALL(ConnectDevice);
         if (!m_ConnectDevice)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConnectDevice(dhandle);
@@ -488,6 +509,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::DisconnectDevice(AARTSAAPI_Device* dhandle)
     {
+        WRAPPER_PROFILE_CALL(DisconnectDevice);
         if (!m_DisconnectDevice)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_DisconnectDevice(dhandle);
@@ -495,6 +517,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::StartDevice(AARTSAAPI_Device* dhandle)
     {
+        WRAPPER_PROFILE_CALL(StartDevice);
         if (!m_StartDevice)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_StartDevice(dhandle);
@@ -502,6 +525,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::StopDevice(AARTSAAPI_Device* dhandle)
     {
+        WRAPPER_PROFILE_CALL(StopDevice);
         if (!m_StopDevice)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_StopDevice(dhandle);
@@ -509,6 +533,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::GetDeviceState(AARTSAAPI_Device* dhandle)
     {
+        WRAPPER_PROFILE_CALL(GetDeviceState);
         if (!m_GetDeviceState)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_GetDeviceState(dhandle);
@@ -516,6 +541,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::AvailPackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t* num)
     {
+        WRAPPER_PROFILE_CALL(AvailPackets);
         if (!m_AvailPackets)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_AvailPackets(dhandle, channel, num);
@@ -523,22 +549,62 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::GetPacket(AARTSAAPI_Device* dhandle, int32_t channel, int32_t index, AARTSAAPI_Packet* packet)
     {
+        WRAPPER_PROFILE_CALL(GetPacket);
         if (!m_GetPacket)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         if (packet)
             packet->cbsize = sizeof(AARTSAAPI_Packet);
-        return m_GetPacket(dhandle, channel, index, packet);
+        AARTSAAPI_Result res = m_GetPacket(dhandle, channel, index, packet);
+        if (res == AARTSAAPI_OK && m_packetRecorder && dhandle && dhandle->d == m_recordedDevice)
+            recordPackets(dhandle, channel, index + 1);
+        return res;
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConsumePackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t num)
     {
+        WRAPPER_PROFILE_CALL(ConsumePackets);
         if (!m_ConsumePackets)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
-        return m_ConsumePackets(dhandle, channel, num);
+        if (!m_packetRecorder || !dhandle || dhandle->d != m_recordedDevice)
+            return m_ConsumePackets(dhandle, channel, num);
+
+        // Packets dropped without being read are part of the session as well
+        recordPackets(dhandle, channel, num);
+        AARTSAAPI_Result res = m_ConsumePackets(dhandle, channel, num);
+        if (res == AARTSAAPI_OK)
+            m_packetRecorder->consumed(channel, num);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::WaitPacket(AARTSAAPI_Device* dhandle, int32_t channel, AARTSAAPI_Packet* packet, PacketWaiter& waiter,
+        std::chrono::nanoseconds timeout, const CancelToken* cancel)
+    {
+        if (!m_GetPacket)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        return waiter.wait([&]() { return GetPacket(dhandle, channel, 0, packet); }, timeout, cancel);
+    }
+
+    void AaroniaRtsaSdkWrapper::setPacketRecorder(AARTSAAPI_Device* dhandle, PacketRecorder* recorder)
+    {
+        m_packetRecorder = recorder;
+        m_recordedDevice = recorder && dhandle ? dhandle->d : nullptr;
+    }
+
+    void AaroniaRtsaSdkWrapper::recordPackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t upto)
+    {
+        for (int32_t i = m_packetRecorder->recordedAhead(channel); i < upto; i++)
+        {
+            AARTSAAPI_Packet packet;
+            packet.cbsize = sizeof(AARTSAAPI_Packet);
+            if (m_GetPacket(dhandle, channel, i, &packet) != AARTSAAPI_OK)
+                break;
+            m_packetRecorder->record(channel, packet);
+        }
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::GetMasterStreamTime(AARTSAAPI_Device* dhandle, double& stime)
     {
+        WRAPPER_PROFILE_CALL(GetMasterStreamTime);
         if (!m_GetMasterStreamTime)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_GetMasterStreamTime(dhandle, &stime);
@@ -546,6 +612,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::SendPacket(AARTSAAPI_Device* dhandle, int32_t channel, const AARTSAAPI_Packet* packet)
     {
+        WRAPPER_PROFILE_CALL(SendPacket);
         if (!m_SendPacket)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_SendPacket(dhandle, channel, packet);
@@ -553,6 +620,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigRoot(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config)
     {
+        WRAPPER_PROFILE_CALL(ConfigRoot);
         if (!m_ConfigRoot)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigRoot(dhandle, config);
@@ -560,6 +628,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigHealth(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config)
     {
+        WRAPPER_PROFILE_CALL(ConfigHealth);
         if (!m_ConfigHealth)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigHealth(dhandle, config);
@@ -567,6 +636,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigFirst(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config)
     {
+        WRAPPER_PROFILE_CALL(ConfigFirst);
         if (!m_ConfigFirst)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigFirst(dhandle, group, config);
@@ -574,6 +644,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigNext(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config)
     {
+        WRAPPER_PROFILE_CALL(ConfigNext);
         if (!m_ConfigNext)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigNext(dhandle, group, config);
@@ -581,14 +652,16 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigFind(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config, const std::string& name)
     {
+        WRAPPER_PROFILE_CALL(ConfigFind);
         if (!m_ConfigFind)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
-        std::wstring wName = string_to_wstring(name);
+        WideStringBuffer wName(name);
         return m_ConfigFind(dhandle, group, config, wName.c_str());
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetName(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::string& name_out)
     {
+        WRAPPER_PROFILE_CALL(ConfigGetName);
         if (!m_ConfigGetName)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         wchar_t temp_name_buffer[256];
@@ -596,7 +669,7 @@ namespace AarRtsaSdkWrapper
 
         if (res == AARTSAAPI_OK)
         {
-            name_out = wchar_array_to_string(temp_name_buffer, sizeof(temp_name_buffer) / sizeof(wchar_t));
+            wchar_array_to_string(temp_name_buffer, sizeof(temp_name_buffer) / sizeof(wchar_t), name_out);
         }
         else
         {
@@ -607,6 +680,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetInfo(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, Wrapper_ConfigInfo* cinfo_wrapper)
     {
+        WRAPPER_PROFILE_CALL(ConfigGetInfo);
         if (!m_ConfigGetInfo || !cinfo_wrapper)
             return AARTSAAPI_ERROR_INVALID_PARAMETR;
 
@@ -624,6 +698,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigSetFloat(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, double value)
     {
+        WRAPPER_PROFILE_CALL(ConfigSetFloat);
         if (!m_ConfigSetFloat)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigSetFloat(dhandle, config, value);
@@ -631,6 +706,7 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetFloat(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, double* value)
     {
+        WRAPPER_PROFILE_CALL(ConfigGetFloat);
         if (!m_ConfigGetFloat)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigGetFloat(dhandle, config, value);
@@ -638,52 +714,106 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigSetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, const std::string& value)
     {
+        WRAPPER_PROFILE_CALL(ConfigSetString);
         if (!m_ConfigSetString)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
-        std::wstring wValue = string_to_wstring(value);
+        WideStringBuffer wValue(value);
         return m_ConfigSetString(dhandle, config, wValue.c_str());
     }
 
-    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::string& value_out)
+    namespace
     {
-        if (!m_ConfigGetString)
-            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        // Scratch space of the string_view ConfigGetString, it keeps the size of the
+        // longest value read on this thread so the SDK is usually called only once.
+        struct ConfigStringScratch
+        {
+            std::vector<wchar_t> wide;
+            std::string narrow;
+        };
 
-        value_out.clear();
-        int64_t required_wchars = 0;
+        thread_local ConfigStringScratch t_configStringScratch;
 
-        AARTSAAPI_Result res = m_ConfigGetString(dhandle, config, nullptr, &required_wchars);
+        // Wide buffer of the std::string ConfigGetString, separate so it leaves the
+        // views of the string_view overload alone
+        thread_local std::vector<wchar_t> t_configStringWide;
 
-        if (res == AARTSAAPI_OK && required_wchars == 0)
+        // Reads a config string into wide, growing it to the size the SDK reports
+        template <typename GetString>
+        AARTSAAPI_Result readConfigString(GetString getString, AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::vector<wchar_t>& wide)
         {
-            return AARTSAAPI_OK;
-        }
+            if (wide.empty())
+                wide.resize(256);
 
-        if (res != AARTSAAPI_ERROR_BUFFER_SIZE && res != AARTSAAPI_OK)
-        {
+            int64_t size = int64_t(wide.size());
+            AARTSAAPI_Result res = getString(dhandle, config, wide.data(), &size);
+
+            if (res == AARTSAAPI_ERROR_BUFFER_SIZE && size > int64_t(wide.size()))
+            {
+                // Longer than anything read before, the SDK reported the required size
+                wide.resize(static_cast<size_t>(size));
+                size = int64_t(wide.size());
+                res = getString(dhandle, config, wide.data(), &size);
+            }
             return res;
         }
 
-        if (required_wchars <= 0)
+        inline void rememberFloat(Wrapper_ConfigValue& v, double value)
         {
-            return AARTSAAPI_OK;
+            v.type = Wrapper_ConfigValue::Float;
+            v.number = value;
         }
 
-        std::vector<wchar_t> buffer(static_cast<size_t>(required_wchars) + 1);
-        int64_t buffer_capacity_for_api = required_wchars;
-
-        res = m_ConfigGetString(dhandle, config, buffer.data(), &buffer_capacity_for_api);
+        inline void rememberInteger(Wrapper_ConfigValue& v, int64_t value)
+        {
+            v.type = Wrapper_ConfigValue::Integer;
+            v.integer = value;
+        }
 
-        if (res == AARTSAAPI_OK)
+        inline void rememberString(Wrapper_ConfigValue& v, std::string_view value)
         {
-            value_out = wchar_array_to_string(buffer.data(), static_cast<size_t>(buffer_capacity_for_api));
+            v.type = Wrapper_ConfigValue::String;
+            v.text.assign(value);
         }
+    }
 
-        return res;
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::string& value_out)
+    {
+        WRAPPER_PROFILE_CALL(ConfigGetString);
+        if (!m_ConfigGetString)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+
+        std::vector<wchar_t>& wide = t_configStringWide;
+        AARTSAAPI_Result res = readConfigString(m_ConfigGetString, dhandle, config, wide);
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        WideToUtf8(wide.data(), WideLength(wide.data(), wide.size()), value_out);
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::string_view* value_out)
+    {
+        WRAPPER_PROFILE_CALL(ConfigGetString);
+        if (!m_ConfigGetString)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        if (!value_out)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+
+        *value_out = std::string_view();
+
+        ConfigStringScratch& scratch = t_configStringScratch;
+        AARTSAAPI_Result res = readConfigString(m_ConfigGetString, dhandle, config, scratch.wide);
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        WideToUtf8(scratch.wide.data(), WideLength(scratch.wide.data(), scratch.wide.size()), scratch.narrow);
+        *value_out = scratch.narrow;
+        return AARTSAAPI_OK;
     }
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigSetInteger(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, int64_t value)
     {
+        WRAPPER_PROFILE_CALL(ConfigSetInteger);
         if (!m_ConfigSetInteger)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigSetInteger(dhandle, config, value);
@@ -691,8 +821,194 @@ namespace AarRtsaSdkWrapper
 
     AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetInteger(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, int64_t* value)
     {
+        WRAPPER_PROFILE_CALL(ConfigGetInteger);
         if (!m_ConfigGetInteger)
             return AARTSAAPI_ERROR_NOT_INITIALIZED;
         return m_ConfigGetInteger(dhandle, config, value);
     }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigResolve(AARTSAAPI_Device* dhandle, const std::string& path, Wrapper_ConfigHandle* handle)
+    {
+        if (!m_ConfigRoot || !m_ConfigFind)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        if (!dhandle || !handle)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+
+        if (m_configHandles.find(*dhandle, path, handle))
+            return AARTSAAPI_OK;
+
+        AARTSAAPI_Config root, config;
+        AARTSAAPI_Result res = m_ConfigRoot(dhandle, &root);
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        WideStringBuffer wPath(path);
+        res = m_ConfigFind(dhandle, &root, &config, wPath.c_str());
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        *handle = m_configHandles.insert(*dhandle, path, config);
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigSetFloat(Wrapper_ConfigHandle handle, double value)
+    {
+        WRAPPER_PROFILE_CALL(ConfigSetFloat);
+        if (!m_ConfigSetFloat)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = m_ConfigSetFloat(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberFloat(entry->lastValue, value);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetFloat(Wrapper_ConfigHandle handle, double* value)
+    {
+        WRAPPER_PROFILE_CALL(ConfigGetFloat);
+        if (!m_ConfigGetFloat)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = m_ConfigGetFloat(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberFloat(entry->lastValue, *value);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigSetString(Wrapper_ConfigHandle handle, const std::string& value)
+    {
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = ConfigSetString(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberString(entry->lastValue, value);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetString(Wrapper_ConfigHandle handle, std::string& value)
+    {
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = ConfigGetString(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberString(entry->lastValue, value);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetString(Wrapper_ConfigHandle handle, std::string_view* value)
+    {
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = ConfigGetString(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberString(entry->lastValue, *value);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigSetInteger(Wrapper_ConfigHandle handle, int64_t value)
+    {
+        WRAPPER_PROFILE_CALL(ConfigSetInteger);
+        if (!m_ConfigSetInteger)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = m_ConfigSetInteger(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberInteger(entry->lastValue, value);
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ConfigGetInteger(Wrapper_ConfigHandle handle, int64_t* value)
+    {
+        WRAPPER_PROFILE_CALL(ConfigGetInteger);
+        if (!m_ConfigGetInteger)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        ConfigHandleTable::Entry* entry = m_configHandles.lookup(handle);
+        if (!entry)
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        AARTSAAPI_Result res = m_ConfigGetInteger(&entry->dhandle, &entry->config, value);
+        if (res == AARTSAAPI_OK)
+            rememberInteger(entry->lastValue, *value);
+        return res;
+    }
+
+    void AaroniaRtsaSdkWrapper::ConfigForgetValues(AARTSAAPI_Device* dhandle)
+    {
+        if (dhandle)
+            m_configHandles.forgetValues(*dhandle);
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::ApplyProfile(AARTSAAPI_Device* dhandle, const ConfigProfile& profile, Wrapper_ProfileApplyReport* report)
+    {
+        Wrapper_ProfileApplyReport localReport;
+        Wrapper_ProfileApplyReport& r = report ? *report : localReport;
+        r = Wrapper_ProfileApplyReport();
+
+        auto start = std::chrono::steady_clock::now();
+        AARTSAAPI_Result res = AARTSAAPI_OK;
+
+        for (const ConfigProfile::Item& item : profile.items())
+        {
+            Wrapper_ConfigHandle handle;
+            res = ConfigResolve(dhandle, item.path, &handle);
+            if (res == AARTSAAPI_OK)
+                res = applyProfileItem(handle, item.value, r);
+            if (res != AARTSAAPI_OK)
+            {
+                r.failedPath = item.path;
+                break;
+            }
+        }
+
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return res;
+    }
+
+    AARTSAAPI_Result AaroniaRtsaSdkWrapper::applyProfileItem(Wrapper_ConfigHandle handle, const Wrapper_ConfigValue& value, Wrapper_ProfileApplyReport& report)
+    {
+        // First time this item is seen with this type, a read is cheaper than a
+        // redundant write that may retune the hardware. Strings are read into
+        // a string of their own, so views from the caller's last string_view
+        // read stay valid.
+        if (m_configHandles.lookup(handle)->lastValue.type != value.type)
+        {
+            double number;
+            int64_t integer;
+            std::string text;
+            switch (value.type)
+            {
+            case Wrapper_ConfigValue::Float: ConfigGetFloat(handle, &number); break;
+            case Wrapper_ConfigValue::Integer: ConfigGetInteger(handle, &integer); break;
+            case Wrapper_ConfigValue::String: ConfigGetString(handle, text); break;
+            default: return AARTSAAPI_ERROR_INVALID_PARAMETR;
+            }
+        }
+
+        if (m_configHandles.lookup(handle)->lastValue == value)
+        {
+            report.skipped++;
+            return AARTSAAPI_OK;
+        }
+
+        AARTSAAPI_Result res;
+        switch (value.type)
+        {
+        case Wrapper_ConfigValue::Float: res = ConfigSetFloat(handle, value.number); break;
+        case Wrapper_ConfigValue::Integer: res = ConfigSetInteger(handle, value.integer); break;
+        case Wrapper_ConfigValue::String: res = ConfigSetString(handle, value.text); break;
+        default: return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        }
+
+        if (res == AARTSAAPI_OK)
+            report.written++;
+        return res;
+    }
 }
\ No newline at end of file
@@ -2,13 +2,18 @@
 #define AARONIARTSAWRAPPER_H
 
 #include "helper.h"
+#include "CallProfiler.h"
+#include "ConfigHandleTable.h"
+#include "ConfigProfile.h"
+#include "PacketRecording.h"
+#include "PacketWait.h"
+#include "StringTranscoder.h"
 #include <aaroniartsaapi.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <stdexcept>
-#include <locale>
-#include <codecvt>
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -70,6 +75,7 @@ namespace AarRtsaSdkWrapper
         static std::wstring string_to_wstring(const std::string& str);
         static std::string wstring_to_string(const std::wstring& wstr);
         static std::string wchar_array_to_string(const wchar_t* wc_array, size_t array_capacity);
+        static void wchar_array_to_string(const wchar_t* wc_array, size_t array_capacity, std::string& str_out);
 
         AARTSAAPI_Result Init(uint32_t memory);
         AARTSAAPI_Result Init_With_Path(uint32_t memory, const std::string& pathXmlLocation);
@@ -94,9 +100,18 @@ namespace AarRtsaSdkWrapper
         AARTSAAPI_Result AvailPackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t* num);
         AARTSAAPI_Result GetPacket(AARTSAAPI_Device* dhandle, int32_t channel, int32_t index, AARTSAAPI_Packet* packet);
         AARTSAAPI_Result ConsumePackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t num);
+
+        // GetPacket of the first queued packet, waiting for it with the policy of
+        // waiter. Returns AARTSAAPI_EMPTY on timeout or cancellation.
+        AARTSAAPI_Result WaitPacket(AARTSAAPI_Device* dhandle, int32_t channel, AARTSAAPI_Packet* packet, PacketWaiter& waiter,
+            std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max(), const CancelToken* cancel = nullptr);
         AARTSAAPI_Result GetMasterStreamTime(AARTSAAPI_Device* dhandle, double& stime);
         AARTSAAPI_Result SendPacket(AARTSAAPI_Device* dhandle, int32_t channel, const AARTSAAPI_Packet* packet);
 
+        // Record every packet of the device read or consumed through this wrapper,
+        // a null recorder stops recording. Replay with the simulated backend.
+        void setPacketRecorder(AARTSAAPI_Device* dhandle, PacketRecorder* recorder);
+
         AARTSAAPI_Result ConfigRoot(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config);
         AARTSAAPI_Result ConfigHealth(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config);
         AARTSAAPI_Result ConfigFirst(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config);
@@ -110,15 +125,52 @@ namespace AarRtsaSdkWrapper
         AARTSAAPI_Result ConfigGetFloat(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, double* value);
 
         AARTSAAPI_Result ConfigSetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, const std::string& value);
+        // Leaves value unchanged on errors and does not touch the views of the overload below
         AARTSAAPI_Result ConfigGetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::string& value);
 
+        // Returns a view into a per thread scratch buffer, valid until the next string_view
+        // ConfigGetString on the same thread. Does not allocate once the buffer has grown
+        // to the longest value read, e.g. for health pollers.
+        AARTSAAPI_Result ConfigGetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, std::string_view* value);
+
         AARTSAAPI_Result ConfigSetInteger(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, int64_t value);
         AARTSAAPI_Result ConfigGetInteger(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, int64_t* value);
 
+        // Resolve a path below the config root once per device, e.g. "main/centerfreq".
+        // The handle based accessors then skip the string conversion and the tree walk.
+        // Handles become invalid when their device is closed. Resolve during setup, the
+        // table must not be modified while other threads use handles.
+        AARTSAAPI_Result ConfigResolve(AARTSAAPI_Device* dhandle, const std::string& path, Wrapper_ConfigHandle* handle);
+
+        AARTSAAPI_Result ConfigSetFloat(Wrapper_ConfigHandle handle, double value);
+        AARTSAAPI_Result ConfigGetFloat(Wrapper_ConfigHandle handle, double* value);
+
+        AARTSAAPI_Result ConfigSetString(Wrapper_ConfigHandle handle, const std::string& value);
+        AARTSAAPI_Result ConfigGetString(Wrapper_ConfigHandle handle, std::string& value);
+        AARTSAAPI_Result ConfigGetString(Wrapper_ConfigHandle handle, std::string_view* value);
+
+        AARTSAAPI_Result ConfigSetInteger(Wrapper_ConfigHandle handle, int64_t value);
+        AARTSAAPI_Result ConfigGetInteger(Wrapper_ConfigHandle handle, int64_t* value);
+
+        // Apply all items of a profile, resolving their paths to handles. The handle
+        // accessors remember the last value written or read, items that already hold
+        // the requested value are skipped. Stops at the first failing item. Does not
+        // touch the views of the string_view ConfigGetString.
+        AARTSAAPI_Result ApplyProfile(AARTSAAPI_Device* dhandle, const ConfigProfile& profile, Wrapper_ProfileApplyReport* report = nullptr);
+
+        // Drop the remembered values of a device, e.g. after writing items by path
+        void ConfigForgetValues(AARTSAAPI_Device* dhandle);
+
     private:
+        AARTSAAPI_Result applyProfileItem(Wrapper_ConfigHandle handle, const Wrapper_ConfigValue& value, Wrapper_ProfileApplyReport& report);
+        void recordPackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t upto);
+
         LibHandleType m_libHandle;
         bool m_loadedSuccessfully;
         std::map<AARTSAAPI_Result, std::string> m_errorMessages;
+        ConfigHandleTable m_configHandles;
+        PacketRecorder* m_packetRecorder;
+        void* m_recordedDevice;
 
         template <typename T>
         T loadFunction(const char* funcName);
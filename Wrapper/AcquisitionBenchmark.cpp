@@ -0,0 +1,119 @@
+#include "BenchmarkSupport.h"
+#include "PacketAcquisition.h"
+#include <iomanip>
+
+// Runs a consumer with a short per packet cost and a periodic stall, like a file
+// flush, on a raw IQ stream. Once reading the SDK queue directly, where a stall
+// lets the SDK queue overflow, and once behind a PacketAcquisition ring that
+// absorbs it.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const int StallEvery = 2000;       // packets between two stalls
+
+    void busyFor(std::chrono::steady_clock::duration duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+            ;
+    }
+
+    struct ConsumerResult
+    {
+        uint64_t packets = 0;
+        ContinuityMonitor monitor;
+    };
+
+    void consume(const AARTSAAPI_Packet& packet, ConsumerResult& result, std::chrono::microseconds work, std::chrono::milliseconds stall)
+    {
+        result.monitor.check(packet);
+        DoNotOptimize(packet.fp32[0]);
+        busyFor(work);
+        if (++result.packets % StallEvery == 0)
+            busyFor(stall);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const double seconds = NumberArgument<double>(argc, argv, 2, 3.0);
+    const std::chrono::milliseconds stall(NumberArgument<int>(argc, argv, 3, 40));
+    const std::chrono::microseconds work(2);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+    if (!bench.isOpen())
+        return -1;
+    AARTSAAPI_Device* d = bench.device();
+
+    // About 10 packets per millisecond, a stall longer than 25 ms overflows the
+    // SDK queue of the medium memory setting
+    Wrapper_ConfigHandle decimation;
+    if (sdkWrapper.ConfigResolve(d, "main/decimation", &decimation) != AARTSAAPI_OK || sdkWrapper.ConfigSetString(decimation, "1 / 4") != AARTSAAPI_OK)
+    {
+        std::cerr << "Setting main/decimation failed" << std::endl;
+        return -1;
+    }
+    if (bench.connectAndStart() != AARTSAAPI_OK)
+        return -1;
+
+    // Direct: GetPacket, process, ConsumePackets
+
+    ConsumerResult direct;
+    {
+        PacketWaiter waiter(PacketWaitPolicy::Spin);
+        AARTSAAPI_Packet packet;
+        auto start = std::chrono::steady_clock::now();
+        while (SecondsSince(start) < seconds)
+        {
+            if (sdkWrapper.WaitPacket(d, 0, &packet, waiter, std::chrono::seconds(1)) != AARTSAAPI_OK)
+                break;
+            consume(packet, direct, work, stall);
+            sdkWrapper.ConsumePackets(d, 0, 1);
+        }
+    }
+
+    // Acquisition thread with a ring of 4096 packets in front of the consumer
+
+    int32_t queued = 0;
+    if (sdkWrapper.AvailPackets(d, 0, &queued) == AARTSAAPI_OK && queued > 0)
+        sdkWrapper.ConsumePackets(d, 0, queued);
+
+    PacketAcquisitionSettings settings;
+    settings.ringPackets = 4096;
+    PacketAcquisition acquisition(sdkWrapper, d, 0, settings);
+
+    ConsumerResult ring;
+    {
+        PacketWaiter waiter(PacketWaitPolicy::Yield);
+        const AARTSAAPI_Packet* packet;
+        acquisition.start();
+        auto start = std::chrono::steady_clock::now();
+        while (SecondsSince(start) < seconds)
+        {
+            if (acquisition.wait(&packet, waiter, std::chrono::seconds(1)) != AARTSAAPI_OK)
+                break;
+            consume(*packet, ring, work, stall);
+            acquisition.release();
+        }
+        acquisition.stop();
+    }
+    PacketAcquisitionStatistics stats = acquisition.statistics();
+    ContinuityStatistics directGaps = direct.monitor.statistics(), ringGaps = ring.monitor.statistics();
+
+    std::cout << "Consumer      : " << work.count() << " us per packet, " << stall.count() << " ms stall every " << StallEvery << " packets" << std::endl
+        << "Direct        : " << direct.packets << " packets, " << directGaps.gaps << " gaps, " << directGaps.droppedSamples << " samples lost" << std::endl
+        << "Ring          : " << ring.packets << " packets, " << ringGaps.gaps << " gaps, " << ringGaps.droppedSamples << " samples lost ("
+        << stats.hardwareGaps << " device side, " << stats.overruns << " ring overruns), high water "
+        << stats.highWater << " of " << stats.capacity << std::endl;
+
+    return 0;
+}
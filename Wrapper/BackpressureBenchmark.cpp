@@ -0,0 +1,112 @@
+#include "BenchmarkSupport.h"
+#include "PacketDistributor.h"
+#include <iomanip>
+#include <thread>
+
+// Feeds one raw IQ stream to two consumers through a PacketDistributor: a
+// recorder that keeps up and must see every packet, and a display that handles
+// only about a fifth of the packets. Runs once per backpressure policy of the
+// display and shows what each consumer got and what was discarded for whom.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    void busyFor(std::chrono::steady_clock::duration duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+            ;
+    }
+
+    // Reads until the producer ended, work is the cost per packet
+    void consumeAll(PacketConsumer& consumer, std::chrono::microseconds work, ContinuityMonitor& monitor)
+    {
+        PacketWaiter waiter(PacketWaitPolicy::Yield);
+        const AARTSAAPI_Packet* packet;
+        while (consumer.wait(&packet, waiter, std::chrono::seconds(1)) == AARTSAAPI_OK)
+        {
+            monitor.check(*packet);
+            DoNotOptimize(packet->fp32[0]);
+            busyFor(work);
+            consumer.release();
+        }
+    }
+
+    const char* policyName(BackpressurePolicy policy)
+    {
+        switch (policy)
+        {
+        case BackpressurePolicy::Block: return "Block";
+        case BackpressurePolicy::DropOldest: return "DropOldest";
+        case BackpressurePolicy::DropNewest: return "DropNewest";
+        default: return "Decimate 8";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const double seconds = NumberArgument<double>(argc, argv, 2, 2.0);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+    if (!bench.isOpen())
+        return -1;
+    AARTSAAPI_Device* d = bench.device();
+
+    // About 10 packets per millisecond, the display manages about 2
+    Wrapper_ConfigHandle decimation;
+    if (sdkWrapper.ConfigResolve(d, "main/decimation", &decimation) != AARTSAAPI_OK || sdkWrapper.ConfigSetString(decimation, "1 / 4") != AARTSAAPI_OK)
+    {
+        std::cerr << "Setting main/decimation failed" << std::endl;
+        return -1;
+    }
+    if (bench.connectAndStart() != AARTSAAPI_OK)
+        return -1;
+
+    std::cout << std::left << std::setw(12) << "Display" << std::right
+        << std::setw(12) << "recorder" << std::setw(11) << "lost" << std::setw(10) << "display"
+        << std::setw(9) << "oldest" << std::setw(9) << "newest" << std::setw(11) << "decimated"
+        << std::setw(11) << "blocked s" << std::setw(12) << "SDK gaps" << std::endl;
+
+    for (BackpressurePolicy policy : { BackpressurePolicy::Block, BackpressurePolicy::DropOldest, BackpressurePolicy::DropNewest, BackpressurePolicy::Decimate })
+    {
+        int32_t queued = 0;
+        if (sdkWrapper.AvailPackets(d, 0, &queued) == AARTSAAPI_OK && queued > 0)
+            sdkWrapper.ConsumePackets(d, 0, queued);
+
+        PacketDistributor distributor;
+        PacketConsumer& recorder = distributor.addConsumer(PacketConsumerSettings(BackpressurePolicy::Block, 4096));
+        PacketConsumer& display = distributor.addConsumer(PacketConsumerSettings(policy, 64, 8));
+
+        PacketAcquisitionSettings settings;
+        settings.ringPackets = 1;
+        settings.distributor = &distributor;
+        PacketAcquisition acquisition(sdkWrapper, d, 0, settings);
+
+        ContinuityMonitor recorded, displayed;
+        acquisition.start();
+        std::thread recorderThread(consumeAll, std::ref(recorder), std::chrono::microseconds(1), std::ref(recorded));
+        std::thread displayThread(consumeAll, std::ref(display), std::chrono::microseconds(500), std::ref(displayed));
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        acquisition.stop();
+        recorderThread.join();
+        displayThread.join();
+
+        PacketConsumerStatistics r = recorder.statistics(), s = display.statistics();
+        std::cout << std::left << std::setw(12) << policyName(policy) << std::right << std::fixed << std::setprecision(2)
+            << std::setw(12) << r.read << std::setw(11) << recorded.statistics().droppedSamples << std::setw(10) << s.read
+            << std::setw(9) << s.droppedOldest << std::setw(9) << s.droppedNewest << std::setw(11) << s.decimated
+            << std::setw(11) << s.blockedSeconds << std::setw(12) << acquisition.statistics().hardwareGaps << std::endl;
+    }
+
+    std::cout << "recorder: packets read, lost: samples missing in what it read, SDK gaps: losses before the host" << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "BenchmarkSupport.h"
+#include "PacketBatch.h"
+#include <iomanip>
+
+// Reads small IQ packets from an unpaced stream, once one packet at a time like
+// RawIQ::streamIQ with a GetPacket and ConsumePackets per packet, and once with
+// PacketBatchReader at several batch sizes. The simulated backend spends most
+// of its time generating packets, against it the saved calls show less than
+// against a device.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    // Touches every packet like a consumer would
+    inline void process(const AARTSAAPI_Packet& packet, double& sum)
+    {
+        sum += packet.fp32[0] + packet.fp32[2 * (packet.num - 1)];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const int packets = NumberArgument<int>(argc, argv, 2, 200000);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+    if (!bench.isOpen())
+        return -1;
+    AARTSAAPI_Device* d = bench.device();
+
+    // The simulated backend delivers as fast as it is read with its smallest packets,
+    // so the SDK calls per packet dominate. On a device the packet rate follows the clock.
+    Wrapper_ConfigHandle pacing, packetSamples;
+    if (sdkWrapper.ConfigResolve(d, "simulator/pacing", &pacing) == AARTSAAPI_OK)
+        sdkWrapper.ConfigSetString(pacing, "Unlimited");
+    if (sdkWrapper.ConfigResolve(d, "simulator/packetsamples", &packetSamples) == AARTSAAPI_OK)
+        sdkWrapper.ConfigSetInteger(packetSamples, 16);
+    if (bench.connectAndStart() != AARTSAAPI_OK)
+        return -1;
+
+    double sum = 0;
+
+    // One at a time
+
+    AARTSAAPI_Packet packet;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < packets; i++)
+    {
+        AARTSAAPI_Result res;
+        while ((res = sdkWrapper.GetPacket(d, 0, 0, &packet)) == AARTSAAPI_EMPTY)
+            ;
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "GetPacket failed: " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+        process(packet, sum);
+        sdkWrapper.ConsumePackets(d, 0, 1);
+    }
+    double singleRate = packets / SecondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(0)
+        << "One at a time : " << singleRate << " packets/s, 2.00 SDK calls per packet" << std::endl;
+
+    for (size_t batchSize : { 8, 64, 256 })
+    {
+        PacketBatchSettings settings;
+        settings.maxPackets = batchSize;
+        PacketBatchReader reader(sdkWrapper, d, 0, settings);
+
+        start = std::chrono::steady_clock::now();
+        while (reader.packetsRead() < uint64_t(packets))
+        {
+            AARTSAAPI_Result res = reader.next(std::chrono::seconds(1));
+            if (res != AARTSAAPI_OK)
+            {
+                std::cerr << "PacketBatchReader::next failed: " << sdkWrapper.getErrorString(res) << std::endl;
+                return -1;
+            }
+            for (const AARTSAAPI_Packet& p : reader.packets())
+                process(p, sum);
+        }
+        reader.retire();
+        double rate = reader.packetsRead() / SecondsSince(start);
+
+        // AvailPackets polls, one GetPacket per packet and one ConsumePackets per batch
+        uint64_t calls = reader.batches() + reader.waiter().statistics().polls + reader.packetsRead() + reader.batches();
+
+        std::cout << "Batch " << std::setw(3) << batchSize << "     : " << rate << " packets/s, "
+            << std::setprecision(2) << double(calls) / reader.packetsRead() << " SDK calls per packet, "
+            << rate / singleRate << "x" << std::setprecision(0) << std::endl;
+    }
+
+    DoNotOptimize(sum);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#ifndef BENCHMARKSUPPORT_H
+#define BENCHMARKSUPPORT_H
+
+#include "AaroniaRtsaSdkWrapper.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Opens a device for the benchmark programs and releases device, handle and
+    // library again on destruction. Benchmarks take the library path override as
+    // first argument, so they can run against the simulated backend.
+    class BenchmarkDevice
+    {
+    public:
+        BenchmarkDevice(AaroniaRtsaSdkWrapper& sdkWrapper, const std::string& family, const std::string& mode, int32_t index = 0)
+            : m_sdkWrapper(sdkWrapper), m_initialized(false), m_handleOpen(false), m_deviceOpen(false), m_connected(false), m_started(false)
+        {
+            AARTSAAPI_Result res;
+
+            if ((res = m_sdkWrapper.Init_With_Path(AARTSAAPI_MEMORY_MEDIUM, CFG_AARONIA_XML_LOOKUP_DIRECTORY)) != AARTSAAPI_OK)
+            {
+                std::cerr << "AARTSAAPI_Init_With_Path failed: " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return;
+            }
+            m_initialized = true;
+
+            if ((res = m_sdkWrapper.Open(&m_handle)) != AARTSAAPI_OK)
+            {
+                std::cerr << "AARTSAAPI_Open failed: " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return;
+            }
+            m_handleOpen = true;
+
+            res = m_sdkWrapper.RescanDevices(&m_handle, 2000);
+            if (res != AARTSAAPI_OK && res != AARTSAAPI_RETRY)
+            {
+                std::cerr << "AARTSAAPI_RescanDevices failed: " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return;
+            }
+
+            if ((res = m_sdkWrapper.EnumDevice(&m_handle, family, index, &m_info)) != AARTSAAPI_OK)
+            {
+                std::cerr << "AARTSAAPI_EnumDevice failed for '" << family << "': " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return;
+            }
+
+            if ((res = m_sdkWrapper.OpenDevice(&m_handle, &m_device, family + "/" + mode, m_info.serialNumber)) != AARTSAAPI_OK)
+            {
+                std::cerr << "AARTSAAPI_OpenDevice failed for S/N " << m_info.serialNumber << ": " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return;
+            }
+            m_deviceOpen = true;
+        }
+
+        ~BenchmarkDevice()
+        {
+            if (m_started)
+                m_sdkWrapper.StopDevice(&m_device);
+            if (m_connected)
+                m_sdkWrapper.DisconnectDevice(&m_device);
+            if (m_deviceOpen)
+                m_sdkWrapper.CloseDevice(&m_handle, &m_device);
+            if (m_handleOpen)
+                m_sdkWrapper.Close(&m_handle);
+            if (m_initialized)
+                m_sdkWrapper.Shutdown();
+        }
+
+        BenchmarkDevice(const BenchmarkDevice&) = delete;
+        BenchmarkDevice& operator=(const BenchmarkDevice&) = delete;
+
+        bool isOpen() const { return m_deviceOpen; }
+
+        AARTSAAPI_Handle* handle() { return &m_handle; }
+        AARTSAAPI_Device* device() { return &m_device; }
+        const Wrapper_DeviceInfo& info() const { return m_info; }
+
+        AARTSAAPI_Result connectAndStart()
+        {
+            AARTSAAPI_Result res;
+            if ((res = m_sdkWrapper.ConnectDevice(&m_device)) != AARTSAAPI_OK)
+            {
+                std::cerr << "AARTSAAPI_ConnectDevice failed: " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return res;
+            }
+            m_connected = true;
+
+            if ((res = m_sdkWrapper.StartDevice(&m_device)) != AARTSAAPI_OK)
+            {
+                std::cerr << "AARTSAAPI_StartDevice failed: " << m_sdkWrapper.getErrorString(res) << std::endl;
+                return res;
+            }
+            m_started = true;
+            return AARTSAAPI_OK;
+        }
+
+    private:
+        AaroniaRtsaSdkWrapper& m_sdkWrapper;
+        AARTSAAPI_Handle m_handle;
+        AARTSAAPI_Device m_device;
+        Wrapper_DeviceInfo m_info;
+        bool m_initialized, m_handleOpen, m_deviceOpen, m_connected, m_started;
+    };
+
+    inline double SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Numeric argument at index, fallback when there are fewer arguments. Exits
+    // with a message if it is not a number, e.g. a library path passed to one of
+    // the benchmarks that need no device.
+    template <typename T>
+    T NumberArgument(int argc, char* argv[], int index, T fallback)
+    {
+        if (argc <= index)
+            return fallback;
+        char* end = nullptr;
+        double value = std::strtod(argv[index], &end);
+        if (end == argv[index] || *end != 0)
+        {
+            std::cerr << argv[0] << ": argument " << index << " \"" << argv[index] << "\" is not a number" << std::endl;
+            std::exit(2);
+        }
+        return T(value);
+    }
+
+    // Keeps the optimizer from discarding benchmark results: the value has to be
+    // computed, and memory it points to written, before this point. For scalars
+    // and pointers.
+    template <typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        volatile T sink = value;
+        (void)sink;
+        _ReadWriteBarrier();
+#endif
+    }
+}
+
+#endif
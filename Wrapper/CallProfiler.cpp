@@ -0,0 +1,178 @@
+#include "CallProfiler.h"
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const size_t CallCount = size_t(WrapperCall::Count);
+        const size_t BucketCount = LatencyBucketCount;
+
+        const char* const CallNames[] = {
+#define WRAPPER_CALL_NAME(name) #name,
+            WRAPPER_PROFILED_CALLS(WRAPPER_CALL_NAME)
+#undef WRAPPER_CALL_NAME
+        };
+
+        // Counters of one thread. Only the owning thread writes, so plain relaxed
+        // load and store are enough and no locked read-modify-write is needed.
+        struct ThreadCounters
+        {
+            std::atomic<uint64_t> buckets[CallCount][BucketCount];
+            std::atomic<uint64_t> totalNs[CallCount];
+            std::atomic<uint64_t> maxNs[CallCount];
+        };
+
+        inline void increment(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        // Owns the counters of all threads. Blocks of finished threads are handed to
+        // new threads, their counts stay part of the totals.
+        struct Registry
+        {
+            std::mutex lock;
+            std::vector<std::unique_ptr<ThreadCounters>> blocks;
+            std::vector<ThreadCounters*> unused;
+
+            ThreadCounters* acquire()
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!unused.empty())
+                {
+                    ThreadCounters* block = unused.back();
+                    unused.pop_back();
+                    return block;
+                }
+                blocks.push_back(std::make_unique<ThreadCounters>());
+                return blocks.back().get();
+            }
+
+            void release(ThreadCounters* block)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                unused.push_back(block);
+            }
+        };
+
+        Registry& registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        struct ThreadSlot
+        {
+            ThreadCounters* counters;
+
+            ThreadSlot() : counters(registry().acquire()) {}
+            ~ThreadSlot() { registry().release(counters); }
+        };
+    }
+
+    const char* CallProfiler::name(WrapperCall call)
+    {
+        return size_t(call) < CallCount ? CallNames[size_t(call)] : "Unknown";
+    }
+
+    void CallProfiler::record(WrapperCall call, uint64_t nanoseconds)
+    {
+        thread_local ThreadSlot slot;
+        ThreadCounters& counters = *slot.counters;
+        size_t c = size_t(call);
+
+        increment(counters.buckets[c][LatencyBucketIndex(nanoseconds)], 1);
+        increment(counters.totalNs[c], nanoseconds);
+        if (nanoseconds > counters.maxNs[c].load(std::memory_order_relaxed))
+            counters.maxNs[c].store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    std::vector<CallLatencyStatistics> CallProfiler::statistics()
+    {
+        std::vector<CallLatencyStatistics> result;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+
+        std::vector<uint64_t> merged(BucketCount);
+        for (size_t c = 0; c < CallCount; c++)
+        {
+            std::fill(merged.begin(), merged.end(), 0);
+            uint64_t calls = 0, totalNs = 0, maxNs = 0;
+            for (const std::unique_ptr<ThreadCounters>& block : reg.blocks)
+            {
+                for (size_t i = 0; i < BucketCount; i++)
+                {
+                    uint64_t count = block->buckets[c][i].load(std::memory_order_relaxed);
+                    merged[i] += count;
+                    calls += count;
+                }
+                totalNs += block->totalNs[c].load(std::memory_order_relaxed);
+                uint64_t blockMax = block->maxNs[c].load(std::memory_order_relaxed);
+                if (blockMax > maxNs)
+                    maxNs = blockMax;
+            }
+
+            if (calls == 0)
+                continue;
+
+            CallLatencyStatistics stats;
+            stats.name = CallNames[c];
+            stats.calls = calls;
+            stats.meanNs = double(totalNs) / double(calls);
+            stats.p50Ns = LatencyPercentile(merged.data(), calls, maxNs, 0.5);
+            stats.p99Ns = LatencyPercentile(merged.data(), calls, maxNs, 0.99);
+            stats.p999Ns = LatencyPercentile(merged.data(), calls, maxNs, 0.999);
+            stats.maxNs = maxNs;
+            result.push_back(stats);
+        }
+        return result;
+    }
+
+    void CallProfiler::reset()
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        for (const std::unique_ptr<ThreadCounters>& block : reg.blocks)
+        {
+            for (size_t c = 0; c < CallCount; c++)
+            {
+                for (size_t i = 0; i < BucketCount; i++)
+                    block->buckets[c][i].store(0, std::memory_order_relaxed);
+                block->totalNs[c].store(0, std::memory_order_relaxed);
+                block->maxNs[c].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void CallProfiler::dump(std::ostream& out)
+    {
+        if (!enabled())
+        {
+            out << "Call profiling disabled, build with WRAPPER_CALL_PROFILING=ON" << std::endl;
+            return;
+        }
+
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::left << std::setw(22) << "Function" << std::right
+            << std::setw(12) << "Calls" << std::setw(12) << "Mean ns" << std::setw(12) << "p50 ns"
+            << std::setw(12) << "p99 ns" << std::setw(12) << "p99.9 ns" << std::setw(12) << "Max ns" << std::endl;
+
+        for (const CallLatencyStatistics& stats : statistics())
+        {
+            out << std::left << std::setw(22) << stats.name << std::right
+                << std::setw(12) << stats.calls << std::setw(12) << std::fixed << std::setprecision(0) << stats.meanNs
+                << std::setw(12) << stats.p50Ns << std::setw(12) << stats.p99Ns
+                << std::setw(12) << stats.p999Ns << std::setw(12) << stats.maxNs << std::endl;
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+}
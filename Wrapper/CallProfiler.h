@@ -0,0 +1,96 @@
+#ifndef CALLPROFILER_H
+#define CALLPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// SDK entry points timed by the wrapper when built with WRAPPER_CALL_PROFILING
+#define WRAPPER_PROFILED_CALLS(X) \
+    X(Init) X(Init_With_Path) X(Shutdown) X(Version) X(Open) X(Close) \
+    X(RescanDevices) X(ResetDevices) X(EnumDevice) X(OpenDevice) X(CloseDevice) \
+    X(ConnectDevice) X(DisconnectDevice) X(StartDevice) X(StopDevice) X(GetDeviceState) \
+    X(AvailPackets) X(GetPacket) X(ConsumePackets) X(GetMasterStreamTime) X(SendPacket) \
+    X(ConfigRoot) X(ConfigHealth) X(ConfigFirst) X(ConfigNext) X(ConfigFind) \
+    X(ConfigGetName) X(ConfigGetInfo) X(ConfigSetFloat) X(ConfigGetFloat) \
+    X(ConfigSetString) X(ConfigGetString) X(ConfigSetInteger) X(ConfigGetInteger)
+
+namespace AarRtsaSdkWrapper
+{
+
+    enum class WrapperCall : uint32_t
+    {
+#define WRAPPER_CALL_ENUM(name) name,
+        WRAPPER_PROFILED_CALLS(WRAPPER_CALL_ENUM)
+#undef WRAPPER_CALL_ENUM
+        Count
+    };
+
+    struct CallLatencyStatistics
+    {
+        const char* name;
+        uint64_t calls;
+        double meanNs;
+        uint64_t p50Ns, p99Ns, p999Ns, maxNs;
+    };
+
+    // Per call latency histograms. Every thread records into its own block of
+    // counters with relaxed atomic stores, readers merge all blocks. Buckets are
+    // logarithmic with four sub-buckets per power of two, percentiles are reported
+    // as the upper bucket bound and are within 25% of the true value.
+    class CallProfiler
+    {
+    public:
+        static constexpr bool enabled()
+        {
+#if defined(WRAPPER_CALL_PROFILING) && WRAPPER_CALL_PROFILING
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static const char* name(WrapperCall call);
+
+        static void record(WrapperCall call, uint64_t nanoseconds);
+
+        // Merged over all threads, only functions that have been called
+        static std::vector<CallLatencyStatistics> statistics();
+
+        // Counts of calls running concurrently to a reset may survive it
+        static void reset();
+
+        static void dump(std::ostream& out);
+    };
+
+    class ScopedCallTimer
+    {
+    public:
+        explicit ScopedCallTimer(WrapperCall call)
+            : m_call(call), m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~ScopedCallTimer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            CallProfiler::record(m_call, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        ScopedCallTimer(const ScopedCallTimer&) = delete;
+        ScopedCallTimer& operator=(const ScopedCallTimer&) = delete;
+
+    private:
+        WrapperCall m_call;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#if defined(WRAPPER_CALL_PROFILING) && WRAPPER_CALL_PROFILING
+#define WRAPPER_PROFILE_CALL(call) AarRtsaSdkWrapper::ScopedCallTimer wrapperCallTimer(AarRtsaSdkWrapper::WrapperCall::call)
+#else
+#define WRAPPER_PROFILE_CALL(call) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+#include "Channelizer.h"
+#include "FirFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Frames per parallelFor task, enough to hide the handout
+        const size_t FramesPerTask = 16;
+    }
+
+    Channelizer::Channelizer(const ChannelizerSettings& settings)
+        : m_settings(settings)
+    {
+        size_t channels = 2;
+        while (channels < m_settings.channels)
+            channels *= 2;
+        m_settings.channels = channels;
+        m_settings.decimation = std::min(std::max<size_t>(1, m_settings.decimation), channels);
+        m_settings.tapsPerChannel = std::max<size_t>(2, m_settings.tapsPerChannel);
+        m_settings.level = ClampSimdLevel(m_settings.level);
+        m_length = channels * m_settings.tapsPerChannel;
+        m_plan = FftPlan::get(channels);
+
+        // Channel k of frame n (newest input sample) is
+        //   e^(-2 pi i k n / K) sum_p e^(2 pi i k p / K) sum_t h[p + t K] x[n - p - t K]
+        // With the taps of each block t reversed, the inner sums for all p are
+        // element wise products over the contiguous input x[n - t K - K + 1 ..
+        // n - t K], which leaves them in reversed order q = K - 1 - p. A forward
+        // FFT of the reversed sums equals the sum over p times e^(2 pi i k / K),
+        // folded into the rotation together with e^(-2 pi i k n / K).
+        std::vector<float> h = DesignLowpassFir(m_length, 0.5 / double(channels), m_settings.stopbandDb);
+        m_taps.assign(2 * m_length, 0.0f);
+        for (size_t t = 0; t < m_settings.tapsPerChannel; t++)
+        {
+            for (size_t q = 0; q < channels; q++)
+            {
+                size_t r = t * channels + q;
+                m_taps[2 * r] = m_taps[2 * r + 1] = h[(channels - 1 - q) + t * channels];
+            }
+        }
+        m_rotation.resize(channels);
+        for (size_t r = 0; r < channels; r++)
+        {
+            double angle = -2 * std::numbers::pi * double(r) / double(channels);
+            m_rotation[r] = std::complex<float>(float(std::cos(angle)), float(std::sin(angle)));
+        }
+        m_output.resize(channels);
+        reset();
+    }
+
+    double Channelizer::delay() const
+    {
+        return double(m_length - 1) / 2;
+    }
+
+    void Channelizer::reset()
+    {
+        restartFilter();
+        m_timing.reset();
+    }
+
+    void Channelizer::restartFilter()
+    {
+        m_buffer.assign(2 * (m_length - 1), 0.0f);
+        m_index = m_length - 1;
+        m_bufferStart = -int64_t(m_length - 1);
+    }
+
+    void Channelizer::filterFrames(size_t first, size_t last)
+    {
+        const size_t channels = m_settings.channels;
+        for (size_t f = first; f < last; f++)
+        {
+            std::complex<float>* frame = m_frames.data() + f * channels;
+            float* acc = reinterpret_cast<float*>(frame);
+            std::fill(acc, acc + 2 * channels, 0.0f);
+
+            size_t newest = m_index + f * m_settings.decimation;
+            for (size_t t = 0; t < m_settings.tapsPerChannel; t++)
+            {
+                const float* x = &m_buffer[2 * (newest - t * channels - (channels - 1))];
+                FirMultiplyAddIq(x, &m_taps[2 * t * channels], channels, acc, m_settings.level);
+            }
+            m_plan->forward(frame, m_settings.level);
+        }
+    }
+
+    void Channelizer::emitChannel(size_t c, size_t frames)
+    {
+        const size_t channels = m_settings.channels;
+        const size_t k = (c + channels / 2) & (channels - 1);
+        std::vector<float>& out = m_output[c];
+        out.resize(2 * frames);
+        for (size_t f = 0; f < frames; f++)
+        {
+            // Written out, std::complex checks for infinities
+            std::complex<float> x = m_frames[f * channels + k], r = m_rotation[(k * m_frameShift[f]) & (channels - 1)];
+            out[2 * f] = x.real() * r.real() - x.imag() * r.imag();
+            out[2 * f + 1] = x.real() * r.imag() + x.imag() * r.real();
+        }
+    }
+
+    size_t Channelizer::process(const AARTSAAPI_Packet& in, std::vector<AARTSAAPI_Packet>& out, WorkerPool* pool)
+    {
+        const size_t channels = m_settings.channels;
+        AARTSAAPI_Packet base = in;
+        base.num = base.total = 0;
+        base.size = base.stride = 2;
+        base.fp32 = nullptr;
+        base.flags &= ~StreamStartFlags;
+        out.assign(channels, base);
+        if (in.size < 2 || in.num <= 0 || !in.fp32 || in.stepFrequency <= 0)
+        {
+            m_timing.skip(in);
+            return 0;
+        }
+        if (m_timing.advance(in))
+            restartFilter();
+
+        // Frame times from the stream index of their newest input sample
+        const double rate = m_timing.rate();
+        const int64_t firstNewest = m_bufferStart + int64_t(m_index);
+        const double startTime = m_timing.time0() + (double(firstNewest) - delay()) / rate;
+
+        AppendIq(m_buffer, in.fp32, size_t(in.num), in.stride);
+        const size_t available = m_buffer.size() / 2;
+        const size_t frames = m_index < available ? (available - 1 - m_index) / m_settings.decimation + 1 : 0;
+        m_frames.resize(frames * channels);
+        m_frameShift.resize(frames);
+        for (size_t f = 0; f < frames; f++)
+            m_frameShift[f] = uint32_t(uint64_t(firstNewest + int64_t(f * m_settings.decimation) + 1) & (channels - 1));
+
+        const size_t tasks = (frames + FramesPerTask - 1) / FramesPerTask;
+        auto filter = [&](size_t task) { filterFrames(task * FramesPerTask, std::min(frames, (task + 1) * FramesPerTask)); };
+        auto emit = [&](size_t c) { emitChannel(c, frames); };
+        if (pool)
+        {
+            pool->parallelFor(tasks, filter);
+            pool->parallelFor(channels, emit);
+        }
+        else
+        {
+            for (size_t task = 0; task < tasks; task++)
+                filter(task);
+            for (size_t c = 0; c < channels; c++)
+                emit(c);
+        }
+
+        // Keep the history of the next frame
+        m_index += frames * m_settings.decimation;
+        size_t drop = std::min(available, m_index - (m_length - 1));
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + std::ptrdiff_t(2 * drop));
+        m_index -= drop;
+        m_bufferStart += int64_t(drop);
+
+        const double outRate = rate / double(m_settings.decimation), spacing = rate / double(channels);
+        const uint64_t flags = frames ? m_timing.takeFlags() : 0;
+        const double center = in.startFrequency + in.spanFrequency / 2;
+        for (size_t c = 0; c < channels; c++)
+        {
+            AARTSAAPI_Packet& packet = out[c];
+            packet.startFrequency = center + (channelOffset(c) - 0.5) * spacing;
+            packet.spanFrequency = spacing;
+            packet.stepFrequency = outRate;
+            packet.startTime = startTime;
+            packet.endTime = startTime + double(frames) / outRate;
+            packet.num = packet.total = int64_t(frames);
+            packet.fp32 = frames ? m_output[c].data() : nullptr;
+            packet.flags |= flags;
+        }
+        return frames;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#include "Fft.h"
+#include "SimdSupport.h"
+#include "StreamTiming.h"
+#include "WorkerPool.h"
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct ChannelizerSettings
+    {
+        size_t channels;            // uniform channels over the input rate, rounded up to a power of two
+        size_t decimation;          // input samples per output sample, up to channels; channels / 2 keeps the channel edges free of aliases
+        size_t tapsPerChannel;      // prototype filter length over channels, sets the transition to about 5 / tapsPerChannel channels
+        double stopbandDb;
+        SimdLevel level;
+
+        explicit ChannelizerSettings(size_t channels = 64)
+            : channels(channels), decimation(channels / 2), tapsPerChannel(16), stopbandDb(80.0), level(DetectSimdLevel())
+        {
+        }
+    };
+
+    // Polyphase filter bank that splits a wideband IQ stream, e.g. one
+    // spectranv6/raw capture, into channels uniformly spaced by input rate /
+    // channels. Every output sample of all channels costs one pass of the
+    // prototype low pass over its input window, folded into channels sums, and
+    // one FFT of that size. The -6 dB points of the prototype lie on the
+    // channel edges, so adjacent channels cross there and add up flat.
+    //
+    // Filter state carries over from packet to packet. A gap, detected from
+    // the timestamps or AARTSAAPI_PACKET_SEGMENT_START, or a rate change
+    // restarts the bank like IqResampler; the next output packets then have
+    // AARTSAAPI_PACKET_SEGMENT_START set.
+    class Channelizer
+    {
+    public:
+        explicit Channelizer(const ChannelizerSettings& settings = ChannelizerSettings());
+
+        const ChannelizerSettings& settings() const { return m_settings; }
+        size_t channels() const { return m_settings.channels; }
+
+        // Group delay of the prototype filter in input samples
+        double delay() const;
+
+        // Center of channel c relative to the input center, in units of the
+        // channel spacing; channel 0 is the lowest, channels / 2 the center
+        double channelOffset(size_t c) const { return double(c) - double(m_settings.channels / 2); }
+
+        // Splits an IQ packet (size 2, or the first receiver of Rx12) into one
+        // packet per channel, lowest frequency first, with the channel center
+        // and spacing in startFrequency and spanFrequency. The frames of the
+        // packet are spread over the pool if one is given. The packets point
+        // into the channelizer and stay valid until the next call; they may
+        // have no samples. Returns the samples per channel.
+        size_t process(const AARTSAAPI_Packet& in, std::vector<AARTSAAPI_Packet>& out, WorkerPool* pool = nullptr);
+
+        // Drops the filter state and the timing
+        void reset();
+
+    private:
+        void restartFilter();
+        void filterFrames(size_t first, size_t last);
+        void emitChannel(size_t c, size_t frames);
+
+        ChannelizerSettings m_settings;
+        size_t m_length;                            // prototype taps, channels * tapsPerChannel
+        std::shared_ptr<const FftPlan> m_plan;
+        std::vector<float> m_taps;                  // per block of channels taps, reversed and paired
+        std::vector<std::complex<float>> m_rotation; // e^(-2 pi i r / channels)
+        std::vector<float> m_buffer;                // length - 1 samples of history followed by new input
+        size_t m_index;                             // buffer sample of the next frame's newest input
+        int64_t m_bufferStart;                      // stream index of the first buffer sample
+
+        StreamTiming m_timing;
+
+        std::vector<std::complex<float>> m_frames;  // channels FFT outputs per frame
+        std::vector<uint32_t> m_frameShift;         // (newest stream index + 1) mod channels per frame
+        std::vector<std::vector<float>> m_output;   // per channel
+    };
+}
+
+#endif
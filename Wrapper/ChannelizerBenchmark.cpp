@@ -0,0 +1,241 @@
+#include "BenchmarkSupport.h"
+#include "Channelizer.h"
+#include "DownConverter.h"
+#include <cmath>
+#include <complex>
+#include <iomanip>
+#include <numbers>
+#include <vector>
+
+// Splits a stream of wideband IQ packets into channels, with the polyphase
+// filter bank for a uniform grid and with one down converter per channel for
+// arbitrary ones. Checks a tone against the ideal tone at the output
+// timestamps of its channel, how much of it leaks into the other channels,
+// and the SIMD levels against the scalar one. Then times the filter bank per
+// channel count and the down converters per channel count, each on worker
+// pools of one thread up to one per core. Runs without a device; takes the
+// packets per run and the samples per packet.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const double InputRate = 10e6;
+    const double Center = 2400e6;
+
+    std::vector<AARTSAAPI_Packet> makePackets(std::vector<float>& iq, size_t packets, size_t samples, double offset)
+    {
+        iq.resize(2 * packets * samples);
+        for (size_t j = 0; j < packets * samples; j++)
+        {
+            double phase = 2 * std::numbers::pi * offset * double(j) / InputRate;
+            iq[2 * j] = float(0.5 * std::cos(phase));
+            iq[2 * j + 1] = float(0.5 * std::sin(phase));
+        }
+
+        std::vector<AARTSAAPI_Packet> list(packets);
+        for (size_t p = 0; p < packets; p++)
+        {
+            AARTSAAPI_Packet& packet = list[p];
+            packet = AARTSAAPI_Packet();
+            packet.num = packet.total = int64_t(samples);
+            packet.size = packet.stride = 2;
+            packet.fp32 = iq.data() + 2 * p * samples;
+            packet.stepFrequency = InputRate;
+            packet.spanFrequency = InputRate;
+            packet.startFrequency = Center - packet.spanFrequency / 2;
+            packet.startTime = 1000.0 + double(p * samples) / InputRate;
+            packet.endTime = packet.startTime + double(samples) / InputRate;
+        }
+        list[0].flags = AARTSAAPI_PACKET_STREAM_START;
+        return list;
+    }
+
+    // Largest deviation from the ideal tone at the packet's output times,
+    // relative to it, skipping the transient of the filter
+    double toneError(const AARTSAAPI_Packet& out, double frequency, double time0, double settle)
+    {
+        const double channelCenter = out.startFrequency + out.spanFrequency / 2;
+        double maxError = 0;
+        for (int64_t j = 0; j < out.num; j++)
+        {
+            double t = out.startTime + double(j) / out.stepFrequency - time0;
+            if (t < settle)
+                continue;
+            std::complex<double> ideal = std::polar(0.5, 2 * std::numbers::pi * (frequency - channelCenter) * t);
+            maxError = std::max(maxError, std::abs(std::complex<double>(out.fp32[2 * j], out.fp32[2 * j + 1]) - ideal) / 0.5);
+        }
+        return maxError;
+    }
+
+    double powerOf(const AARTSAAPI_Packet& out)
+    {
+        double power = 0;
+        for (int64_t j = 0; j < out.num; j++)
+            power += double(out.fp32[2 * j]) * out.fp32[2 * j] + double(out.fp32[2 * j + 1]) * out.fp32[2 * j + 1];
+        return out.num ? power / double(out.num) : 0;
+    }
+
+    struct BankQuality
+    {
+        double toneErrorDb;         // in the tone's channel, a quarter of the spacing off its center
+        double adjacentDb;          // largest level in the neighbouring channels
+        double otherDb;             // largest level in all other channels
+        float simdDifference;       // largest difference of any level from the scalar output
+    };
+
+    BankQuality measureBank(size_t channels, size_t samples)
+    {
+        BankQuality quality = {};
+        const size_t packets = 32, toneChannel = channels / 2 + channels / 8;
+        ChannelizerSettings settings(channels);
+        const double spacing = InputRate / double(channels);
+        const double offset = (double(toneChannel) - double(channels / 2) + 0.25) * spacing;
+        const double settle = double(channels * settings.tapsPerChannel) / InputRate;
+
+        std::vector<float> iq;
+        std::vector<AARTSAAPI_Packet> in = makePackets(iq, packets, samples, offset);
+        std::vector<std::vector<float>> outputs;
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+        {
+            settings.level = level;
+            Channelizer channelizer(settings);
+            std::vector<double> power(channels, 0.0);
+            std::vector<float> all;
+            double maxError = 0;
+            std::vector<AARTSAAPI_Packet> out;
+            for (size_t p = 0; p < packets; p++)
+            {
+                channelizer.process(in[p], out);
+                maxError = std::max(maxError, toneError(out[toneChannel], Center + offset, in[0].startTime, settle));
+                for (size_t c = 0; c < channels; c++)
+                {
+                    if (p >= packets / 2)
+                        power[c] = std::max(power[c], powerOf(out[c]));
+                    all.insert(all.end(), out[c].fp32, out[c].fp32 + 2 * out[c].num);
+                }
+            }
+            if (level == SimdLevel::Scalar)
+            {
+                quality.toneErrorDb = 20 * std::log10(maxError);
+                quality.adjacentDb = quality.otherDb = -400;
+                for (size_t c = 0; c < channels; c++)
+                {
+                    double db = 10 * std::log10(std::max(power[c], 1e-40) / 0.25);
+                    if (c + 1 == toneChannel || c == toneChannel + 1)
+                        quality.adjacentDb = std::max(quality.adjacentDb, db);
+                    else if (c != toneChannel)
+                        quality.otherDb = std::max(quality.otherDb, db);
+                }
+            }
+            outputs.push_back(all);
+        }
+        for (const std::vector<float>& output : outputs)
+        {
+            for (size_t k = 0; k < output.size() && k < outputs[0].size(); k++)
+                quality.simdDifference = std::max(quality.simdDifference, std::fabs(output[k] - outputs[0][k]));
+        }
+        return quality;
+    }
+
+    // Tone error of a down converter tuned next to an arbitrary tone
+    double measureDownConverter(uint32_t decimation, size_t samples)
+    {
+        const size_t packets = 32;
+        const double tone = Center + 1234567.0, tuned = tone - 0.2 * InputRate / decimation;
+        std::vector<float> iq;
+        std::vector<AARTSAAPI_Packet> in = makePackets(iq, packets, samples, tone - Center);
+        DownConverter converter(tuned, IqResamplerSettings(1, decimation));
+        const double settle = 2 * converter.resampler().delay() / InputRate;
+        double maxError = 0;
+        for (size_t p = 0; p < packets; p++)
+        {
+            AARTSAAPI_Packet out;
+            converter.process(in[p], out);
+            maxError = std::max(maxError, toneError(out, tone, in[0].startTime, settle));
+        }
+        return 20 * std::log10(maxError);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t packets = NumberArgument<size_t>(argc, argv, 1, 400);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 16384);
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t bankChannels[] = { 16, 64, 256, 1024 };
+
+    std::cout << "Filter bank    : decimation channels / 2, " << ChannelizerSettings().tapsPerChannel << " taps per channel, stopband "
+        << ChannelizerSettings().stopbandDb << " dB" << std::endl
+        << "channels  tone error dB  adjacent dB  other dB  SIMD difference" << std::endl;
+    for (size_t channels : bankChannels)
+    {
+        BankQuality quality = measureBank(channels, samples);
+        std::cout << std::setw(8) << channels << std::fixed << std::setprecision(1) << std::setw(15) << quality.toneErrorDb
+            << std::setw(13) << quality.adjacentDb << std::setw(10) << quality.otherDb
+            << std::scientific << std::setw(17) << quality.simdDifference << std::endl;
+    }
+
+    std::cout << std::endl << "Down converter : tone 0.2 of the output rate off the tuned frequency" << std::endl
+        << "decimation  taps  tone error dB" << std::endl;
+    for (uint32_t decimation : { 8u, 64u })
+    {
+        std::cout << std::setw(10) << decimation << std::setw(6) << DownConverter(0, IqResamplerSettings(1, decimation)).resampler().taps()
+            << std::fixed << std::setprecision(1) << std::setw(15) << measureDownConverter(decimation, samples) << std::endl;
+    }
+
+    // Throughput in input samples per second
+    std::vector<float> iq;
+    std::vector<AARTSAAPI_Packet> in = makePackets(iq, 16, samples, 123456.0);
+    std::cout << std::endl << "Filter bank    : MSamples/s of input, all channels" << std::endl << "channels";
+    for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+        std::cout << std::setw(8) << threads << " thr";
+    std::cout << std::endl;
+    for (size_t channels : bankChannels)
+    {
+        std::cout << std::setw(8) << channels << std::fixed << std::setprecision(1);
+        for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+        {
+            WorkerPool pool{ WorkerPoolSettings(threads) };
+            Channelizer channelizer{ ChannelizerSettings(channels) };
+            std::vector<AARTSAAPI_Packet> out;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t p = 0; p < packets; p++)
+            {
+                // The timestamps restart every 16 packets, like a new segment
+                channelizer.process(in[p % in.size()], out, &pool);
+                DoNotOptimize(out[0].fp32);
+            }
+            std::cout << std::setw(12) << double(packets * samples) / SecondsSince(start) / 1e6;
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << std::endl << "Down converters: decimation 64, MSamples/s of input, all channels" << std::endl << "channels";
+    for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+        std::cout << std::setw(8) << threads << " thr";
+    std::cout << std::endl;
+    for (size_t channels : { size_t(1), size_t(4), size_t(16) })
+    {
+        std::cout << std::setw(8) << channels << std::fixed << std::setprecision(1);
+        for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+        {
+            WorkerPool pool{ WorkerPoolSettings(threads) };
+            std::vector<DownConverter> converters;
+            for (size_t c = 0; c < channels; c++)
+                converters.emplace_back(Center + (double(c) - double(channels) / 2) * 0.05 * InputRate, IqResamplerSettings(1, 64));
+            std::vector<AARTSAAPI_Packet> out(channels);
+            const size_t runs = std::max<size_t>(1, packets / channels);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t p = 0; p < runs; p++)
+            {
+                DownConvertChannels(pool, converters, in[p % in.size()], out.data());
+                DoNotOptimize(out[0].fp32);
+            }
+            std::cout << std::setw(12) << double(runs * samples) / SecondsSince(start) / 1e6;
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "BenchmarkSupport.h"
+#include <iomanip>
+
+// Compares retuning through ConfigFind + ConfigSetFloat by path, the way the samples
+// do it, with setting through a handle resolved once by ConfigResolve.
+
+using namespace AarRtsaSdkWrapper;
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const int iterations = NumberArgument<int>(argc, argv, 2, 200000);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "iqtransceiver");
+    if (!bench.isOpen())
+        return -1;
+
+    AARTSAAPI_Device* d = bench.device();
+
+    const char* paths[] = { "main/centerfreq", "main/demodcenterfreq" };
+    Wrapper_ConfigHandle handles[2];
+    for (int k = 0; k < 2; k++)
+    {
+        AARTSAAPI_Result res = sdkWrapper.ConfigResolve(d, paths[k], &handles[k]);
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "ConfigResolve failed for " << paths[k] << ": " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+    }
+
+    // Retune by path, resolving both items on every step
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        double frequency = 1.0e9 + (i % 500) * 1.0e6;
+        AARTSAAPI_Config root, config;
+        sdkWrapper.ConfigRoot(d, &root);
+        if (sdkWrapper.ConfigFind(d, &root, &config, paths[0]) == AARTSAAPI_OK)
+            sdkWrapper.ConfigSetFloat(d, &config, frequency + 5.0e6);
+        if (sdkWrapper.ConfigFind(d, &root, &config, paths[1]) == AARTSAAPI_OK)
+            sdkWrapper.ConfigSetFloat(d, &config, frequency);
+    }
+    double byPath = SecondsSince(start);
+
+    // Retune through the pre-resolved handles
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        double frequency = 1.0e9 + (i % 500) * 1.0e6;
+        sdkWrapper.ConfigSetFloat(handles[0], frequency + 5.0e6);
+        sdkWrapper.ConfigSetFloat(handles[1], frequency);
+    }
+    double byHandle = SecondsSince(start);
+
+    double sets = 2.0 * iterations;
+    std::cout << std::fixed << std::setprecision(1)
+        << "ConfigFind + ConfigSetFloat : " << byPath / sets * 1e9 << " ns/set" << std::endl
+        << "ConfigSetFloat(handle)      : " << byHandle / sets * 1e9 << " ns/set" << std::endl
+        << "Saving per set              : " << (byPath - byHandle) / sets * 1e9 << " ns" << std::endl;
+
+    return 0;
+}
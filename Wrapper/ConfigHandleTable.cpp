@@ -0,0 +1,157 @@
+#include "ConfigHandleTable.h"
+#include <cstring>
+
+namespace AarRtsaSdkWrapper
+{
+
+    ConfigHandleTable::ConfigHandleTable()
+        : m_liveEntries(0)
+    {
+        m_slots.assign(64, 0);
+    }
+
+    uint64_t ConfigHandleTable::hashKey(const AARTSAAPI_Device& dhandle, const std::string& path)
+    {
+        // FNV-1a over the opaque device handle followed by the path
+        uint64_t hash = 14695981039346656037ULL;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&dhandle);
+        for (size_t i = 0; i < sizeof(AARTSAAPI_Device); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        for (unsigned char c : path)
+            hash = (hash ^ c) * 1099511628211ULL;
+        return hash;
+    }
+
+    bool ConfigHandleTable::sameDevice(const AARTSAAPI_Device& a, const AARTSAAPI_Device& b)
+    {
+        return std::memcmp(&a, &b, sizeof(AARTSAAPI_Device)) == 0;
+    }
+
+    bool ConfigHandleTable::find(const AARTSAAPI_Device& dhandle, const std::string& path, Wrapper_ConfigHandle* handle) const
+    {
+        uint64_t hash = hashKey(dhandle, path);
+        size_t mask = m_slots.size() - 1;
+
+        for (size_t slot = size_t(hash) & mask;; slot = (slot + 1) & mask)
+        {
+            uint32_t ref = m_slots[slot];
+            if (ref == 0)
+                return false;
+
+            const Entry& entry = m_entries[ref - 1];
+            if (entry.hash == hash && entry.path == path && sameDevice(entry.dhandle, dhandle))
+            {
+                handle->index = ref - 1;
+                handle->generation = entry.generation;
+                return true;
+            }
+        }
+    }
+
+    Wrapper_ConfigHandle ConfigHandleTable::insert(const AARTSAAPI_Device& dhandle, const std::string& path, const AARTSAAPI_Config& config)
+    {
+        Wrapper_ConfigHandle handle;
+        if (find(dhandle, path, &handle))
+        {
+            m_entries[handle.index].config = config;
+            return handle;
+        }
+
+        // Keep the load factor below one half
+        if ((m_liveEntries + 1) * 2 > m_slots.size())
+            rehash(m_slots.size() * 2);
+
+        uint32_t index;
+        if (!m_freeEntries.empty())
+        {
+            index = m_freeEntries.back();
+            m_freeEntries.pop_back();
+        }
+        else
+        {
+            index = uint32_t(m_entries.size());
+            m_entries.push_back(Entry());
+            m_entries[index].generation = 0;
+        }
+
+        Entry& entry = m_entries[index];
+        entry.dhandle = dhandle;
+        entry.config = config;
+        entry.path = path;
+        entry.hash = hashKey(dhandle, path);
+        entry.generation++;
+        entry.live = true;
+        entry.lastValue = Wrapper_ConfigValue();
+        m_liveEntries++;
+
+        place(index);
+
+        handle.index = index;
+        handle.generation = entry.generation;
+        return handle;
+    }
+
+    void ConfigHandleTable::removeDevice(const AARTSAAPI_Device& dhandle)
+    {
+        bool removed = false;
+        for (uint32_t i = 0; i < m_entries.size(); i++)
+        {
+            Entry& entry = m_entries[i];
+            if (entry.live && sameDevice(entry.dhandle, dhandle))
+            {
+                entry.live = false;
+                entry.path.clear();
+                m_freeEntries.push_back(i);
+                m_liveEntries--;
+                removed = true;
+            }
+        }
+
+        // Open addressing without tombstones, rebuild the probe sequences
+        if (removed)
+            rehash(m_slots.size());
+    }
+
+    void ConfigHandleTable::forgetValues(const AARTSAAPI_Device& dhandle)
+    {
+        for (Entry& entry : m_entries)
+        {
+            if (entry.live && sameDevice(entry.dhandle, dhandle))
+                entry.lastValue = Wrapper_ConfigValue();
+        }
+    }
+
+    void ConfigHandleTable::clear()
+    {
+        for (uint32_t i = 0; i < m_entries.size(); i++)
+        {
+            if (m_entries[i].live)
+            {
+                m_entries[i].live = false;
+                m_entries[i].path.clear();
+                m_freeEntries.push_back(i);
+            }
+        }
+        m_liveEntries = 0;
+        m_slots.assign(m_slots.size(), 0);
+    }
+
+    void ConfigHandleTable::rehash(size_t capacity)
+    {
+        m_slots.assign(capacity, 0);
+        for (uint32_t i = 0; i < m_entries.size(); i++)
+        {
+            if (m_entries[i].live)
+                place(i);
+        }
+    }
+
+    void ConfigHandleTable::place(uint32_t entryIndex)
+    {
+        size_t mask = m_slots.size() - 1;
+        size_t slot = size_t(m_entries[entryIndex].hash) & mask;
+        while (m_slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        m_slots[slot] = entryIndex + 1;
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef CONFIGHANDLETABLE_H
+#define CONFIGHANDLETABLE_H
+
+#include <aaroniartsaapi.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Pre-resolved configuration item. The index addresses the handle table of the
+    // wrapper, the generation detects handles of devices that have been closed.
+    struct Wrapper_ConfigHandle
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        Wrapper_ConfigHandle() : index(UINT32_MAX), generation(0) {}
+
+        bool isValid() const { return index != UINT32_MAX; }
+    };
+
+    // Typed config value as written through the SDK, the type selects between
+    // ConfigSetFloat, ConfigSetInteger and ConfigSetString
+    struct Wrapper_ConfigValue
+    {
+        enum Type
+        {
+            None,
+            Float,
+            Integer,
+            String
+        };
+
+        Type type;
+        double number;
+        int64_t integer;
+        std::string text;
+
+        Wrapper_ConfigValue() : type(None), number(0), integer(0) {}
+
+        bool operator==(const Wrapper_ConfigValue& other) const
+        {
+            if (type != other.type)
+                return false;
+            switch (type)
+            {
+            case Float: return number == other.number;
+            case Integer: return integer == other.integer;
+            case String: return text == other.text;
+            default: return true;
+            }
+        }
+
+        bool operator!=(const Wrapper_ConfigValue& other) const { return !(*this == other); }
+    };
+
+    // Flat open addressing hash table mapping (device, config path) to the resolved
+    // AARTSAAPI_Config. Entries live in a dense array so that a handle lookup is a
+    // bounds and generation check, without hashing or string work.
+    class ConfigHandleTable
+    {
+    public:
+        struct Entry
+        {
+            AARTSAAPI_Device dhandle;
+            AARTSAAPI_Config config;
+            std::string path;
+            uint64_t hash;
+            uint32_t generation;
+            bool live;
+            Wrapper_ConfigValue lastValue;  // last value written or read through the handle
+        };
+
+        ConfigHandleTable();
+
+        bool find(const AARTSAAPI_Device& dhandle, const std::string& path, Wrapper_ConfigHandle* handle) const;
+        Wrapper_ConfigHandle insert(const AARTSAAPI_Device& dhandle, const std::string& path, const AARTSAAPI_Config& config);
+        void removeDevice(const AARTSAAPI_Device& dhandle);
+        void forgetValues(const AARTSAAPI_Device& dhandle);
+        void clear();
+
+        size_t size() const { return m_liveEntries; }
+
+        Entry* lookup(Wrapper_ConfigHandle handle)
+        {
+            if (handle.index >= m_entries.size())
+                return nullptr;
+            Entry& entry = m_entries[handle.index];
+            if (!entry.live || entry.generation != handle.generation)
+                return nullptr;
+            return &entry;
+        }
+
+    private:
+        static uint64_t hashKey(const AARTSAAPI_Device& dhandle, const std::string& path);
+        static bool sameDevice(const AARTSAAPI_Device& a, const AARTSAAPI_Device& b);
+
+        void rehash(size_t capacity);
+        void place(uint32_t entryIndex);
+
+        std::vector<Entry> m_entries;
+        std::vector<uint32_t> m_freeEntries;
+        std::vector<uint32_t> m_slots;      // entry index + 1, 0 marks an empty slot
+        size_t m_liveEntries;
+    };
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "ConfigProfile.h"
+
+namespace AarRtsaSdkWrapper
+{
+
+    Wrapper_ConfigValue& ConfigProfile::slot(const std::string& path)
+    {
+        // Setting a path again replaces its value but keeps its position
+        for (Item& item : m_items)
+        {
+            if (item.path == path)
+                return item.value;
+        }
+        m_items.push_back(Item());
+        m_items.back().path = path;
+        return m_items.back().value;
+    }
+
+    ConfigProfile& ConfigProfile::setFloat(const std::string& path, double value)
+    {
+        Wrapper_ConfigValue& v = slot(path);
+        v = Wrapper_ConfigValue();
+        v.type = Wrapper_ConfigValue::Float;
+        v.number = value;
+        return *this;
+    }
+
+    ConfigProfile& ConfigProfile::setInteger(const std::string& path, int64_t value)
+    {
+        Wrapper_ConfigValue& v = slot(path);
+        v = Wrapper_ConfigValue();
+        v.type = Wrapper_ConfigValue::Integer;
+        v.integer = value;
+        return *this;
+    }
+
+    ConfigProfile& ConfigProfile::setString(const std::string& path, const std::string& value)
+    {
+        Wrapper_ConfigValue& v = slot(path);
+        v = Wrapper_ConfigValue();
+        v.type = Wrapper_ConfigValue::String;
+        v.text = value;
+        return *this;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef CONFIGPROFILE_H
+#define CONFIGPROFILE_H
+
+#include "ConfigHandleTable.h"
+#include <string>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Ordered list of (config path, typed value) pairs applied in one call by
+    // AaroniaRtsaSdkWrapper::ApplyProfile. Items are written in the order they were
+    // first set, which matters for dependent settings like receiverclock before span.
+    class ConfigProfile
+    {
+    public:
+        struct Item
+        {
+            std::string path;
+            Wrapper_ConfigValue value;
+        };
+
+        ConfigProfile& setFloat(const std::string& path, double value);
+        ConfigProfile& setInteger(const std::string& path, int64_t value);
+        ConfigProfile& setString(const std::string& path, const std::string& value);
+
+        const std::vector<Item>& items() const { return m_items; }
+        bool empty() const { return m_items.empty(); }
+        void clear() { m_items.clear(); }
+
+    private:
+        Wrapper_ConfigValue& slot(const std::string& path);
+
+        std::vector<Item> m_items;
+    };
+
+    struct Wrapper_ProfileApplyReport
+    {
+        size_t written;             // items that were sent to the SDK
+        size_t skipped;             // items already holding the requested value
+        double seconds;             // wall time of the apply
+        std::string failedPath;     // item that stopped the apply, empty on success
+
+        Wrapper_ProfileApplyReport() : written(0), skipped(0), seconds(0) {}
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "BenchmarkSupport.h"
+#include <iomanip>
+
+// Switches a raw device between a spectrum and a wideband IQ setup, once as the
+// chain of ConfigFind + ConfigSet* calls the samples use and once through
+// ApplyProfile, which only writes the items that differ between the two.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    AARTSAAPI_Result applyByPath(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* d, const ConfigProfile& profile)
+    {
+        AARTSAAPI_Config root, config;
+        AARTSAAPI_Result res = sdkWrapper.ConfigRoot(d, &root);
+        for (const ConfigProfile::Item& item : profile.items())
+        {
+            if (res != AARTSAAPI_OK)
+                break;
+            if ((res = sdkWrapper.ConfigFind(d, &root, &config, item.path)) != AARTSAAPI_OK)
+                break;
+
+            switch (item.value.type)
+            {
+            case Wrapper_ConfigValue::Float: res = sdkWrapper.ConfigSetFloat(d, &config, item.value.number); break;
+            case Wrapper_ConfigValue::Integer: res = sdkWrapper.ConfigSetInteger(d, &config, item.value.integer); break;
+            case Wrapper_ConfigValue::String: res = sdkWrapper.ConfigSetString(d, &config, item.value.text); break;
+            default: res = AARTSAAPI_ERROR_INVALID_PARAMETR; break;
+            }
+        }
+        return res;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const int iterations = NumberArgument<int>(argc, argv, 2, 20000);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+    if (!bench.isOpen())
+        return -1;
+
+    AARTSAAPI_Device* d = bench.device();
+
+    ConfigProfile spectrum;
+    spectrum.setString("device/receiverchannel", "Rx1")
+        .setString("device/outputformat", "spectra")
+        .setString("device/receiverclock", "92MHz")
+        .setString("device/fft0/fftmergemode", "max")
+        .setInteger("device/fft0/fftaggregate", 100)
+        .setString("calibration/preamp", "Auto")
+        .setFloat("main/reflevel", -20.0)
+        .setFloat("main/centerfreq", 2440.0e6);
+
+    ConfigProfile wideband = spectrum;
+    wideband.setString("device/outputformat", "iq")
+        .setString("device/receiverclock", "245MHz")
+        .setFloat("main/reflevel", -10.0)
+        .setFloat("main/centerfreq", 1000.0e6);
+
+    // Hand written chain, every item is written on every switch
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        AARTSAAPI_Result res = applyByPath(sdkWrapper, d, (i & 1) ? wideband : spectrum);
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "Applying by path failed: " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+    }
+    double byPath = SecondsSince(start);
+
+    // Profiles with change detection
+
+    sdkWrapper.ConfigForgetValues(d);
+
+    Wrapper_ProfileApplyReport report;
+    size_t written = 0, skipped = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        AARTSAAPI_Result res = sdkWrapper.ApplyProfile(d, (i & 1) ? wideband : spectrum, &report);
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "ApplyProfile failed at " << report.failedPath << ": " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+        written += report.written;
+        skipped += report.skipped;
+    }
+    double byProfile = SecondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(2)
+        << "ConfigFind + ConfigSet* chain : " << byPath / iterations * 1e6 << " us/switch, "
+        << spectrum.items().size() << " writes" << std::endl
+        << "ApplyProfile                  : " << byProfile / iterations * 1e6 << " us/switch, "
+        << double(written) / iterations << " writes, " << double(skipped) / iterations << " skipped" << std::endl
+        << "Last apply                    : " << report.seconds * 1e6 << " us" << std::endl;
+
+    return 0;
+}
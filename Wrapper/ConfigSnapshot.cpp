@@ -0,0 +1,256 @@
+#include "ConfigSnapshot.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const char SnapshotMagic[8] = { 'A', 'A', 'R', 'C', 'F', 'G', 'S', 'N' };
+        const uint32_t SnapshotFormatVersion = 1;
+
+        struct SnapshotFileHeader
+        {
+            char magic[8];
+            uint32_t formatVersion;
+            uint32_t nodeSize;
+            uint32_t nodeCount;
+            uint32_t stringBytes;
+            uint32_t deviceTypeLength;
+            uint32_t firmwareLength;
+        };
+
+        std::string fileNamePart(const std::string& str)
+        {
+            std::string part = str;
+            for (char& c : part)
+            {
+                if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-'))
+                    c = '_';
+            }
+            return part;
+        }
+    }
+
+    ConfigSnapshot::ConfigSnapshot()
+    {
+        reset();
+    }
+
+    void ConfigSnapshot::reset()
+    {
+        m_nodes.clear();
+        m_strings.assign(1, '\0');
+        m_interned.clear();
+        m_interned.emplace(std::string(), 0);
+        m_deviceType.clear();
+        m_firmware.clear();
+    }
+
+    uint32_t ConfigSnapshot::intern(const std::string& str)
+    {
+        auto it = m_interned.find(str);
+        if (it != m_interned.end())
+            return it->second;
+
+        uint32_t offset = uint32_t(m_strings.size());
+        m_strings.append(str);
+        m_strings.push_back('\0');
+        m_interned.emplace(str, offset);
+        return offset;
+    }
+
+    AARTSAAPI_Result ConfigSnapshot::capture(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, AARTSAAPI_Config* root, const std::string& deviceType, const std::string& firmware)
+    {
+        reset();
+        m_deviceType = deviceType;
+        m_firmware = firmware;
+
+        AARTSAAPI_Result res = walk(sdkWrapper, dhandle, root, npos, 0);
+        m_interned.clear();
+        if (res != AARTSAAPI_OK)
+            reset();
+        return res;
+    }
+
+    AARTSAAPI_Result ConfigSnapshot::walk(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, uint32_t parent, uint32_t depth)
+    {
+        AARTSAAPI_Config config;
+        if (sdkWrapper.ConfigFirst(dhandle, group, &config) != AARTSAAPI_OK)
+            return AARTSAAPI_OK;
+
+        Wrapper_ConfigInfo cinfo;
+        uint32_t previous = npos;
+        do
+        {
+            AARTSAAPI_Result res = sdkWrapper.ConfigGetInfo(dhandle, &config, &cinfo);
+            if (res != AARTSAAPI_OK)
+                return res;
+
+            std::string_view value;
+            if (cinfo.type != AARTSAAPI_CONFIG_TYPE_GROUP && sdkWrapper.ConfigGetString(dhandle, &config, &value) != AARTSAAPI_OK)
+                value = std::string_view();
+
+            ConfigSnapshotNode node;
+            node.name = intern(cinfo.name);
+            node.title = intern(cinfo.title);
+            node.unit = intern(cinfo.unit);
+            node.options = intern(cinfo.options);
+            node.value = intern(std::string(value));
+            node.parent = parent;
+            node.firstChild = npos;
+            node.nextSibling = npos;
+            node.type = int32_t(cinfo.type);
+            node.depth = depth;
+            node.disabledOptions = cinfo.disabledOptions;
+            node.minValue = cinfo.minValue;
+            node.maxValue = cinfo.maxValue;
+            node.stepValue = cinfo.stepValue;
+
+            uint32_t index = uint32_t(m_nodes.size());
+            m_nodes.push_back(node);
+            if (previous != npos)
+                m_nodes[previous].nextSibling = index;
+            else if (parent != npos)
+                m_nodes[parent].firstChild = index;
+            previous = index;
+
+            if (cinfo.type == AARTSAAPI_CONFIG_TYPE_GROUP)
+            {
+                res = walk(sdkWrapper, dhandle, &config, index, depth + 1);
+                if (res != AARTSAAPI_OK)
+                    return res;
+            }
+        } while (sdkWrapper.ConfigNext(dhandle, group, &config) == AARTSAAPI_OK);
+
+        return AARTSAAPI_OK;
+    }
+
+    bool ConfigSnapshot::save(const std::string& fileName) const
+    {
+        SnapshotFileHeader header;
+        std::memcpy(header.magic, SnapshotMagic, sizeof(header.magic));
+        header.formatVersion = SnapshotFormatVersion;
+        header.nodeSize = sizeof(ConfigSnapshotNode);
+        header.nodeCount = uint32_t(m_nodes.size());
+        header.stringBytes = uint32_t(m_strings.size());
+        header.deviceTypeLength = uint32_t(m_deviceType.size());
+        header.firmwareLength = uint32_t(m_firmware.size());
+
+        // Write beside the target and rename, so a concurrent start never sees half a file
+        std::string tempName = fileName + ".tmp";
+        {
+            std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(m_deviceType.data(), m_deviceType.size());
+            out.write(m_firmware.data(), m_firmware.size());
+            out.write(reinterpret_cast<const char*>(m_nodes.data()), m_nodes.size() * sizeof(ConfigSnapshotNode));
+            out.write(m_strings.data(), m_strings.size());
+            if (!out)
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempName, fileName, ec);
+        return !ec;
+    }
+
+    bool ConfigSnapshot::load(const std::string& fileName, const std::string& deviceType, const std::string& firmware)
+    {
+        reset();
+
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in)
+            return false;
+
+        SnapshotFileHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+        if (std::memcmp(header.magic, SnapshotMagic, sizeof(header.magic)) != 0
+            || header.formatVersion != SnapshotFormatVersion
+            || header.nodeSize != sizeof(ConfigSnapshotNode)
+            || header.stringBytes == 0
+            || header.deviceTypeLength != deviceType.size()
+            || header.firmwareLength != firmware.size())
+            return false;
+
+        std::string key(header.deviceTypeLength + header.firmwareLength, '\0');
+        if (!in.read(&key[0], key.size()) || key != deviceType + firmware)
+            return false;
+
+        m_nodes.resize(header.nodeCount);
+        m_strings.resize(header.stringBytes);
+        if (!in.read(reinterpret_cast<char*>(m_nodes.data()), m_nodes.size() * sizeof(ConfigSnapshotNode))
+            || !in.read(&m_strings[0], m_strings.size())
+            || m_strings.back() != '\0')
+        {
+            reset();
+            return false;
+        }
+
+        // Depth first order, parents come before and children after a node, which
+        // also rules out cycles in a damaged file
+        for (uint32_t i = 0; i < header.nodeCount; i++)
+        {
+            const ConfigSnapshotNode& node = m_nodes[i];
+            bool stringsValid = node.name < header.stringBytes && node.title < header.stringBytes && node.unit < header.stringBytes
+                && node.options < header.stringBytes && node.value < header.stringBytes;
+            bool linksValid = (node.parent == npos || node.parent < i)
+                && (node.firstChild == npos || (node.firstChild > i && node.firstChild < header.nodeCount))
+                && (node.nextSibling == npos || (node.nextSibling > i && node.nextSibling < header.nodeCount));
+            if (!stringsValid || !linksValid)
+            {
+                reset();
+                return false;
+            }
+        }
+
+        m_deviceType = deviceType;
+        m_firmware = firmware;
+        return true;
+    }
+
+    std::string ConfigSnapshot::cacheFileName(const std::string& directory, const std::string& deviceType, const std::string& firmware)
+    {
+        std::filesystem::path file(directory);
+        file /= "configtree_" + fileNamePart(deviceType) + "_" + fileNamePart(firmware) + ".bin";
+        return file.string();
+    }
+
+    uint32_t ConfigSnapshot::find(const std::string& path) const
+    {
+        uint32_t index = m_nodes.empty() ? npos : 0;
+        size_t start = 0;
+        while (index != npos)
+        {
+            size_t end = path.find('/', start);
+            std::string_view name = std::string_view(path).substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+            while (index != npos && name != string(m_nodes[index].name))
+                index = m_nodes[index].nextSibling;
+
+            if (index == npos || end == std::string::npos)
+                return index;
+
+            index = m_nodes[index].firstChild;
+            start = end + 1;
+        }
+        return npos;
+    }
+
+    std::string ConfigSnapshot::path(uint32_t index) const
+    {
+        std::string result;
+        for (; index != npos; index = m_nodes[index].parent)
+        {
+            if (!result.empty())
+                result.insert(0, 1, '/');
+            result.insert(0, string(m_nodes[index].name));
+        }
+        return result;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef CONFIGSNAPSHOT_H
+#define CONFIGSNAPSHOT_H
+
+#include "AaroniaRtsaSdkWrapper.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // One config item of a snapshot. Strings are offsets into the interned string
+    // pool, links are node indices or ConfigSnapshot::npos.
+    struct ConfigSnapshotNode
+    {
+        uint32_t name;
+        uint32_t title;
+        uint32_t unit;
+        uint32_t options;
+        uint32_t value;
+        uint32_t parent;
+        uint32_t firstChild;
+        uint32_t nextSibling;
+        int32_t type;           // AARTSAAPI_ConfigType
+        uint32_t depth;
+        uint64_t disabledOptions;
+        double minValue, maxValue, stepValue;
+    };
+
+    // Flattened copy of a config tree, walked once from the SDK and stored as a
+    // contiguous node array in depth first order. A snapshot can be saved to a
+    // binary cache file keyed by device type and firmware, so later starts can load
+    // the layout instead of walking the tree item by item. The file uses the host
+    // byte order and is meant as a local cache, not as an exchange format.
+    class ConfigSnapshot
+    {
+    public:
+        static const uint32_t npos = UINT32_MAX;
+
+        ConfigSnapshot();
+
+        // Walk all items below root, e.g. from ConfigRoot or ConfigHealth
+        AARTSAAPI_Result capture(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, AARTSAAPI_Config* root, const std::string& deviceType, const std::string& firmware);
+
+        bool save(const std::string& fileName) const;
+
+        // Fails if the file is missing, damaged or was written for another device type or firmware
+        bool load(const std::string& fileName, const std::string& deviceType, const std::string& firmware);
+
+        static std::string cacheFileName(const std::string& directory, const std::string& deviceType, const std::string& firmware);
+
+        uint32_t size() const { return uint32_t(m_nodes.size()); }
+        bool empty() const { return m_nodes.empty(); }
+        const ConfigSnapshotNode& node(uint32_t index) const { return m_nodes[index]; }
+        const char* string(uint32_t offset) const { return m_strings.data() + offset; }
+
+        const std::string& deviceType() const { return m_deviceType; }
+        const std::string& firmware() const { return m_firmware; }
+
+        // Index of a slash separated path like "device/fft0/fftwindow", npos if absent
+        uint32_t find(const std::string& path) const;
+        std::string path(uint32_t index) const;
+
+    private:
+        AARTSAAPI_Result walk(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, uint32_t parent, uint32_t depth);
+        uint32_t intern(const std::string& str);
+        void reset();
+
+        std::vector<ConfigSnapshotNode> m_nodes;
+        std::string m_strings;                                  // zero terminated strings, offset 0 is ""
+        std::unordered_map<std::string, uint32_t> m_interned;   // only used while capturing
+        std::string m_deviceType;
+        std::string m_firmware;
+    };
+}
+
+#endif
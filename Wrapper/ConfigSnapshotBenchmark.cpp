@@ -0,0 +1,90 @@
+#include "BenchmarkSupport.h"
+#include "ConfigSnapshot.h"
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+
+// Compares walking the config tree of a raw device through the SDK, the way
+// ConfigTree and WrapperSample do, with loading the cached snapshot of it.
+
+using namespace AarRtsaSdkWrapper;
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const int iterations = NumberArgument<int>(argc, argv, 2, 2000);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+    if (!bench.isOpen())
+        return -1;
+
+    AARTSAAPI_Device* d = bench.device();
+
+    // The SDK does not report the device firmware, the library version stands in for it
+    const std::string deviceType = "spectranv6/raw";
+    const std::string firmware = std::to_string(sdkWrapper.Version());
+    const std::string fileName = ConfigSnapshot::cacheFileName(std::filesystem::temp_directory_path().string(), deviceType, firmware);
+
+    ConfigSnapshot walked;
+    AARTSAAPI_Config root;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        AARTSAAPI_Result res = sdkWrapper.ConfigRoot(d, &root);
+        if (res == AARTSAAPI_OK)
+            res = walked.capture(sdkWrapper, d, &root, deviceType, firmware);
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "Walking the config tree failed: " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+    }
+    double walkTime = SecondsSince(start);
+
+    if (!walked.save(fileName))
+    {
+        std::cerr << "Saving " << fileName << " failed" << std::endl;
+        return -1;
+    }
+
+    ConfigSnapshot loaded;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        if (!loaded.load(fileName, deviceType, firmware))
+        {
+            std::cerr << "Loading " << fileName << " failed" << std::endl;
+            return -1;
+        }
+    }
+    double loadTime = SecondsSince(start);
+
+    // The cached snapshot has to describe the same tree
+
+    bool same = loaded.size() == walked.size();
+    for (uint32_t i = 0; same && i < walked.size(); i++)
+    {
+        same = walked.path(i) == loaded.path(i)
+            && std::strcmp(walked.string(walked.node(i).value), loaded.string(loaded.node(i).value)) == 0
+            && std::strcmp(walked.string(walked.node(i).options), loaded.string(loaded.node(i).options)) == 0;
+    }
+    if (!same || loaded.find("device/fft0/fftwindow") == ConfigSnapshot::npos)
+    {
+        std::cerr << "Loaded snapshot differs from the walked tree" << std::endl;
+        return -1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Snapshot      : " << walked.size() << " items, " << std::filesystem::file_size(fileName) << " bytes in " << fileName << std::endl
+        << "Tree walk     : " << walkTime / iterations * 1e6 << " us" << std::endl
+        << "Cached load   : " << loadTime / iterations * 1e6 << " us" << std::endl
+        << "Speedup       : " << walkTime / loadTime << "x" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "ContinuityMonitor.h"
+#include <cmath>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        uint64_t bucketPercentile(const std::vector<uint64_t>& buckets, uint64_t count, uint64_t maxSamples, double fraction)
+        {
+            return count ? LatencyPercentile(buckets.data(), count, maxSamples, fraction) : 0;
+        }
+    }
+
+    uint64_t ContinuityStatistics::gapPercentile(double fraction) const
+    {
+        return bucketPercentile(gapBuckets, gaps, maxGapSamples, fraction);
+    }
+
+    uint64_t ContinuityStatistics::overlapPercentile(double fraction) const
+    {
+        return bucketPercentile(overlapBuckets, overlaps, maxOverlapSamples, fraction);
+    }
+
+    ContinuityMonitor::ContinuityMonitor(double toleranceSamples)
+        : m_toleranceSamples(toleranceSamples > 0 ? toleranceSamples : 0.5)
+    {
+        reset();
+    }
+
+    void ContinuityMonitor::reset()
+    {
+        m_lastEnd = -1;
+        for (Counter* counter : { &m_packets, &m_samples, &m_gaps, &m_droppedSamples, &m_overlaps, &m_overlappedSamples, &m_unflaggedGaps,
+                 &m_streamStarts, &m_streamEnds, &m_segmentStarts, &m_segmentEnds, &m_maxGapSamples, &m_maxOverlapSamples })
+            counter->store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < LatencyBucketCount; i++)
+        {
+            m_gapBuckets[i].store(0, std::memory_order_relaxed);
+            m_overlapBuckets[i].store(0, std::memory_order_relaxed);
+        }
+        m_lastGapStart.store(0, std::memory_order_relaxed);
+        m_lastGapEnd.store(0, std::memory_order_relaxed);
+    }
+
+    int64_t ContinuityMonitor::check(const AARTSAAPI_Packet& packet)
+    {
+        add(m_packets, 1);
+        add(m_samples, packet.num > 0 ? uint64_t(packet.num) : 0);
+
+        const int64_t flags = packet.flags;
+        if (flags & AARTSAAPI_PACKET_STREAM_START)
+        {
+            add(m_streamStarts, 1);
+            m_lastEnd = -1;
+        }
+        if (flags & AARTSAAPI_PACKET_SEGMENT_START)
+            add(m_segmentStarts, 1);
+        if (flags & AARTSAAPI_PACKET_SEGMENT_END)
+            add(m_segmentEnds, 1);
+
+        int64_t missing = 0;
+        if (m_lastEnd >= 0 && packet.stepFrequency > 0)
+        {
+            double offset = (packet.startTime - m_lastEnd) * packet.stepFrequency;
+            if (std::fabs(offset) > m_toleranceSamples)
+            {
+                missing = std::llround(offset);
+                uint64_t length = uint64_t(missing > 0 ? missing : -missing);
+                if (length == 0)
+                    length = 1;
+
+                if (offset > 0)
+                {
+                    add(m_gaps, 1);
+                    add(m_droppedSamples, length);
+                    add(m_gapBuckets[LatencyBucketIndex(length)], 1);
+                    raise(m_maxGapSamples, length);
+                    if (!(flags & AARTSAAPI_PACKET_SEGMENT_START))
+                        add(m_unflaggedGaps, 1);
+                }
+                else
+                {
+                    add(m_overlaps, 1);
+                    add(m_overlappedSamples, length);
+                    add(m_overlapBuckets[LatencyBucketIndex(length)], 1);
+                    raise(m_maxOverlapSamples, length);
+                }
+                m_lastGapStart.store(m_lastEnd, std::memory_order_relaxed);
+                m_lastGapEnd.store(packet.startTime, std::memory_order_relaxed);
+            }
+        }
+
+        m_lastEnd = packet.endTime;
+        if (flags & AARTSAAPI_PACKET_STREAM_END)
+        {
+            add(m_streamEnds, 1);
+            m_lastEnd = -1;
+        }
+        return missing;
+    }
+
+    ContinuityStatistics ContinuityMonitor::statistics() const
+    {
+        ContinuityStatistics stats;
+        stats.packets = m_packets.load(std::memory_order_relaxed);
+        stats.samples = m_samples.load(std::memory_order_relaxed);
+        stats.gaps = m_gaps.load(std::memory_order_relaxed);
+        stats.droppedSamples = m_droppedSamples.load(std::memory_order_relaxed);
+        stats.overlaps = m_overlaps.load(std::memory_order_relaxed);
+        stats.overlappedSamples = m_overlappedSamples.load(std::memory_order_relaxed);
+        stats.unflaggedGaps = m_unflaggedGaps.load(std::memory_order_relaxed);
+        stats.streamStarts = m_streamStarts.load(std::memory_order_relaxed);
+        stats.streamEnds = m_streamEnds.load(std::memory_order_relaxed);
+        stats.segmentStarts = m_segmentStarts.load(std::memory_order_relaxed);
+        stats.segmentEnds = m_segmentEnds.load(std::memory_order_relaxed);
+        stats.maxGapSamples = m_maxGapSamples.load(std::memory_order_relaxed);
+        stats.maxOverlapSamples = m_maxOverlapSamples.load(std::memory_order_relaxed);
+        stats.lastGapStart = m_lastGapStart.load(std::memory_order_relaxed);
+        stats.lastGapEnd = m_lastGapEnd.load(std::memory_order_relaxed);
+
+        stats.gapBuckets.resize(LatencyBucketCount);
+        stats.overlapBuckets.resize(LatencyBucketCount);
+        for (size_t i = 0; i < LatencyBucketCount; i++)
+        {
+            stats.gapBuckets[i] = m_gapBuckets[i].load(std::memory_order_relaxed);
+            stats.overlapBuckets[i] = m_overlapBuckets[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef CONTINUITYMONITOR_H
+#define CONTINUITYMONITOR_H
+
+#include "LatencyHistogram.h"
+#include <aaroniartsaapi.h>
+#include <atomic>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct ContinuityStatistics
+    {
+        uint64_t packets, samples;
+        uint64_t gaps, droppedSamples;              // packets starting later than the previous one ended
+        uint64_t overlaps, overlappedSamples;       // packets starting before the previous one ended
+        uint64_t unflaggedGaps;                     // gaps without AARTSAAPI_PACKET_SEGMENT_START on the packet
+        uint64_t streamStarts, streamEnds, segmentStarts, segmentEnds;
+        uint64_t maxGapSamples, maxOverlapSamples;
+        double lastGapStart, lastGapEnd;            // time span of the latest gap or overlap, 0 before the first
+
+        // Gap and overlap lengths in samples, in the logarithmic latency buckets
+        std::vector<uint64_t> gapBuckets, overlapBuckets;
+
+        uint64_t gapPercentile(double fraction) const;
+        uint64_t overlapPercentile(double fraction) const;
+    };
+
+    // Checks the timestamps of one channel's packets for continuity: a packet
+    // should start where the previous one ended, within half a sample at its
+    // stepFrequency (or the tolerance given in samples). Missing and repeated
+    // samples are counted and their lengths kept in histograms, the stream and
+    // segment flags are counted as they pass. A stream start begins a new
+    // timeline, so no gap is counted across a restart.
+    //
+    // check is meant for the one thread reading the channel and costs a few
+    // compares and relaxed stores; statistics may be called from any thread.
+    class ContinuityMonitor
+    {
+    public:
+        explicit ContinuityMonitor(double toleranceSamples = 0.5);
+
+        ContinuityMonitor(const ContinuityMonitor&) = delete;
+        ContinuityMonitor& operator=(const ContinuityMonitor&) = delete;
+
+        // Returns the samples missing before the packet, negative for an overlap
+        int64_t check(const AARTSAAPI_Packet& packet);
+
+        ContinuityStatistics statistics() const;
+
+        // Not concurrently with check
+        void reset();
+
+    private:
+        typedef std::atomic<uint64_t> Counter;
+
+        static void add(Counter& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        static void raise(Counter& counter, uint64_t value)
+        {
+            if (value > counter.load(std::memory_order_relaxed))
+                counter.store(value, std::memory_order_relaxed);
+        }
+
+        double m_toleranceSamples;
+        double m_lastEnd;       // end time of the previous packet, negative without one
+
+        Counter m_packets, m_samples;
+        Counter m_gaps, m_droppedSamples, m_overlaps, m_overlappedSamples, m_unflaggedGaps;
+        Counter m_streamStarts, m_streamEnds, m_segmentStarts, m_segmentEnds;
+        Counter m_maxGapSamples, m_maxOverlapSamples;
+        std::atomic<double> m_lastGapStart, m_lastGapEnd;
+        Counter m_gapBuckets[LatencyBucketCount];
+        Counter m_overlapBuckets[LatencyBucketCount];
+    };
+}
+
+#endif
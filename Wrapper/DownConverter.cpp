@@ -0,0 +1,64 @@
+#include "DownConverter.h"
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+namespace AarRtsaSdkWrapper
+{
+
+    DownConverter::DownConverter(double frequency, const IqResamplerSettings& resampling)
+        : m_frequency(frequency), m_resampler(resampling)
+    {
+        reset();
+    }
+
+    void DownConverter::reset()
+    {
+        m_resampler.reset();
+        m_timing.reset();
+        m_phase = 0;
+    }
+
+    size_t DownConverter::process(const AARTSAAPI_Packet& in, AARTSAAPI_Packet& out)
+    {
+        if (in.size < 2 || in.num <= 0 || !in.fp32 || in.stepFrequency <= 0)
+            return m_resampler.process(in, out);
+
+        // Same restart rule as the resampler, which restarts along with it
+        if (m_timing.advance(in))
+            m_phase = 0;
+
+        // The rotator is reseeded from the phase every packet and advanced in
+        // double precision, so it neither drifts in amplitude nor in phase;
+        // next to the filter the mix costs little
+        const size_t samples = size_t(in.num);
+        const double offset = m_frequency - (in.startFrequency + in.spanFrequency / 2);
+        const double step = offset / in.stepFrequency;
+        std::complex<double> rotator = std::polar(1.0, -2 * std::numbers::pi * m_phase);
+        const std::complex<double> advance = std::polar(1.0, -2 * std::numbers::pi * step);
+        m_mixed.resize(2 * samples);
+        for (size_t j = 0; j < samples; j++)
+        {
+            const float* s = in.fp32 + j * size_t(in.stride);
+            double i = s[0], q = s[1];
+            m_mixed[2 * j] = float(i * rotator.real() - q * rotator.imag());
+            m_mixed[2 * j + 1] = float(i * rotator.imag() + q * rotator.real());
+            rotator *= advance;
+        }
+        m_phase = std::fmod(m_phase + step * double(samples), 1.0);
+        if (m_phase < 0)
+            m_phase += 1;
+
+        // Centered on the channel, so the resampler cuts the span around it
+        AARTSAAPI_Packet mixed = in;
+        mixed.size = mixed.stride = 2;
+        mixed.fp32 = m_mixed.data();
+        mixed.startFrequency = m_frequency - in.spanFrequency / 2;
+        return m_resampler.process(mixed, out);
+    }
+
+    void DownConvertChannels(WorkerPool& pool, std::vector<DownConverter>& converters, const AARTSAAPI_Packet& in, AARTSAAPI_Packet* out)
+    {
+        pool.parallelFor(converters.size(), [&](size_t c) { converters[c].process(in, out[c]); });
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef DOWNCONVERTER_H
+#define DOWNCONVERTER_H
+
+#include "IqResampler.h"
+#include "StreamTiming.h"
+#include "WorkerPool.h"
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Digital down converter for one channel at an arbitrary frequency of a
+    // wideband IQ stream, for the channels a Channelizer grid does not fit: a
+    // numerically controlled oscillator mixes the channel to 0 Hz, an
+    // IqResampler filters and lowers the rate, e.g. IqResamplerSettings(1, 64)
+    // for a 64th of the input rate, its bandwidth setting giving the part of
+    // the output band passed.
+    //
+    // The oscillator phase runs on from packet to packet and starts at zero
+    // with every restart of the resampler, a gap or a rate change. Changing
+    // the frequency keeps the phase.
+    class DownConverter
+    {
+    public:
+        DownConverter(double frequency = 0, const IqResamplerSettings& resampling = IqResamplerSettings());
+
+        // Channel center in Hz, on the same scale as the packet frequencies
+        double frequency() const { return m_frequency; }
+        void setFrequency(double frequency) { m_frequency = frequency; }
+
+        const IqResampler& resampler() const { return m_resampler; }
+
+        // Converts an IQ packet (size 2, or the first receiver of Rx12). out is
+        // centered on frequency() with the span the resampler passes, and
+        // points into the converter until the next call; it may have no
+        // samples. Returns out.num.
+        size_t process(const AARTSAAPI_Packet& in, AARTSAAPI_Packet& out);
+
+        // Drops the filter state, the timing and the oscillator phase
+        void reset();
+
+    private:
+        double m_frequency;
+        IqResampler m_resampler;
+        double m_phase;                 // cycles of the oscillator at the next input sample, in [0, 1)
+        StreamTiming m_timing;          // only the restarts, the resampler keeps the flags
+        std::vector<float> m_mixed;
+    };
+
+    // Converts one packet into one channel per converter, the converters spread
+    // over the pool. out[c] as from DownConverter::process.
+    void DownConvertChannels(WorkerPool& pool, std::vector<DownConverter>& converters, const AARTSAAPI_Packet& in, AARTSAAPI_Packet* out);
+}
+
+#endif
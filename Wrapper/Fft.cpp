@@ -0,0 +1,210 @@
+#include "Fft.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+
+#if defined(WRAPPER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(WRAPPER_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Butterflies of one stage from the given sample on, the twiddles of
+        // the stage in w. The products are written out, std::complex checks for
+        // infinities; the SIMD kernels do the same operations.
+        template <bool Inverse>
+        void stageScalar(float* d, const float* w, size_t size, size_t half)
+        {
+            for (size_t block = 0; block < size; block += 2 * half)
+            {
+                float* a = d + 2 * block;
+                float* b = a + 2 * half;
+                for (size_t j = 0; j < half; j++)
+                {
+                    float wr = w[2 * j], wi = Inverse ? -w[2 * j + 1] : w[2 * j + 1];
+                    float br = b[2 * j] * wr - b[2 * j + 1] * wi;
+                    float bi = b[2 * j + 1] * wr + b[2 * j] * wi;
+                    float ar = a[2 * j], ai = a[2 * j + 1];
+                    a[2 * j] = ar + br;
+                    a[2 * j + 1] = ai + bi;
+                    b[2 * j] = ar - br;
+                    b[2 * j + 1] = ai - bi;
+                }
+            }
+        }
+
+        // Stages of half length 1 and 2, the twiddles are 1 and -i (i inverse)
+        template <bool Inverse>
+        void radix4Scalar(float* d, size_t size)
+        {
+            for (size_t k = 0; k < 2 * size; k += 8)
+            {
+                float* x = d + k;
+                float b0r = x[0] + x[2], b0i = x[1] + x[3], b1r = x[0] - x[2], b1i = x[1] - x[3];
+                float b2r = x[4] + x[6], b2i = x[5] + x[7], b3r = x[4] - x[6], b3i = x[5] - x[7];
+                float tr = Inverse ? -b3i : b3i, ti = Inverse ? b3r : -b3r;
+                x[0] = b0r + b2r;
+                x[1] = b0i + b2i;
+                x[4] = b0r - b2r;
+                x[5] = b0i - b2i;
+                x[2] = b1r + tr;
+                x[3] = b1i + ti;
+                x[6] = b1r - tr;
+                x[7] = b1i - ti;
+            }
+        }
+
+#if defined(WRAPPER_SIMD_SSE2)
+
+        // Two complex per vector, half is at least 4
+        template <bool Inverse>
+        void stageSse2(float* d, const float* w, size_t size, size_t half)
+        {
+            // Negates the real (forward) or imaginary (inverse) part of the cross products
+            const __m128 sign = Inverse ? _mm_castsi128_ps(_mm_set_epi32(int(0x80000000), 0, int(0x80000000), 0))
+                                        : _mm_castsi128_ps(_mm_set_epi32(0, int(0x80000000), 0, int(0x80000000)));
+            for (size_t block = 0; block < size; block += 2 * half)
+            {
+                float* a = d + 2 * block;
+                float* b = a + 2 * half;
+                for (size_t j = 0; j < half; j += 2)
+                {
+                    __m128 t = _mm_loadu_ps(w + 2 * j);
+                    __m128 x = _mm_loadu_ps(b + 2 * j);
+                    __m128 wr = _mm_shuffle_ps(t, t, 0xA0), wi = _mm_shuffle_ps(t, t, 0xF5);
+                    __m128 cross = _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(x, x, 0xB1), wi), sign);
+                    __m128 p = _mm_add_ps(_mm_mul_ps(x, wr), cross);
+                    __m128 y = _mm_loadu_ps(a + 2 * j);
+                    _mm_storeu_ps(a + 2 * j, _mm_add_ps(y, p));
+                    _mm_storeu_ps(b + 2 * j, _mm_sub_ps(y, p));
+                }
+            }
+        }
+
+#endif
+
+#if defined(WRAPPER_SIMD_AVX2)
+
+        // Four complex per vector, half is at least 4
+        template <bool Inverse>
+        WRAPPER_TARGET_AVX2 void stageAvx2(float* d, const float* w, size_t size, size_t half)
+        {
+            const __m256 sign = Inverse ? _mm256_castsi256_ps(_mm256_set1_epi64x(int64_t(0x8000000000000000ull)))
+                                        : _mm256_castsi256_ps(_mm256_set1_epi64x(int64_t(0x80000000ull)));
+            for (size_t block = 0; block < size; block += 2 * half)
+            {
+                float* a = d + 2 * block;
+                float* b = a + 2 * half;
+                for (size_t j = 0; j < half; j += 4)
+                {
+                    __m256 t = _mm256_loadu_ps(w + 2 * j);
+                    __m256 x = _mm256_loadu_ps(b + 2 * j);
+                    __m256 cross = _mm256_xor_ps(_mm256_mul_ps(_mm256_permute_ps(x, 0xB1), _mm256_movehdup_ps(t)), sign);
+                    __m256 p = _mm256_add_ps(_mm256_mul_ps(x, _mm256_moveldup_ps(t)), cross);
+                    __m256 y = _mm256_loadu_ps(a + 2 * j);
+                    _mm256_storeu_ps(a + 2 * j, _mm256_add_ps(y, p));
+                    _mm256_storeu_ps(b + 2 * j, _mm256_sub_ps(y, p));
+                }
+            }
+        }
+
+#endif
+    }
+
+    FftPlan::FftPlan(size_t size)
+        : m_size(size)
+    {
+        unsigned bits = 0;
+        while ((size_t(1) << bits) < size)
+            bits++;
+        for (size_t i = 0; i < size; i++)
+        {
+            size_t r = 0;
+            for (unsigned b = 0; b < bits; b++)
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            if (i < r)
+            {
+                m_swaps.push_back(uint32_t(i));
+                m_swaps.push_back(uint32_t(r));
+            }
+        }
+
+        // Computed in double, so large sizes keep float accuracy
+        m_twiddles.resize(size > 0 ? size - 1 : 0);
+        for (size_t half = 1; half < size; half *= 2)
+        {
+            for (size_t j = 0; j < half; j++)
+            {
+                double angle = -std::numbers::pi * double(j) / double(half);
+                m_twiddles[half - 1 + j] = std::complex<float>(float(std::cos(angle)), float(std::sin(angle)));
+            }
+        }
+    }
+
+    std::shared_ptr<const FftPlan> FftPlan::get(size_t size)
+    {
+        if (size < 2 || (size & (size - 1)) != 0)
+            return nullptr;
+
+        static std::mutex lock;
+        static std::map<size_t, std::shared_ptr<const FftPlan>> plans;
+        std::lock_guard<std::mutex> guard(lock);
+        std::shared_ptr<const FftPlan>& plan = plans[size];
+        if (!plan)
+            plan = std::make_shared<const FftPlan>(size);
+        return plan;
+    }
+
+    template <bool Inverse>
+    void FftPlan::transform(std::complex<float>* data, SimdLevel level) const
+    {
+        for (size_t s = 0; s < m_swaps.size(); s += 2)
+            std::swap(data[m_swaps[s]], data[m_swaps[s + 1]]);
+
+        float* d = reinterpret_cast<float*>(data);
+        const float* tw = reinterpret_cast<const float*>(m_twiddles.data());
+        if (m_size < 4)
+        {
+            stageScalar<Inverse>(d, tw, m_size, 1);
+            return;
+        }
+        radix4Scalar<Inverse>(d, m_size);
+        level = ClampSimdLevel(level);
+        for (size_t half = 4; half < m_size; half *= 2)
+        {
+            const float* w = tw + 2 * (half - 1);
+            switch (level)
+            {
+#if defined(WRAPPER_SIMD_AVX2)
+            case SimdLevel::AVX2:
+                stageAvx2<Inverse>(d, w, m_size, half);
+                break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            case SimdLevel::SSE2:
+                stageSse2<Inverse>(d, w, m_size, half);
+                break;
+#endif
+            default:
+                stageScalar<Inverse>(d, w, m_size, half);
+                break;
+            }
+        }
+    }
+
+    void FftPlan::forward(std::complex<float>* data, SimdLevel level) const
+    {
+        transform<false>(data, level);
+    }
+
+    void FftPlan::inverse(std::complex<float>* data, SimdLevel level) const
+    {
+        transform<true>(data, level);
+    }
+}
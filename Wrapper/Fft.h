@@ -0,0 +1,47 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include "SimdSupport.h"
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // In place radix-2 FFT of one power of two size. The bit reversal and the
+    // twiddles of every stage are computed once, stored stage by stage so each
+    // stage reads them in order. The first two stages need no multiplies and
+    // run as one radix-4 pass, the others with SIMD butterflies; every SIMD
+    // level gives the same result. A plan is immutable and may be used by any
+    // number of threads at once.
+    class FftPlan
+    {
+    public:
+        explicit FftPlan(size_t size);
+
+        // Shared plan of the given size, built on first use. Sizes that are not
+        // a power of two or below 2 give nullptr.
+        static std::shared_ptr<const FftPlan> get(size_t size);
+
+        size_t size() const { return m_size; }
+
+        // X[k] = sum x[n] e^(-2 pi i k n / N), unnormalized
+        void forward(std::complex<float>* data, SimdLevel level = DetectSimdLevel()) const;
+
+        // x[n] = sum X[k] e^(+2 pi i k n / N), unnormalized, N times the inverse
+        void inverse(std::complex<float>* data, SimdLevel level = DetectSimdLevel()) const;
+
+    private:
+        template <bool Inverse>
+        void transform(std::complex<float>* data, SimdLevel level) const;
+
+        size_t m_size;
+        std::vector<uint32_t> m_swaps;                  // index pairs of the bit reversal permutation
+        std::vector<std::complex<float>> m_twiddles;    // stage of half length h at offset h - 1
+    };
+}
+
+#endif
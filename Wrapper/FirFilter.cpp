@@ -0,0 +1,187 @@
+#include "FirFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#if defined(WRAPPER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(WRAPPER_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Modified Bessel function of the first kind, order 0
+        double besselI0(double x)
+        {
+            double sum = 1, term = 1, half = x / 2;
+            for (int k = 1; k < 64 && term > 1e-12 * sum; k++)
+            {
+                term *= (half / k) * (half / k);
+                sum += term;
+            }
+            return sum;
+        }
+
+        double kaiserBeta(double stopbandDb)
+        {
+            if (stopbandDb > 50)
+                return 0.1102 * (stopbandDb - 8.7);
+            if (stopbandDb >= 21)
+                return 0.5842 * std::pow(stopbandDb - 21, 0.4) + 0.07886 * (stopbandDb - 21);
+            return 0;
+        }
+
+#if defined(WRAPPER_SIMD_SSE2)
+
+        size_t dotSse2(const float* iq, const float* taps, size_t count, __m128& sum)
+        {
+            __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+            size_t k = 0;
+            for (; k + 4 <= count; k += 4)
+            {
+                a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(iq + 2 * k), _mm_loadu_ps(taps + 2 * k)));
+                a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(iq + 2 * k + 4), _mm_loadu_ps(taps + 2 * k + 4)));
+            }
+            sum = _mm_add_ps(a0, a1);
+            return k;
+        }
+
+        size_t multiplyAddSse2(const float* iq, const float* taps, size_t floats, float* acc)
+        {
+            size_t k = 0;
+            for (; k + 4 <= floats; k += 4)
+                _mm_storeu_ps(acc + k, _mm_add_ps(_mm_loadu_ps(acc + k), _mm_mul_ps(_mm_loadu_ps(iq + k), _mm_loadu_ps(taps + k))));
+            return k;
+        }
+
+#endif
+
+#if defined(WRAPPER_SIMD_AVX2)
+
+        WRAPPER_TARGET_AVX2 size_t dotAvx2(const float* iq, const float* taps, size_t count, __m128& sum)
+        {
+            __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+            size_t k = 0;
+            for (; k + 8 <= count; k += 8)
+            {
+                a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_loadu_ps(iq + 2 * k), _mm256_loadu_ps(taps + 2 * k)));
+                a1 = _mm256_add_ps(a1, _mm256_mul_ps(_mm256_loadu_ps(iq + 2 * k + 8), _mm256_loadu_ps(taps + 2 * k + 8)));
+            }
+            a0 = _mm256_add_ps(a0, a1);
+            sum = _mm_add_ps(_mm256_castps256_ps128(a0), _mm256_extractf128_ps(a0, 1));
+            if (k + 4 <= count)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(iq + 2 * k), _mm_loadu_ps(taps + 2 * k)));
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(iq + 2 * k + 4), _mm_loadu_ps(taps + 2 * k + 4)));
+                k += 4;
+            }
+            return k;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t multiplyAddAvx2(const float* iq, const float* taps, size_t floats, float* acc)
+        {
+            size_t k = 0;
+            for (; k + 8 <= floats; k += 8)
+                _mm256_storeu_ps(acc + k, _mm256_add_ps(_mm256_loadu_ps(acc + k), _mm256_mul_ps(_mm256_loadu_ps(iq + k), _mm256_loadu_ps(taps + k))));
+            return k;
+        }
+
+#endif
+    }
+
+    std::vector<float> DesignLowpassFir(size_t taps, double cutoff, double stopbandDb)
+    {
+        std::vector<float> fir(taps);
+        if (taps == 0)
+            return fir;
+
+        const double beta = kaiserBeta(stopbandDb), center = double(taps - 1) / 2, norm = besselI0(beta);
+        std::vector<double> h(taps);
+        double sum = 0;
+        for (size_t n = 0; n < taps; n++)
+        {
+            double x = double(n) - center;
+            double sinc = x == 0 ? 2 * cutoff : std::sin(2 * std::numbers::pi * cutoff * x) / (std::numbers::pi * x);
+            double r = center > 0 ? x / center : 0;
+            h[n] = sinc * besselI0(beta * std::sqrt(std::max(0.0, 1 - r * r))) / norm;
+            sum += h[n];
+        }
+        for (size_t n = 0; n < taps; n++)
+            fir[n] = float(h[n] / sum);
+        return fir;
+    }
+
+    size_t LowpassFirTaps(double transition, double stopbandDb)
+    {
+        if (transition <= 0)
+            return 1;
+        return size_t(std::ceil((stopbandDb - 7.95) / (14.36 * transition))) + 1;
+    }
+
+    void FirDotIq(const float* iq, const float* pairedTaps, size_t taps, float* out, SimdLevel level)
+    {
+        float i = 0, q = 0;
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+        {
+            __m128 sum;
+            done = dotAvx2(iq, pairedTaps, taps, sum);
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));     // I in lane 0, Q in lane 1
+            i = _mm_cvtss_f32(sum);
+            q = _mm_cvtss_f32(_mm_shuffle_ps(sum, sum, 1));
+            break;
+        }
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+        {
+            __m128 sum;
+            done = dotSse2(iq, pairedTaps, taps, sum);
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            i = _mm_cvtss_f32(sum);
+            q = _mm_cvtss_f32(_mm_shuffle_ps(sum, sum, 1));
+            break;
+        }
+#endif
+        default:
+            break;
+        }
+        for (size_t k = done; k < taps; k++)
+        {
+            i += pairedTaps[2 * k] * iq[2 * k];
+            q += pairedTaps[2 * k + 1] * iq[2 * k + 1];
+        }
+        out[0] = i;
+        out[1] = q;
+    }
+
+    void FirMultiplyAddIq(const float* iq, const float* pairedTaps, size_t samples, float* acc, SimdLevel level)
+    {
+        const size_t floats = 2 * samples;
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = multiplyAddAvx2(iq, pairedTaps, floats, acc);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = multiplyAddSse2(iq, pairedTaps, floats, acc);
+            break;
+#endif
+        default:
+            break;
+        }
+        for (size_t k = done; k < floats; k++)
+            acc[k] += pairedTaps[k] * iq[k];
+    }
+}
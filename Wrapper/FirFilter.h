@@ -0,0 +1,33 @@
+#ifndef FIRFILTER_H
+#define FIRFILTER_H
+
+#include "SimdSupport.h"
+#include <cstddef>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Linear phase low pass, a Kaiser windowed sinc with DC gain 1. cutoff is the
+    // -6 dB point in cycles per sample (below 0.5), stopbandDb the attenuation
+    // the window is chosen for; the transition width then follows from the
+    // number of taps.
+    std::vector<float> DesignLowpassFir(size_t taps, double cutoff, double stopbandDb = 80.0);
+
+    // Taps needed for a transition band of the given width, in cycles per
+    // sample, at the given attenuation (Kaiser's estimate)
+    size_t LowpassFirTaps(double transition, double stopbandDb = 80.0);
+
+    // Filter output of interleaved I/Q samples with real taps: the sum of
+    // pairedTaps[2 * k] * iq[2 * k] for I and with the odd floats for Q, over
+    // `taps` samples. pairedTaps holds every tap twice, so I and Q multiply in
+    // the same SIMD lanes; the caller stores the taps reversed for a
+    // convolution. Writes I and Q to out.
+    void FirDotIq(const float* iq, const float* pairedTaps, size_t taps, float* out, SimdLevel level = DetectSimdLevel());
+
+    // Element wise form for filter banks that sum many filters at once:
+    // acc[k] += pairedTaps[k] * iq[k] over 2 * samples floats
+    void FirMultiplyAddIq(const float* iq, const float* pairedTaps, size_t samples, float* acc, SimdLevel level = DetectSimdLevel());
+}
+
+#endif
@@ -0,0 +1,341 @@
+#include "IqInterleave.h"
+
+#if defined(WRAPPER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(WRAPPER_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        void deinterleaveScalar(const float* src, size_t begin, size_t end, float* rx1, float* rx2)
+        {
+            for (size_t j = begin; j < end; j++)
+            {
+                rx1[2 * j] = src[4 * j];
+                rx1[2 * j + 1] = src[4 * j + 1];
+                rx2[2 * j] = src[4 * j + 2];
+                rx2[2 * j + 1] = src[4 * j + 3];
+            }
+        }
+
+        void deinterleavePlanarScalar(const float* src, size_t begin, size_t end, float* i1, float* q1, float* i2, float* q2)
+        {
+            for (size_t j = begin; j < end; j++)
+            {
+                i1[j] = src[4 * j];
+                q1[j] = src[4 * j + 1];
+                i2[j] = src[4 * j + 2];
+                q2[j] = src[4 * j + 3];
+            }
+        }
+
+        void interleaveScalar(const float* rx1, const float* rx2, size_t begin, size_t end, float* dst)
+        {
+            for (size_t j = begin; j < end; j++)
+            {
+                dst[4 * j] = rx1[2 * j];
+                dst[4 * j + 1] = rx1[2 * j + 1];
+                dst[4 * j + 2] = rx2[2 * j];
+                dst[4 * j + 3] = rx2[2 * j + 1];
+            }
+        }
+
+        void interleavePlanarScalar(const float* i1, const float* q1, const float* i2, const float* q2, size_t begin, size_t end, float* dst)
+        {
+            for (size_t j = begin; j < end; j++)
+            {
+                dst[4 * j] = i1[j];
+                dst[4 * j + 1] = q1[j];
+                dst[4 * j + 2] = i2[j];
+                dst[4 * j + 3] = q2[j];
+            }
+        }
+
+#if defined(WRAPPER_SIMD_SSE2)
+
+        // An IQ pair is one 64 bit lane, so the complex layouts only move lanes
+        // and the planar layouts are 4x4 transposes of four samples
+
+        size_t deinterleaveSse2(const float* src, size_t samples, float* rx1, float* rx2)
+        {
+            size_t j = 0;
+            for (; j + 2 <= samples; j += 2)
+            {
+                __m128 a = _mm_loadu_ps(src + 4 * j);       // I1 Q1 I2 Q2 of sample j
+                __m128 b = _mm_loadu_ps(src + 4 * j + 4);   // and of sample j + 1
+                _mm_storeu_ps(rx1 + 2 * j, _mm_movelh_ps(a, b));
+                _mm_storeu_ps(rx2 + 2 * j, _mm_movehl_ps(b, a));
+            }
+            return j;
+        }
+
+        size_t deinterleavePlanarSse2(const float* src, size_t samples, float* i1, float* q1, float* i2, float* q2)
+        {
+            size_t j = 0;
+            for (; j + 4 <= samples; j += 4)
+            {
+                __m128 r0 = _mm_loadu_ps(src + 4 * j);
+                __m128 r1 = _mm_loadu_ps(src + 4 * j + 4);
+                __m128 r2 = _mm_loadu_ps(src + 4 * j + 8);
+                __m128 r3 = _mm_loadu_ps(src + 4 * j + 12);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(i1 + j, r0);
+                _mm_storeu_ps(q1 + j, r1);
+                _mm_storeu_ps(i2 + j, r2);
+                _mm_storeu_ps(q2 + j, r3);
+            }
+            return j;
+        }
+
+        size_t interleaveSse2(const float* rx1, const float* rx2, size_t samples, float* dst)
+        {
+            size_t j = 0;
+            for (; j + 2 <= samples; j += 2)
+            {
+                __m128 a = _mm_loadu_ps(rx1 + 2 * j);
+                __m128 b = _mm_loadu_ps(rx2 + 2 * j);
+                _mm_storeu_ps(dst + 4 * j, _mm_movelh_ps(a, b));
+                _mm_storeu_ps(dst + 4 * j + 4, _mm_movehl_ps(b, a));
+            }
+            return j;
+        }
+
+        size_t interleavePlanarSse2(const float* i1, const float* q1, const float* i2, const float* q2, size_t samples, float* dst)
+        {
+            size_t j = 0;
+            for (; j + 4 <= samples; j += 4)
+            {
+                __m128 r0 = _mm_loadu_ps(i1 + j);
+                __m128 r1 = _mm_loadu_ps(q1 + j);
+                __m128 r2 = _mm_loadu_ps(i2 + j);
+                __m128 r3 = _mm_loadu_ps(q2 + j);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(dst + 4 * j, r0);
+                _mm_storeu_ps(dst + 4 * j + 4, r1);
+                _mm_storeu_ps(dst + 4 * j + 8, r2);
+                _mm_storeu_ps(dst + 4 * j + 12, r3);
+            }
+            return j;
+        }
+
+#endif
+
+#if defined(WRAPPER_SIMD_AVX2)
+
+        WRAPPER_TARGET_AVX2 size_t deinterleaveAvx2(const float* src, size_t samples, float* rx1, float* rx2)
+        {
+            size_t j = 0;
+            for (; j + 4 <= samples; j += 4)
+            {
+                // 64 bit lanes: a = r1[0] r2[0] r1[1] r2[1], b = r1[2] r2[2] r1[3] r2[3]
+                __m256d a = _mm256_castps_pd(_mm256_loadu_ps(src + 4 * j));
+                __m256d b = _mm256_castps_pd(_mm256_loadu_ps(src + 4 * j + 8));
+                __m256d lo = _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), 0xD8);
+                __m256d hi = _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), 0xD8);
+                _mm256_storeu_ps(rx1 + 2 * j, _mm256_castpd_ps(lo));
+                _mm256_storeu_ps(rx2 + 2 * j, _mm256_castpd_ps(hi));
+            }
+            return j;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t deinterleavePlanarAvx2(const float* src, size_t samples, float* i1, float* q1, float* i2, float* q2)
+        {
+            size_t j = 0;
+            for (; j + 8 <= samples; j += 8)
+            {
+                // Sample k in the low half and k + 4 in the high half, the
+                // in lane transpose then leaves every plane in order
+                const float* s = src + 4 * j;
+                __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(s)), _mm_loadu_ps(s + 16), 1);
+                __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(s + 4)), _mm_loadu_ps(s + 20), 1);
+                __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(s + 8)), _mm_loadu_ps(s + 24), 1);
+                __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(s + 12)), _mm_loadu_ps(s + 28), 1);
+
+                __m256 t0 = _mm256_unpacklo_ps(r0, r1);     // I1 I1 Q1 Q1
+                __m256 t1 = _mm256_unpackhi_ps(r0, r1);     // I2 I2 Q2 Q2
+                __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+                __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+                _mm256_storeu_ps(i1 + j, _mm256_shuffle_ps(t0, t2, 0x44));
+                _mm256_storeu_ps(q1 + j, _mm256_shuffle_ps(t0, t2, 0xEE));
+                _mm256_storeu_ps(i2 + j, _mm256_shuffle_ps(t1, t3, 0x44));
+                _mm256_storeu_ps(q2 + j, _mm256_shuffle_ps(t1, t3, 0xEE));
+            }
+            return j;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t interleaveAvx2(const float* rx1, const float* rx2, size_t samples, float* dst)
+        {
+            size_t j = 0;
+            for (; j + 4 <= samples; j += 4)
+            {
+                __m256d a = _mm256_castps_pd(_mm256_loadu_ps(rx1 + 2 * j));
+                __m256d b = _mm256_castps_pd(_mm256_loadu_ps(rx2 + 2 * j));
+                __m256d lo = _mm256_unpacklo_pd(a, b);      // a0 b0 | a2 b2
+                __m256d hi = _mm256_unpackhi_pd(a, b);      // a1 b1 | a3 b3
+                _mm256_storeu_ps(dst + 4 * j, _mm256_castpd_ps(_mm256_permute2f128_pd(lo, hi, 0x20)));
+                _mm256_storeu_ps(dst + 4 * j + 8, _mm256_castpd_ps(_mm256_permute2f128_pd(lo, hi, 0x31)));
+            }
+            return j;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t interleavePlanarAvx2(const float* i1, const float* q1, const float* i2, const float* q2, size_t samples, float* dst)
+        {
+            size_t j = 0;
+            for (; j + 8 <= samples; j += 8)
+            {
+                __m256 r0 = _mm256_loadu_ps(i1 + j);
+                __m256 r1 = _mm256_loadu_ps(q1 + j);
+                __m256 r2 = _mm256_loadu_ps(i2 + j);
+                __m256 r3 = _mm256_loadu_ps(q2 + j);
+
+                __m256 t0 = _mm256_unpacklo_ps(r0, r1);     // I1 Q1 I1 Q1 of samples 0 1 | 4 5
+                __m256 t1 = _mm256_unpackhi_ps(r0, r1);     // samples 2 3 | 6 7
+                __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+                __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+                __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);   // samples 0 | 4
+                __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);   // samples 1 | 5
+                __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);   // samples 2 | 6
+                __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);   // samples 3 | 7
+                _mm256_storeu_ps(dst + 4 * j, _mm256_permute2f128_ps(s0, s1, 0x20));
+                _mm256_storeu_ps(dst + 4 * j + 8, _mm256_permute2f128_ps(s2, s3, 0x20));
+                _mm256_storeu_ps(dst + 4 * j + 16, _mm256_permute2f128_ps(s0, s1, 0x31));
+                _mm256_storeu_ps(dst + 4 * j + 24, _mm256_permute2f128_ps(s2, s3, 0x31));
+            }
+            return j;
+        }
+
+#endif
+    }
+
+    void DeinterleaveRx12(const float* src, size_t samples, std::complex<float>* rx1, std::complex<float>* rx2, SimdLevel level)
+    {
+        float* out1 = reinterpret_cast<float*>(rx1);
+        float* out2 = reinterpret_cast<float*>(rx2);
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = deinterleaveAvx2(src, samples, out1, out2);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = deinterleaveSse2(src, samples, out1, out2);
+            break;
+#endif
+        default:
+            break;
+        }
+        deinterleaveScalar(src, done, samples, out1, out2);
+    }
+
+    void DeinterleaveRx12Planar(const float* src, size_t samples, float* i1, float* q1, float* i2, float* q2, SimdLevel level)
+    {
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = deinterleavePlanarAvx2(src, samples, i1, q1, i2, q2);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = deinterleavePlanarSse2(src, samples, i1, q1, i2, q2);
+            break;
+#endif
+        default:
+            break;
+        }
+        deinterleavePlanarScalar(src, done, samples, i1, q1, i2, q2);
+    }
+
+    void InterleaveRx12(const std::complex<float>* rx1, const std::complex<float>* rx2, size_t samples, float* dst, SimdLevel level)
+    {
+        const float* in1 = reinterpret_cast<const float*>(rx1);
+        const float* in2 = reinterpret_cast<const float*>(rx2);
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = interleaveAvx2(in1, in2, samples, dst);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = interleaveSse2(in1, in2, samples, dst);
+            break;
+#endif
+        default:
+            break;
+        }
+        interleaveScalar(in1, in2, done, samples, dst);
+    }
+
+    void InterleaveRx12Planar(const float* i1, const float* q1, const float* i2, const float* q2, size_t samples, float* dst, SimdLevel level)
+    {
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = interleavePlanarAvx2(i1, q1, i2, q2, samples, dst);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = interleavePlanarSse2(i1, q1, i2, q2, samples, dst);
+            break;
+#endif
+        default:
+            break;
+        }
+        interleavePlanarScalar(i1, q1, i2, q2, done, samples, dst);
+    }
+
+    size_t DeinterleaveRx12(const AARTSAAPI_Packet& packet, std::complex<float>* rx1, std::complex<float>* rx2)
+    {
+        if (packet.size != 4 || packet.num <= 0)
+            return 0;
+        size_t samples = size_t(packet.num);
+        if (packet.stride == 4)
+        {
+            DeinterleaveRx12(packet.fp32, samples, rx1, rx2);
+            return samples;
+        }
+        for (size_t j = 0; j < samples; j++)
+        {
+            const float* s = packet.fp32 + j * size_t(packet.stride);
+            rx1[j] = std::complex<float>(s[0], s[1]);
+            rx2[j] = std::complex<float>(s[2], s[3]);
+        }
+        return samples;
+    }
+
+    size_t DeinterleaveRx12Planar(const AARTSAAPI_Packet& packet, float* i1, float* q1, float* i2, float* q2)
+    {
+        if (packet.size != 4 || packet.num <= 0)
+            return 0;
+        size_t samples = size_t(packet.num);
+        if (packet.stride == 4)
+        {
+            DeinterleaveRx12Planar(packet.fp32, samples, i1, q1, i2, q2);
+            return samples;
+        }
+        for (size_t j = 0; j < samples; j++)
+        {
+            const float* s = packet.fp32 + j * size_t(packet.stride);
+            i1[j] = s[0];
+            q1[j] = s[1];
+            i2[j] = s[2];
+            q2[j] = s[3];
+        }
+        return samples;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef IQINTERLEAVE_H
+#define IQINTERLEAVE_H
+
+#include "SimdSupport.h"
+#include <aaroniartsaapi.h>
+#include <complex>
+#include <cstddef>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Conversion between the Rx12 layout, both receivers on one channel with
+    // I1 Q1 I2 Q2 per sample (fp32[4 * j + 2 * k + {0, 1}] for receiver k), and
+    // one complex buffer or a pair of I/Q planes per receiver. The reverse
+    // direction builds Rx12 payloads for transmit. Buffers need no alignment
+    // and must not overlap, level picks the kernel for comparisons.
+
+    void DeinterleaveRx12(const float* src, size_t samples, std::complex<float>* rx1, std::complex<float>* rx2,
+        SimdLevel level = DetectSimdLevel());
+    void DeinterleaveRx12Planar(const float* src, size_t samples, float* i1, float* q1, float* i2, float* q2,
+        SimdLevel level = DetectSimdLevel());
+
+    void InterleaveRx12(const std::complex<float>* rx1, const std::complex<float>* rx2, size_t samples, float* dst,
+        SimdLevel level = DetectSimdLevel());
+    void InterleaveRx12Planar(const float* i1, const float* q1, const float* i2, const float* q2, size_t samples, float* dst,
+        SimdLevel level = DetectSimdLevel());
+
+    // Whole packet, honouring packet.stride. Returns the samples written, 0 if
+    // the packet does not carry Rx12 IQ (size other than 4).
+    size_t DeinterleaveRx12(const AARTSAAPI_Packet& packet, std::complex<float>* rx1, std::complex<float>* rx2);
+    size_t DeinterleaveRx12Planar(const AARTSAAPI_Packet& packet, float* i1, float* q1, float* i2, float* q2);
+}
+
+#endif
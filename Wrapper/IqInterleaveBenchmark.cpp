@@ -0,0 +1,121 @@
+#include "BenchmarkSupport.h"
+#include "IqInterleave.h"
+#include <iomanip>
+#include <vector>
+
+// Times the Rx12 deinterleave and interleave kernels at every SIMD level the CPU
+// supports, on a buffer of a few packets that stays in cache. Every level is
+// checked against the scalar kernel first, with a length that exercises the
+// scalar tail. Runs without a device.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    typedef std::complex<float> Complex;
+
+    struct Buffers
+    {
+        std::vector<float> interleaved;
+        std::vector<Complex> rx1, rx2;
+        std::vector<float> i1, q1, i2, q2;
+
+        explicit Buffers(size_t samples)
+            : interleaved(4 * samples), rx1(samples), rx2(samples), i1(samples), q1(samples), i2(samples), q2(samples)
+        {
+        }
+    };
+
+    bool check(SimdLevel level, const std::vector<float>& src, size_t samples)
+    {
+        Buffers expected(samples), actual(samples);
+        DeinterleaveRx12(src.data(), samples, expected.rx1.data(), expected.rx2.data(), SimdLevel::Scalar);
+        DeinterleaveRx12(src.data(), samples, actual.rx1.data(), actual.rx2.data(), level);
+        DeinterleaveRx12Planar(src.data(), samples, actual.i1.data(), actual.q1.data(), actual.i2.data(), actual.q2.data(), level);
+        for (size_t j = 0; j < samples; j++)
+        {
+            if (actual.rx1[j] != Complex(src[4 * j], src[4 * j + 1]) || actual.rx2[j] != Complex(src[4 * j + 2], src[4 * j + 3])
+                || expected.rx1[j] != actual.rx1[j] || expected.rx2[j] != actual.rx2[j]
+                || actual.i1[j] != src[4 * j] || actual.q1[j] != src[4 * j + 1] || actual.i2[j] != src[4 * j + 2] || actual.q2[j] != src[4 * j + 3])
+                return false;
+        }
+
+        // Both interleave directions have to restore the source
+        InterleaveRx12(actual.rx1.data(), actual.rx2.data(), samples, actual.interleaved.data(), level);
+        if (actual.interleaved != src)
+            return false;
+        std::fill(actual.interleaved.begin(), actual.interleaved.end(), 0.0f);
+        InterleaveRx12Planar(actual.i1.data(), actual.q1.data(), actual.i2.data(), actual.q2.data(), samples, actual.interleaved.data(), level);
+        return actual.interleaved == src;
+    }
+
+    template <typename Kernel>
+    double samplesPerSecond(int iterations, size_t samples, Kernel&& kernel)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            kernel();
+        return double(iterations) * double(samples) / SecondsSince(start);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations = NumberArgument<int>(argc, argv, 1, 20000);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 4096);
+
+    std::vector<float> src(4 * samples);
+    for (size_t k = 0; k < src.size(); k++)
+        src[k] = float(k) * 0.25f - 1000.0f;
+    const size_t oddSamples = samples > 11 ? samples - 11 : samples;
+    std::vector<float> oddSrc(src.begin(), src.begin() + 4 * oddSamples);
+
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (int(DetectSimdLevel()) >= int(SimdLevel::SSE2))
+        levels.push_back(SimdLevel::SSE2);
+    if (DetectSimdLevel() == SimdLevel::AVX2)
+        levels.push_back(SimdLevel::AVX2);
+
+    for (SimdLevel level : levels)
+    {
+        if (!check(level, src, samples) || !check(level, oddSrc, oddSamples))
+        {
+            std::cerr << SimdLevelName(level) << " kernels differ from the scalar ones" << std::endl;
+            return -1;
+        }
+    }
+
+    Buffers buffers(samples);
+    std::cout << std::fixed << std::setprecision(2)
+        << samples << " samples per call, GSamples/s (one sample is I1 Q1 I2 Q2)" << std::endl
+        << "Level    Deinterleave  Planar  Interleave  Planar" << std::endl;
+    for (SimdLevel level : levels)
+    {
+        double deinterleave = samplesPerSecond(iterations, samples, [&]()
+            {
+                DeinterleaveRx12(src.data(), samples, buffers.rx1.data(), buffers.rx2.data(), level);
+                DoNotOptimize(buffers.rx1[0]);
+            });
+        double deinterleavePlanar = samplesPerSecond(iterations, samples, [&]()
+            {
+                DeinterleaveRx12Planar(src.data(), samples, buffers.i1.data(), buffers.q1.data(), buffers.i2.data(), buffers.q2.data(), level);
+                DoNotOptimize(buffers.i1[0]);
+            });
+        double interleave = samplesPerSecond(iterations, samples, [&]()
+            {
+                InterleaveRx12(buffers.rx1.data(), buffers.rx2.data(), samples, buffers.interleaved.data(), level);
+                DoNotOptimize(buffers.interleaved[0]);
+            });
+        double interleavePlanar = samplesPerSecond(iterations, samples, [&]()
+            {
+                InterleaveRx12Planar(buffers.i1.data(), buffers.q1.data(), buffers.i2.data(), buffers.q2.data(), samples, buffers.interleaved.data(), level);
+                DoNotOptimize(buffers.interleaved[0]);
+            });
+
+        std::cout << std::left << std::setw(9) << SimdLevelName(level) << std::right
+            << std::setw(12) << deinterleave / 1e9 << std::setw(8) << deinterleavePlanar / 1e9
+            << std::setw(12) << interleave / 1e9 << std::setw(8) << interleavePlanar / 1e9 << std::endl;
+    }
+
+    return 0;
+}
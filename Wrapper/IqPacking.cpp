@@ -0,0 +1,439 @@
+#include "IqPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(WRAPPER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(WRAPPER_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const float Int16Full = 32767.0f;
+        const float Int8Full = 127.0f;
+
+        float maxAbsScalar(const float* src, size_t begin, size_t end, float max)
+        {
+            for (size_t k = begin; k < end; k++)
+                max = std::max(max, std::fabs(src[k]));
+            return max;
+        }
+
+        // Rounds like the SIMD conversions, to nearest even, and saturates like
+        // their packs. Adding and subtracting 1.5 * 2^23 rounds any value below
+        // 2^22 in magnitude without the libm call of nearbyint.
+        template <typename Int>
+        void packScalar(const float* src, size_t begin, size_t end, float inverse, Int* dst)
+        {
+            const float low = float(std::numeric_limits<Int>::min()), high = float(std::numeric_limits<Int>::max());
+            const float round = 12582912.0f;
+            for (size_t k = begin; k < end; k++)
+            {
+                float v = std::min(std::max(src[k] * inverse, low), high);
+                dst[k] = Int((v + round) - round);
+            }
+        }
+
+        template <typename Int>
+        void unpackScalar(const Int* src, size_t begin, size_t end, float scale, float* dst)
+        {
+            for (size_t k = begin; k < end; k++)
+                dst[k] = float(src[k]) * scale;
+        }
+
+#if defined(WRAPPER_SIMD_SSE2)
+
+        size_t maxAbsSse2(const float* src, size_t count, float& max)
+        {
+            const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+            __m128 m0 = _mm_setzero_ps(), m1 = _mm_setzero_ps();
+            size_t k = 0;
+            for (; k + 8 <= count; k += 8)
+            {
+                m0 = _mm_max_ps(m0, _mm_and_ps(mask, _mm_loadu_ps(src + k)));
+                m1 = _mm_max_ps(m1, _mm_and_ps(mask, _mm_loadu_ps(src + k + 4)));
+            }
+            m0 = _mm_max_ps(m0, m1);
+            m0 = _mm_max_ps(m0, _mm_movehl_ps(m0, m0));
+            m0 = _mm_max_ss(m0, _mm_shuffle_ps(m0, m0, 1));
+            max = _mm_cvtss_f32(m0);
+            return k;
+        }
+
+        size_t packInt16Sse2(const float* src, size_t count, float inverse, int16_t* dst)
+        {
+            const __m128 f = _mm_set1_ps(inverse);
+            size_t k = 0;
+            for (; k + 8 <= count; k += 8)
+            {
+                __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + k), f));
+                __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + k + 4), f));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), _mm_packs_epi32(a, b));
+            }
+            return k;
+        }
+
+        size_t packInt8Sse2(const float* src, size_t count, float inverse, int8_t* dst)
+        {
+            const __m128 f = _mm_set1_ps(inverse);
+            size_t k = 0;
+            for (; k + 16 <= count; k += 16)
+            {
+                __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + k), f));
+                __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + k + 4), f));
+                __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + k + 8), f));
+                __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + k + 12), f));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+            }
+            return k;
+        }
+
+        size_t unpackInt16Sse2(const int16_t* src, size_t count, float scale, float* dst)
+        {
+            const __m128 f = _mm_set1_ps(scale);
+            size_t k = 0;
+            for (; k + 8 <= count; k += 8)
+            {
+                // Each value into the upper half of a 32 bit lane, shifted down with its sign
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k));
+                __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+                __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+                _mm_storeu_ps(dst + k, _mm_mul_ps(_mm_cvtepi32_ps(lo), f));
+                _mm_storeu_ps(dst + k + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), f));
+            }
+            return k;
+        }
+
+        size_t unpackInt8Sse2(const int8_t* src, size_t count, float scale, float* dst)
+        {
+            const __m128 f = _mm_set1_ps(scale);
+            size_t k = 0;
+            for (; k + 16 <= count; k += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k));
+                __m128i lo = _mm_unpacklo_epi8(v, v);
+                __m128i hi = _mm_unpackhi_epi8(v, v);
+                __m128i d0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24);
+                __m128i d1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24);
+                __m128i d2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24);
+                __m128i d3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24);
+                _mm_storeu_ps(dst + k, _mm_mul_ps(_mm_cvtepi32_ps(d0), f));
+                _mm_storeu_ps(dst + k + 4, _mm_mul_ps(_mm_cvtepi32_ps(d1), f));
+                _mm_storeu_ps(dst + k + 8, _mm_mul_ps(_mm_cvtepi32_ps(d2), f));
+                _mm_storeu_ps(dst + k + 12, _mm_mul_ps(_mm_cvtepi32_ps(d3), f));
+            }
+            return k;
+        }
+
+#endif
+
+#if defined(WRAPPER_SIMD_AVX2)
+
+        WRAPPER_TARGET_AVX2 size_t maxAbsAvx2(const float* src, size_t count, float& max)
+        {
+            const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            __m256 m0 = _mm256_setzero_ps(), m1 = _mm256_setzero_ps();
+            size_t k = 0;
+            for (; k + 16 <= count; k += 16)
+            {
+                m0 = _mm256_max_ps(m0, _mm256_and_ps(mask, _mm256_loadu_ps(src + k)));
+                m1 = _mm256_max_ps(m1, _mm256_and_ps(mask, _mm256_loadu_ps(src + k + 8)));
+            }
+            m0 = _mm256_max_ps(m0, m1);
+            __m128 m = _mm_max_ps(_mm256_castps256_ps128(m0), _mm256_extractf128_ps(m0, 1));
+            m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+            m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+            max = _mm_cvtss_f32(m);
+            return k;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t packInt16Avx2(const float* src, size_t count, float inverse, int16_t* dst)
+        {
+            const __m256 f = _mm256_set1_ps(inverse);
+            size_t k = 0;
+            for (; k + 16 <= count; k += 16)
+            {
+                __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + k), f));
+                __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + k + 8), f));
+                // The pack works per 128 bit lane: a0-3 b0-3 | a4-7 b4-7
+                __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), p);
+            }
+            return k;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t packInt8Avx2(const float* src, size_t count, float inverse, int8_t* dst)
+        {
+            const __m256 f = _mm256_set1_ps(inverse);
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            size_t k = 0;
+            for (; k + 32 <= count; k += 32)
+            {
+                __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + k), f));
+                __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + k + 8), f));
+                __m256i c = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + k + 16), f));
+                __m256i d = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + k + 24), f));
+                // 32 bit groups of four values come out as a0 b0 c0 d0 | a1 b1 c1 d1
+                __m256i p = _mm256_packs_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), _mm256_permutevar8x32_epi32(p, order));
+            }
+            return k;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t unpackInt16Avx2(const int16_t* src, size_t count, float scale, float* dst)
+        {
+            const __m256 f = _mm256_set1_ps(scale);
+            size_t k = 0;
+            for (; k + 16 <= count; k += 16)
+            {
+                __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k)));
+                __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k + 8)));
+                _mm256_storeu_ps(dst + k, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), f));
+                _mm256_storeu_ps(dst + k + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), f));
+            }
+            return k;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t unpackInt8Avx2(const int8_t* src, size_t count, float scale, float* dst)
+        {
+            const __m256 f = _mm256_set1_ps(scale);
+            size_t k = 0;
+            for (; k + 16 <= count; k += 16)
+            {
+                __m256i lo = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + k)));
+                __m256i hi = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + k + 8)));
+                _mm256_storeu_ps(dst + k, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), f));
+                _mm256_storeu_ps(dst + k + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), f));
+            }
+            return k;
+        }
+
+#endif
+
+        float maxAbs(const float* src, size_t count, SimdLevel level)
+        {
+            float max = 0;
+            size_t done = 0;
+            switch (level)
+            {
+#if defined(WRAPPER_SIMD_AVX2)
+            case SimdLevel::AVX2:
+                done = maxAbsAvx2(src, count, max);
+                break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            case SimdLevel::SSE2:
+                done = maxAbsSse2(src, count, max);
+                break;
+#endif
+            default:
+                break;
+            }
+            return maxAbsScalar(src, done, count, max);
+        }
+
+        void packBlock(const float* src, size_t count, float inverse, int16_t* dst, SimdLevel level)
+        {
+            size_t done = 0;
+            switch (level)
+            {
+#if defined(WRAPPER_SIMD_AVX2)
+            case SimdLevel::AVX2:
+                done = packInt16Avx2(src, count, inverse, dst);
+                break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            case SimdLevel::SSE2:
+                done = packInt16Sse2(src, count, inverse, dst);
+                break;
+#endif
+            default:
+                break;
+            }
+            packScalar(src, done, count, inverse, dst);
+        }
+
+        void packBlock(const float* src, size_t count, float inverse, int8_t* dst, SimdLevel level)
+        {
+            size_t done = 0;
+            switch (level)
+            {
+#if defined(WRAPPER_SIMD_AVX2)
+            case SimdLevel::AVX2:
+                done = packInt8Avx2(src, count, inverse, dst);
+                break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            case SimdLevel::SSE2:
+                done = packInt8Sse2(src, count, inverse, dst);
+                break;
+#endif
+            default:
+                break;
+            }
+            packScalar(src, done, count, inverse, dst);
+        }
+
+        void unpackBlock(const int16_t* src, size_t count, float scale, float* dst, SimdLevel level)
+        {
+            size_t done = 0;
+            switch (level)
+            {
+#if defined(WRAPPER_SIMD_AVX2)
+            case SimdLevel::AVX2:
+                done = unpackInt16Avx2(src, count, scale, dst);
+                break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            case SimdLevel::SSE2:
+                done = unpackInt16Sse2(src, count, scale, dst);
+                break;
+#endif
+            default:
+                break;
+            }
+            unpackScalar(src, done, count, scale, dst);
+        }
+
+        void unpackBlock(const int8_t* src, size_t count, float scale, float* dst, SimdLevel level)
+        {
+            size_t done = 0;
+            switch (level)
+            {
+#if defined(WRAPPER_SIMD_AVX2)
+            case SimdLevel::AVX2:
+                done = unpackInt8Avx2(src, count, scale, dst);
+                break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            case SimdLevel::SSE2:
+                done = unpackInt8Sse2(src, count, scale, dst);
+                break;
+#endif
+            default:
+                break;
+            }
+            unpackScalar(src, done, count, scale, dst);
+        }
+
+        template <typename Int>
+        void pack(const float* src, size_t count, size_t blockFloats, Int* dst, float* scales, float full, SimdLevel level)
+        {
+            level = ClampSimdLevel(level);
+            blockFloats = std::max<size_t>(1, blockFloats);
+            for (size_t begin = 0; begin < count; begin += blockFloats)
+            {
+                size_t n = std::min(blockFloats, count - begin);
+                float max = maxAbs(src + begin, n, level);
+                // An all zero block keeps scale 0 and packs to zeros. So does one
+                // whose peak is too small for a finite inverse, zeros times an
+                // infinite inverse would give NaN.
+                bool zero = !(max >= full / std::numeric_limits<float>::max());
+                float scale = zero ? 0.0f : max / full, inverse = zero ? 0.0f : full / max;
+                *scales++ = scale;
+                packBlock(src + begin, n, inverse, dst + begin, level);
+            }
+        }
+
+        template <typename Int>
+        void unpack(const Int* src, const float* scales, size_t count, size_t blockFloats, float* dst, SimdLevel level)
+        {
+            level = ClampSimdLevel(level);
+            blockFloats = std::max<size_t>(1, blockFloats);
+            for (size_t begin = 0; begin < count; begin += blockFloats)
+                unpackBlock(src + begin, std::min(blockFloats, count - begin), *scales++, dst + begin, level);
+        }
+    }
+
+    void PackIqInt16(const float* src, size_t count, size_t blockFloats, int16_t* dst, float* scales, SimdLevel level)
+    {
+        pack(src, count, blockFloats, dst, scales, Int16Full, level);
+    }
+
+    void PackIqInt8(const float* src, size_t count, size_t blockFloats, int8_t* dst, float* scales, SimdLevel level)
+    {
+        pack(src, count, blockFloats, dst, scales, Int8Full, level);
+    }
+
+    void UnpackIqInt16(const int16_t* src, const float* scales, size_t count, size_t blockFloats, float* dst, SimdLevel level)
+    {
+        unpack(src, scales, count, blockFloats, dst, level);
+    }
+
+    void UnpackIqInt8(const int8_t* src, const float* scales, size_t count, size_t blockFloats, float* dst, SimdLevel level)
+    {
+        unpack(src, scales, count, blockFloats, dst, level);
+    }
+
+    void PackIqPacket(const AARTSAAPI_Packet& packet, PackedIqFormat format, PackedIqPacket& packed, size_t blockFloats, SimdLevel level)
+    {
+        blockFloats = std::max<size_t>(1, blockFloats);
+        packed.header = packet;
+        packed.header.fp32 = nullptr;
+        packed.format = format;
+        packed.blockFloats = uint32_t(blockFloats);
+        packed.scales.clear();
+        packed.values.clear();
+        if (packet.num <= 0 || packet.size <= 0 || !packet.fp32)
+        {
+            packed.header.num = 0;
+            return;
+        }
+        packed.header.stride = packet.size;
+
+        // Stride padding is dropped, which needs a compact copy first
+        const size_t count = size_t(packet.num * packet.size);
+        std::vector<float> compact;
+        const float* src = packet.fp32;
+        if (packet.stride != packet.size)
+        {
+            compact.resize(count);
+            for (int64_t j = 0; j < packet.num; j++)
+                std::memcpy(&compact[size_t(j * packet.size)], packet.fp32 + j * packet.stride, size_t(packet.size) * sizeof(float));
+            src = compact.data();
+        }
+
+        packed.values.resize(count * PackedIqValueBytes(format));
+        switch (format)
+        {
+        case PackedIqFormat::Int16:
+            packed.scales.resize((count + blockFloats - 1) / blockFloats);
+            PackIqInt16(src, count, blockFloats, reinterpret_cast<int16_t*>(packed.values.data()), packed.scales.data(), level);
+            break;
+        case PackedIqFormat::Int8:
+            packed.scales.resize((count + blockFloats - 1) / blockFloats);
+            PackIqInt8(src, count, blockFloats, reinterpret_cast<int8_t*>(packed.values.data()), packed.scales.data(), level);
+            break;
+        default:
+            std::memcpy(packed.values.data(), src, count * sizeof(float));
+            break;
+        }
+    }
+
+    void UnpackIqPacket(const PackedIqPacket& packed, std::vector<float>& payload, AARTSAAPI_Packet& packet, SimdLevel level)
+    {
+        packet = packed.header;
+        size_t count = packed.values.size() / PackedIqValueBytes(packed.format);
+        payload.resize(count);
+        switch (packed.format)
+        {
+        case PackedIqFormat::Int16:
+            UnpackIqInt16(reinterpret_cast<const int16_t*>(packed.values.data()), packed.scales.data(), count, packed.blockFloats, payload.data(), level);
+            break;
+        case PackedIqFormat::Int8:
+            UnpackIqInt8(reinterpret_cast<const int8_t*>(packed.values.data()), packed.scales.data(), count, packed.blockFloats, payload.data(), level);
+            break;
+        default:
+            if (count)
+                std::memcpy(payload.data(), packed.values.data(), count * sizeof(float));
+            break;
+        }
+        packet.fp32 = count ? payload.data() : nullptr;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef IQPACKING_H
+#define IQPACKING_H
+
+#include "SimdSupport.h"
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    enum class PackedIqFormat : uint32_t
+    {
+        Float32,        // not packed
+        Int16,
+        Int8
+    };
+
+    inline size_t PackedIqValueBytes(PackedIqFormat format)
+    {
+        return format == PackedIqFormat::Int16 ? 2 : format == PackedIqFormat::Int8 ? 1 : 4;
+    }
+
+    // Floats sharing one scale by default, 128 IQ samples. Smaller blocks follow
+    // the signal level more closely at the cost of one float per block.
+    const size_t DefaultPackedIqBlockFloats = 256;
+
+    // Block scaled integer IQ: every block of blockFloats values is stored as
+    // integers times one float scale, chosen so the largest magnitude in the
+    // block maps to the full range (32767 or 127). Values round to nearest and
+    // the range is symmetric, so packing never saturates. Input must be finite;
+    // blocks with a peak below about 1e-34 pack as zeros with scale 0.
+    // scales gets one entry per started block. level picks the kernel for
+    // comparisons, every level gives the same result.
+
+    void PackIqInt16(const float* src, size_t count, size_t blockFloats, int16_t* dst, float* scales,
+        SimdLevel level = DetectSimdLevel());
+    void PackIqInt8(const float* src, size_t count, size_t blockFloats, int8_t* dst, float* scales,
+        SimdLevel level = DetectSimdLevel());
+
+    void UnpackIqInt16(const int16_t* src, const float* scales, size_t count, size_t blockFloats, float* dst,
+        SimdLevel level = DetectSimdLevel());
+    void UnpackIqInt8(const int8_t* src, const float* scales, size_t count, size_t blockFloats, float* dst,
+        SimdLevel level = DetectSimdLevel());
+
+    // Payload of one packet in a packed format, for disk or the wire. The header
+    // keeps everything but fp32; samples are stored without stride padding, so
+    // unpacking gives stride == size.
+    struct PackedIqPacket
+    {
+        AARTSAAPI_Packet header;
+        PackedIqFormat format;
+        uint32_t blockFloats;
+        std::vector<float> scales;
+        std::vector<uint8_t> values;    // num * size values of PackedIqValueBytes each
+
+        size_t bytes() const { return scales.size() * sizeof(float) + values.size(); }
+    };
+
+    // Packs the payload of the receive path, e.g. RawIQ or IQReceiver packets
+    void PackIqPacket(const AARTSAAPI_Packet& packet, PackedIqFormat format, PackedIqPacket& packed,
+        size_t blockFloats = DefaultPackedIqBlockFloats, SimdLevel level = DetectSimdLevel());
+
+    // Restores a float packet, e.g. for SendPacket on the transmit path; its fp32
+    // points into payload
+    void UnpackIqPacket(const PackedIqPacket& packed, std::vector<float>& payload, AARTSAAPI_Packet& packet,
+        SimdLevel level = DetectSimdLevel());
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "BenchmarkSupport.h"
+#include "IqPacking.h"
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// Times packing IQ floats to block scaled int16 and int8 and unpacking them at
+// every SIMD level the CPU supports, on a buffer of a few packets that stays in
+// cache, after checking every level against the scalar kernels. Then measures
+// the quantization noise on a tone with noise 60 dB below it whose level drops
+// by 40 dB halfway, like the end of a burst, for several block sizes: the
+// signal to quantization noise ratio and what the quantization costs the 60 dB
+// input SNR, on the loud and on the quiet half. Runs without a device; takes
+// the iteration count and the IQ samples per call.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const double InputSnrDb = 60.0;
+
+    struct Signal
+    {
+        std::vector<float> iq;
+        double signalPower[2];  // summed over the loud and the quiet half
+        double noisePower[2];   // of the added noise
+    };
+
+    // Tone at full scale for the first half, 40 dB down for the second
+    Signal makeSignal(size_t samples)
+    {
+        Signal signal;
+        signal.iq.resize(2 * samples);
+        std::mt19937 random(7);
+        std::normal_distribution<double> noise(0.0, 1.0);
+
+        signal.signalPower[0] = signal.signalPower[1] = signal.noisePower[0] = signal.noisePower[1] = 0;
+        for (size_t j = 0; j < samples; j++)
+        {
+            size_t half = j < samples / 2 ? 0 : 1;
+            double amplitude = half == 0 ? 0.5 : 0.005;
+            double sigma = amplitude * std::pow(10.0, -InputSnrDb / 20.0) / std::sqrt(2.0);
+            double phase = 0.0123 * double(j);
+            double ni = sigma * noise(random), nq = sigma * noise(random);
+            signal.iq[2 * j] = float(amplitude * std::cos(phase) + ni);
+            signal.iq[2 * j + 1] = float(amplitude * std::sin(phase) + nq);
+            signal.signalPower[half] += double(signal.iq[2 * j]) * signal.iq[2 * j] + double(signal.iq[2 * j + 1]) * signal.iq[2 * j + 1];
+            signal.noisePower[half] += ni * ni + nq * nq;
+        }
+        return signal;
+    }
+
+    bool check(SimdLevel level, const std::vector<float>& src)
+    {
+        const size_t count = src.size(), block = 100;     // blocks with a scalar tail each
+        const size_t blocks = (count + block - 1) / block;
+        std::vector<int16_t> wide(count), wideRef(count);
+        std::vector<int8_t> narrow(count), narrowRef(count);
+        std::vector<float> scales(blocks), scalesRef(blocks), out(count), outRef(count);
+
+        PackIqInt16(src.data(), count, block, wideRef.data(), scalesRef.data(), SimdLevel::Scalar);
+        PackIqInt16(src.data(), count, block, wide.data(), scales.data(), level);
+        if (wide != wideRef || scales != scalesRef)
+            return false;
+        UnpackIqInt16(wideRef.data(), scalesRef.data(), count, block, outRef.data(), SimdLevel::Scalar);
+        UnpackIqInt16(wideRef.data(), scalesRef.data(), count, block, out.data(), level);
+        if (out != outRef)
+            return false;
+
+        PackIqInt8(src.data(), count, block, narrowRef.data(), scalesRef.data(), SimdLevel::Scalar);
+        PackIqInt8(src.data(), count, block, narrow.data(), scales.data(), level);
+        if (narrow != narrowRef || scales != scalesRef)
+            return false;
+        UnpackIqInt8(narrowRef.data(), scalesRef.data(), count, block, outRef.data(), SimdLevel::Scalar);
+        UnpackIqInt8(narrowRef.data(), scalesRef.data(), count, block, out.data(), level);
+        return out == outRef;
+    }
+
+    template <typename Kernel>
+    double samplesPerSecond(int iterations, size_t samples, Kernel&& kernel)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            kernel();
+        return double(iterations) * double(samples) / SecondsSince(start);
+    }
+
+    // Quantization noise power of a pack and unpack round trip on both halves
+    void quantizationNoise(const std::vector<float>& src, PackedIqFormat format, size_t block, double noise[2])
+    {
+        const size_t count = src.size();
+        std::vector<float> scales((count + block - 1) / block), out(count);
+        if (format == PackedIqFormat::Int16)
+        {
+            std::vector<int16_t> packed(count);
+            PackIqInt16(src.data(), count, block, packed.data(), scales.data());
+            UnpackIqInt16(packed.data(), scales.data(), count, block, out.data());
+        }
+        else
+        {
+            std::vector<int8_t> packed(count);
+            PackIqInt8(src.data(), count, block, packed.data(), scales.data());
+            UnpackIqInt8(packed.data(), scales.data(), count, block, out.data());
+        }
+
+        noise[0] = noise[1] = 0;
+        for (size_t k = 0; k < count; k++)
+            noise[k < count / 2 ? 0 : 1] += (double(out[k]) - double(src[k])) * (double(out[k]) - double(src[k]));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations = NumberArgument<int>(argc, argv, 1, 20000);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 4096);
+    const size_t count = 2 * samples, block = DefaultPackedIqBlockFloats;
+
+    Signal signal = makeSignal(samples);
+    const std::vector<float>& src = signal.iq;
+    std::vector<int16_t> wide(count);
+    std::vector<int8_t> narrow(count);
+    std::vector<float> scales((count + block - 1) / block), out(count);
+
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (int(DetectSimdLevel()) >= int(SimdLevel::SSE2))
+        levels.push_back(SimdLevel::SSE2);
+    if (DetectSimdLevel() == SimdLevel::AVX2)
+        levels.push_back(SimdLevel::AVX2);
+
+    std::cout << "Throughput     : " << samples << " IQ samples per call, " << block << " floats per scale" << std::endl
+        << "GSamples/s      pack int16  unpack int16  pack int8  unpack int8" << std::endl;
+    for (SimdLevel level : levels)
+    {
+        if (!check(level, src))
+        {
+            std::cerr << SimdLevelName(level) << " kernels differ from the scalar ones" << std::endl;
+            return -1;
+        }
+
+        double pack16 = samplesPerSecond(iterations, samples, [&]() { PackIqInt16(src.data(), count, block, wide.data(), scales.data(), level); DoNotOptimize(wide[0]); });
+        double unpack16 = samplesPerSecond(iterations, samples, [&]() { UnpackIqInt16(wide.data(), scales.data(), count, block, out.data(), level); DoNotOptimize(out[0]); });
+        double pack8 = samplesPerSecond(iterations, samples, [&]() { PackIqInt8(src.data(), count, block, narrow.data(), scales.data(), level); DoNotOptimize(narrow[0]); });
+        double unpack8 = samplesPerSecond(iterations, samples, [&]() { UnpackIqInt8(narrow.data(), scales.data(), count, block, out.data(), level); DoNotOptimize(out[0]); });
+        std::cout << std::left << std::setw(15) << SimdLevelName(level) << std::right << std::fixed << std::setprecision(2)
+            << std::setw(12) << pack16 / 1e9 << std::setw(14) << unpack16 / 1e9 << std::setw(11) << pack8 / 1e9 << std::setw(13) << unpack8 / 1e9 << std::endl;
+    }
+
+    // One scale for the whole buffer shows what the per block scale buys on the quiet half
+    std::cout << std::endl << "Quantization   : tone with " << std::setprecision(0) << InputSnrDb << " dB SNR, 40 dB quieter in the second half" << std::endl
+        << "                      SQNR loud/quiet   SNR lost loud/quiet (dB)" << std::endl;
+    for (PackedIqFormat format : { PackedIqFormat::Int16, PackedIqFormat::Int8 })
+    {
+        for (size_t size : { size_t(32), size_t(256), size_t(4096), count })
+        {
+            double noise[2];
+            quantizationNoise(src, format, size, noise);
+            std::cout << (format == PackedIqFormat::Int16 ? "int16" : "int8 ") << std::setw(7) << size << " floats" << std::setprecision(1);
+            for (size_t half = 0; half < 2; half++)
+                std::cout << std::setw(9) << 10 * std::log10(signal.signalPower[half] / noise[half]);
+            for (size_t half = 0; half < 2; half++)
+                std::cout << std::setw(11) << 10 * std::log10(1 + noise[half] / signal.noisePower[half]);
+            std::cout << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,283 @@
+#include "IqPower.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(WRAPPER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(WRAPPER_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Lowest floor, powers stay normal floats above it
+        const float MinFloorDb = -370.0f;
+
+        const float DbPerLog2 = 3.01029995663981f;      // 10 * log10(2)
+        const float Sqrt2 = 1.41421356237310f;
+
+        // log2(m) = 2 / ln 2 * (t + t^3 / 3 + t^5 / 5 + t^7 / 7 + ...) with
+        // t = (m - 1) / (m + 1). With m in [sqrt(1/2), sqrt(2)], |t| <= 0.172 and
+        // the first left out term is below 5e-8.
+        const float C1 = 2.88539008177793f;
+        const float C3 = 0.961796693925976f;
+        const float C5 = 0.577078016355585f;
+        const float C7 = 0.412198583111132f;
+
+        float floorPowerOf(float floorDb)
+        {
+            return float(std::pow(10.0, double(floorDb) / 10.0));
+        }
+
+        // The SIMD kernels do the same operations in the same order
+        float dbOfScalar(float p, float floorPower, float floorDb)
+        {
+            p = p > floorPower ? p : floorPower;        // NaN fails the comparison
+
+            uint32_t bits;
+            std::memcpy(&bits, &p, sizeof(bits));
+            float e = float(int32_t(bits >> 23) - 127);
+            bits = (bits & 0x007FFFFF) | 0x3F800000;
+            float m;
+            std::memcpy(&m, &bits, sizeof(m));
+            if (m > Sqrt2)
+            {
+                m = m * 0.5f;
+                e = e + 1.0f;
+            }
+
+            float t = (m - 1.0f) / (m + 1.0f);
+            float t2 = t * t;
+            float log2 = e + t * (C1 + t2 * (C3 + t2 * (C5 + t2 * C7)));
+            float db = DbPerLog2 * log2;
+            return db > floorDb ? db : floorDb;
+        }
+
+        float powerDbScalar(float i, float q, float floorPower, float floorDb)
+        {
+            return dbOfScalar(i * i + q * q, floorPower, floorDb);
+        }
+
+#if defined(WRAPPER_SIMD_SSE2)
+
+        size_t powerSse2(const float* iq, size_t samples, float* power)
+        {
+            size_t j = 0;
+            for (; j + 4 <= samples; j += 4)
+            {
+                __m128 a = _mm_loadu_ps(iq + 2 * j);
+                __m128 b = _mm_loadu_ps(iq + 2 * j + 4);
+                a = _mm_mul_ps(a, a);
+                b = _mm_mul_ps(b, b);
+                _mm_storeu_ps(power + j, _mm_add_ps(_mm_shuffle_ps(a, b, 0x88), _mm_shuffle_ps(a, b, 0xDD)));
+            }
+            return j;
+        }
+
+        // 10 * log10(max(p, floorPower)), clamped to floorDb
+        inline __m128 dbOfSse2(__m128 p, float floorPower, float floorDb)
+        {
+            const __m128i mantissa = _mm_set1_epi32(0x007FFFFF), one = _mm_set1_epi32(0x3F800000), bias = _mm_set1_epi32(127);
+            const __m128 onef = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f), sqrt2 = _mm_set1_ps(Sqrt2);
+            p = _mm_max_ps(p, _mm_set1_ps(floorPower));     // returns floorPower for NaN
+
+            __m128i bits = _mm_castps_si128(p);
+            __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), bias));
+            __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantissa), one));
+            __m128 above = _mm_cmpgt_ps(m, sqrt2);
+            m = _mm_mul_ps(m, _mm_or_ps(_mm_and_ps(above, half), _mm_andnot_ps(above, onef)));
+            e = _mm_add_ps(e, _mm_and_ps(above, onef));
+
+            __m128 t = _mm_div_ps(_mm_sub_ps(m, onef), _mm_add_ps(m, onef));
+            __m128 t2 = _mm_mul_ps(t, t);
+            __m128 s = _mm_add_ps(_mm_set1_ps(C5), _mm_mul_ps(t2, _mm_set1_ps(C7)));
+            s = _mm_add_ps(_mm_set1_ps(C3), _mm_mul_ps(t2, s));
+            s = _mm_add_ps(_mm_set1_ps(C1), _mm_mul_ps(t2, s));
+            __m128 log2 = _mm_add_ps(e, _mm_mul_ps(t, s));
+            return _mm_max_ps(_mm_mul_ps(_mm_set1_ps(DbPerLog2), log2), _mm_set1_ps(floorDb));
+        }
+
+        size_t powerDbSse2(const float* iq, size_t samples, float* db, float floorPower, float floorDb)
+        {
+            size_t j = 0;
+            for (; j + 4 <= samples; j += 4)
+            {
+                __m128 a = _mm_loadu_ps(iq + 2 * j);
+                __m128 b = _mm_loadu_ps(iq + 2 * j + 4);
+                a = _mm_mul_ps(a, a);
+                b = _mm_mul_ps(b, b);
+                __m128 p = _mm_add_ps(_mm_shuffle_ps(a, b, 0x88), _mm_shuffle_ps(a, b, 0xDD));
+                _mm_storeu_ps(db + j, dbOfSse2(p, floorPower, floorDb));
+            }
+            return j;
+        }
+
+        size_t powerToDbSse2(const float* power, size_t count, float* db, float floorPower, float floorDb)
+        {
+            size_t j = 0;
+            for (; j + 4 <= count; j += 4)
+                _mm_storeu_ps(db + j, dbOfSse2(_mm_loadu_ps(power + j), floorPower, floorDb));
+            return j;
+        }
+
+#endif
+
+#if defined(WRAPPER_SIMD_AVX2)
+
+        // Squares of samples 0-3 in a and 4-7 in b; the in lane shuffles leave
+        // the sums in the 64 bit order 0 1 | 4 5 | 2 3 | 6 7
+        WRAPPER_TARGET_AVX2 inline __m256 powerOf(const float* iq)
+        {
+            __m256 a = _mm256_loadu_ps(iq);
+            __m256 b = _mm256_loadu_ps(iq + 8);
+            a = _mm256_mul_ps(a, a);
+            b = _mm256_mul_ps(b, b);
+            __m256 p = _mm256_add_ps(_mm256_shuffle_ps(a, b, 0x88), _mm256_shuffle_ps(a, b, 0xDD));
+            return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p), 0xD8));
+        }
+
+        WRAPPER_TARGET_AVX2 size_t powerAvx2(const float* iq, size_t samples, float* power)
+        {
+            size_t j = 0;
+            for (; j + 8 <= samples; j += 8)
+                _mm256_storeu_ps(power + j, powerOf(iq + 2 * j));
+            return j;
+        }
+
+        WRAPPER_TARGET_AVX2 inline __m256 dbOfAvx2(__m256 p, float floorPower, float floorDb)
+        {
+            const __m256i mantissa = _mm256_set1_epi32(0x007FFFFF), one = _mm256_set1_epi32(0x3F800000), bias = _mm256_set1_epi32(127);
+            const __m256 onef = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f), sqrt2 = _mm256_set1_ps(Sqrt2);
+            p = _mm256_max_ps(p, _mm256_set1_ps(floorPower));
+
+            __m256i bits = _mm256_castps_si256(p);
+            __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), bias));
+            __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantissa), one));
+            __m256 above = _mm256_cmp_ps(m, sqrt2, _CMP_GT_OQ);
+            m = _mm256_mul_ps(m, _mm256_blendv_ps(onef, half, above));
+            e = _mm256_add_ps(e, _mm256_and_ps(above, onef));
+
+            __m256 t = _mm256_div_ps(_mm256_sub_ps(m, onef), _mm256_add_ps(m, onef));
+            __m256 t2 = _mm256_mul_ps(t, t);
+            __m256 s = _mm256_add_ps(_mm256_set1_ps(C5), _mm256_mul_ps(t2, _mm256_set1_ps(C7)));
+            s = _mm256_add_ps(_mm256_set1_ps(C3), _mm256_mul_ps(t2, s));
+            s = _mm256_add_ps(_mm256_set1_ps(C1), _mm256_mul_ps(t2, s));
+            __m256 log2 = _mm256_add_ps(e, _mm256_mul_ps(t, s));
+            return _mm256_max_ps(_mm256_mul_ps(_mm256_set1_ps(DbPerLog2), log2), _mm256_set1_ps(floorDb));
+        }
+
+        WRAPPER_TARGET_AVX2 size_t powerDbAvx2(const float* iq, size_t samples, float* db, float floorPower, float floorDb)
+        {
+            size_t j = 0;
+            for (; j + 8 <= samples; j += 8)
+                _mm256_storeu_ps(db + j, dbOfAvx2(powerOf(iq + 2 * j), floorPower, floorDb));
+            return j;
+        }
+
+        WRAPPER_TARGET_AVX2 size_t powerToDbAvx2(const float* power, size_t count, float* db, float floorPower, float floorDb)
+        {
+            size_t j = 0;
+            for (; j + 8 <= count; j += 8)
+                _mm256_storeu_ps(db + j, dbOfAvx2(_mm256_loadu_ps(power + j), floorPower, floorDb));
+            return j;
+        }
+
+#endif
+    }
+
+    void PowerIq(const float* iq, size_t samples, float* power, SimdLevel level)
+    {
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = powerAvx2(iq, samples, power);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = powerSse2(iq, samples, power);
+            break;
+#endif
+        default:
+            break;
+        }
+        for (size_t j = done; j < samples; j++)
+            power[j] = iq[2 * j] * iq[2 * j] + iq[2 * j + 1] * iq[2 * j + 1];
+    }
+
+    void PowerDbIq(const float* iq, size_t samples, float* db, float floorDb, SimdLevel level)
+    {
+        floorDb = std::max(floorDb, MinFloorDb);
+        const float floorPower = floorPowerOf(floorDb);
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = powerDbAvx2(iq, samples, db, floorPower, floorDb);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = powerDbSse2(iq, samples, db, floorPower, floorDb);
+            break;
+#endif
+        default:
+            break;
+        }
+        for (size_t j = done; j < samples; j++)
+            db[j] = powerDbScalar(iq[2 * j], iq[2 * j + 1], floorPower, floorDb);
+    }
+
+    void PowerToDb(const float* power, size_t count, float* db, float floorDb, SimdLevel level)
+    {
+        floorDb = std::max(floorDb, MinFloorDb);
+        const float floorPower = floorPowerOf(floorDb);
+        size_t done = 0;
+        switch (ClampSimdLevel(level))
+        {
+#if defined(WRAPPER_SIMD_AVX2)
+        case SimdLevel::AVX2:
+            done = powerToDbAvx2(power, count, db, floorPower, floorDb);
+            break;
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+        case SimdLevel::SSE2:
+            done = powerToDbSse2(power, count, db, floorPower, floorDb);
+            break;
+#endif
+        default:
+            break;
+        }
+        for (size_t j = done; j < count; j++)
+            db[j] = dbOfScalar(power[j], floorPower, floorDb);
+    }
+
+    size_t PowerDbIq(const AARTSAAPI_Packet& packet, float* db, float floorDb)
+    {
+        if (packet.size < 2 || packet.num <= 0)
+            return 0;
+        size_t samples = size_t(packet.num);
+        if (packet.stride == 2)
+        {
+            PowerDbIq(packet.fp32, samples, db, floorDb);
+            return samples;
+        }
+
+        floorDb = std::max(floorDb, MinFloorDb);
+        const float floorPower = floorPowerOf(floorDb);
+        for (size_t j = 0; j < samples; j++)
+        {
+            const float* s = packet.fp32 + j * size_t(packet.stride);
+            db[j] = powerDbScalar(s[0], s[1], floorPower, floorDb);
+        }
+        return samples;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef IQPOWER_H
+#define IQPOWER_H
+
+#include "SimdSupport.h"
+#include <aaroniartsaapi.h>
+#include <cstddef>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Power floor of PowerDbIq, the dB value of zero input
+    const float DefaultPowerFloorDb = -200.0f;
+
+    // Largest difference of PowerDbIq from 10 * log10(I * I + Q * Q) in double
+    // precision for results within +-200 dB: the log2 series is exact to about
+    // 1e-7 dB, the rest is float rounding of the power and of the result
+    const float PowerDbMaxError = 2e-5f;
+
+    // |x|^2 of interleaved I/Q samples, iq holds 2 * samples floats
+    void PowerIq(const float* iq, size_t samples, float* power, SimdLevel level = DetectSimdLevel());
+
+    // 10 * log10(|x|^2) of interleaved I/Q samples, with powers below floorDb,
+    // zero and NaN clamped to floorDb (at least -370 dB, the float range). The
+    // log2 is a short odd series of (m - 1) / (m + 1) on the mantissa; every
+    // SIMD level gives the same result. Buffers need no alignment.
+    void PowerDbIq(const float* iq, size_t samples, float* db, float floorDb = DefaultPowerFloorDb,
+        SimdLevel level = DetectSimdLevel());
+
+    // 10 * log10 of linear powers, e.g. averaged spectra, with the same floor
+    // and series as PowerDbIq
+    void PowerToDb(const float* power, size_t count, float* db, float floorDb = DefaultPowerFloorDb,
+        SimdLevel level = DetectSimdLevel());
+
+    // Whole packet, honouring packet.stride; for Rx12 the first receiver.
+    // Returns the samples written, 0 if the packet does not carry IQ.
+    size_t PowerDbIq(const AARTSAAPI_Packet& packet, float* db, float floorDb = DefaultPowerFloorDb);
+}
+
+#endif
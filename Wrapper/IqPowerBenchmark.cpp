@@ -0,0 +1,107 @@
+#include "BenchmarkSupport.h"
+#include "IqPower.h"
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// Compares the per sample log10(I * I + Q * Q) * 10 of the transceiver samples
+// with PowerDbIq at every SIMD level the CPU supports, on a buffer of a few
+// packets that stays in cache. First checks every level against the scalar
+// kernel and measures the largest error against log10 in double precision over
+// powers from -190 dB to +40 dB, spread over all mantissas. Runs without a
+// device; takes the iteration count and the samples per call.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    template <typename Kernel>
+    double samplesPerSecond(int iterations, size_t samples, Kernel&& kernel)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            kernel();
+        return double(iterations) * double(samples) / SecondsSince(start);
+    }
+
+    // IQ with magnitudes uniform in dB and uniform phase
+    std::vector<float> makeIq(size_t samples, double lowDb, double highDb, unsigned seed)
+    {
+        std::vector<float> iq(2 * samples);
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<double> level(lowDb, highDb), phase(0.0, 6.283185307179586);
+        for (size_t j = 0; j < samples; j++)
+        {
+            double amplitude = std::pow(10.0, level(random) / 20.0), angle = phase(random);
+            iq[2 * j] = float(amplitude * std::cos(angle));
+            iq[2 * j + 1] = float(amplitude * std::sin(angle));
+        }
+        return iq;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations = NumberArgument<int>(argc, argv, 1, 20000);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 4096);
+
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (int(DetectSimdLevel()) >= int(SimdLevel::SSE2))
+        levels.push_back(SimdLevel::SSE2);
+    if (DetectSimdLevel() == SimdLevel::AVX2)
+        levels.push_back(SimdLevel::AVX2);
+
+    // Accuracy, with a length that leaves a scalar tail
+    const size_t checkSamples = 1000003;
+    std::vector<float> checkIq = makeIq(checkSamples, -190.0, 40.0, 3);
+    std::vector<float> reference(checkSamples), db(checkSamples);
+    PowerDbIq(checkIq.data(), checkSamples, reference.data(), DefaultPowerFloorDb, SimdLevel::Scalar);
+    for (SimdLevel level : levels)
+    {
+        PowerDbIq(checkIq.data(), checkSamples, db.data(), DefaultPowerFloorDb, level);
+        if (db != reference)
+        {
+            std::cerr << SimdLevelName(level) << " kernel differs from the scalar one" << std::endl;
+            return -1;
+        }
+    }
+
+    double maxError = 0, sumError = 0;
+    for (size_t j = 0; j < checkSamples; j++)
+    {
+        double i = double(checkIq[2 * j]), q = double(checkIq[2 * j + 1]);
+        double exact = 10.0 * std::log10(i * i + q * q);
+        double error = std::fabs(double(reference[j]) - exact);
+        maxError = std::max(maxError, error);
+        sumError += error;
+    }
+    std::vector<float> zero(2 * 16, 0.0f), zeroDb(16);
+    PowerDbIq(zero.data(), 16, zeroDb.data());
+
+    std::cout << std::scientific << std::setprecision(2)
+        << "Accuracy       : max error " << maxError << " dB, mean " << sumError / double(checkSamples) << " dB (bound "
+        << PowerDbMaxError << "), zero input " << std::fixed << std::setprecision(1) << zeroDb[0] << " dB" << std::endl;
+
+    // Throughput on typical levels
+    std::vector<float> iq = makeIq(samples, -120.0, 0.0, 5);
+    std::vector<float> out(samples);
+    double libm = samplesPerSecond(iterations, samples, [&]()
+        {
+            for (size_t j = 0; j < samples; j++)
+                out[j] = log10(iq[2 * j] * iq[2 * j] + iq[2 * j + 1] * iq[2 * j + 1]) * 10;
+            DoNotOptimize(out[0]);
+        });
+
+    std::cout << "Throughput     : " << samples << " IQ samples per call" << std::endl
+        << "MSamples/s          dB     |x|^2" << std::endl
+        << std::left << std::setw(15) << "libm log10" << std::right << std::setprecision(0) << std::setw(8) << libm / 1e6 << std::endl;
+    for (SimdLevel level : levels)
+    {
+        double powerDb = samplesPerSecond(iterations, samples, [&]() { PowerDbIq(iq.data(), samples, out.data(), DefaultPowerFloorDb, level); DoNotOptimize(out[0]); });
+        double power = samplesPerSecond(iterations, samples, [&]() { PowerIq(iq.data(), samples, out.data(), level); DoNotOptimize(out[0]); });
+        std::cout << std::left << std::setw(15) << SimdLevelName(level) << std::right << std::setw(8) << powerDb / 1e6 << std::setw(10) << power / 1e6 << std::endl;
+    }
+
+    return 0;
+}
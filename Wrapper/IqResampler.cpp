@@ -0,0 +1,141 @@
+#include "IqResampler.h"
+#include "FirFilter.h"
+#include <algorithm>
+#include <numeric>
+
+namespace AarRtsaSdkWrapper
+{
+
+    IqResampler::IqResampler(const IqResamplerSettings& settings)
+        : m_settings(settings)
+    {
+        uint32_t l = std::max<uint32_t>(1, m_settings.interpolation), m = std::max<uint32_t>(1, m_settings.decimation);
+        uint32_t common = std::gcd(l, m);
+        m_settings.interpolation = l / common;
+        m_settings.decimation = m / common;
+        m_settings.bandwidth = std::min(std::max(m_settings.bandwidth, 0.01), 0.99);
+        m_settings.level = ClampSimdLevel(m_settings.level);
+
+        // Designed at the interpolated rate: the passband ends at bandwidth of
+        // the lower Nyquist frequency, the stopband starts at it, the -6 dB
+        // point lies halfway
+        const uint32_t phases = m_settings.interpolation;
+        const double nyquist = 0.5 / double(std::max(phases, m_settings.decimation));
+        size_t tapsPerPhase = m_settings.tapsPerPhase;
+        if (tapsPerPhase == 0)
+            tapsPerPhase = (LowpassFirTaps((1 - m_settings.bandwidth) * nyquist, m_settings.stopbandDb) + phases - 1) / phases;
+        m_tapsPerPhase = (std::max<size_t>(4, tapsPerPhase) + 3) / 4 * 4;
+        m_settings.tapsPerPhase = m_tapsPerPhase;
+        std::vector<float> h = DesignLowpassFir(phases * m_tapsPerPhase, nyquist * (1 + m_settings.bandwidth) / 2, m_settings.stopbandDb);
+
+        // Phase p convolves input sample i - k with h[p + k * phases]; stored
+        // reversed to run over the input in order, with DC gain 1 per phase
+        m_taps.assign(2 * phases * m_tapsPerPhase, 0.0f);
+        for (uint32_t p = 0; p < phases; p++)
+        {
+            for (size_t k = 0; k < m_tapsPerPhase; k++)
+            {
+                float tap = h[p + k * phases] * float(phases);
+                size_t r = p * m_tapsPerPhase + (m_tapsPerPhase - 1 - k);
+                m_taps[2 * r] = m_taps[2 * r + 1] = tap;
+            }
+        }
+        reset();
+    }
+
+    double IqResampler::delay() const
+    {
+        return (double(m_settings.interpolation * m_tapsPerPhase) - 1) / 2 / double(m_settings.interpolation);
+    }
+
+    void IqResampler::reset()
+    {
+        restartFilter();
+        m_timing.reset();
+    }
+
+    void IqResampler::restartFilter()
+    {
+        m_buffer.assign(2 * (m_tapsPerPhase - 1), 0.0f);
+        m_index = m_tapsPerPhase - 1;
+        m_phase = 0;
+        m_bufferStart = -int64_t(m_tapsPerPhase - 1);
+    }
+
+    size_t IqResampler::maxOutput(size_t samples) const
+    {
+        return size_t(uint64_t(samples) * m_settings.interpolation / m_settings.decimation) + 1;
+    }
+
+    size_t IqResampler::run(float* out)
+    {
+        const size_t available = m_buffer.size() / 2, history = m_tapsPerPhase - 1;
+        const uint32_t phases = m_settings.interpolation, step = m_settings.decimation;
+        size_t n = 0;
+        while (m_index < available)
+        {
+            FirDotIq(&m_buffer[2 * (m_index - history)], &m_taps[2 * m_phase * m_tapsPerPhase], m_tapsPerPhase, out + 2 * n, m_settings.level);
+            n++;
+            m_phase += step;
+            m_index += m_phase / phases;
+            m_phase %= phases;
+        }
+
+        // Keep the history for the next call
+        size_t drop = available - history;
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + std::ptrdiff_t(2 * drop));
+        m_index -= drop;
+        m_bufferStart += int64_t(drop);
+        return n;
+    }
+
+    size_t IqResampler::process(const float* iq, size_t samples, float* out)
+    {
+        AppendIq(m_buffer, iq, samples, 2);
+        return run(out);
+    }
+
+    size_t IqResampler::process(const AARTSAAPI_Packet& in, AARTSAAPI_Packet& out)
+    {
+        out = in;
+        out.num = out.total = 0;
+        out.size = out.stride = 2;
+        out.fp32 = nullptr;
+        if (in.size < 2 || in.num <= 0 || !in.fp32 || in.stepFrequency <= 0)
+        {
+            m_timing.skip(in);
+            out.flags &= ~StreamStartFlags;
+            return 0;
+        }
+        if (m_timing.advance(in))
+            restartFilter();
+
+        // Time of the next output: its interpolated position minus the group delay
+        const double rate = m_timing.rate(), outRate = rate * m_settings.interpolation / m_settings.decimation;
+        double position = double(m_bufferStart + int64_t(m_index)) + double(m_phase) / m_settings.interpolation - delay();
+        double startTime = m_timing.time0() + position / rate;
+
+        AppendIq(m_buffer, in.fp32, size_t(in.num), in.stride);
+        m_output.resize(2 * maxOutput(size_t(in.num)));
+        size_t n = run(m_output.data());
+
+        double passSpan = m_settings.bandwidth * std::min(rate, outRate);
+        double span = in.spanFrequency > 0 ? std::min(in.spanFrequency, passSpan) : passSpan;
+        out.startFrequency = in.startFrequency + in.spanFrequency / 2 - span / 2;
+        out.spanFrequency = span;
+        out.stepFrequency = outRate;
+        out.startTime = startTime;
+        out.endTime = startTime + double(n) / outRate;
+        out.num = out.total = int64_t(n);
+        out.fp32 = n ? m_output.data() : nullptr;
+        out.flags &= ~StreamStartFlags;
+        if (n)
+            out.flags |= m_timing.takeFlags();
+        return n;
+    }
+
+    void ResampleChannels(WorkerPool& pool, std::vector<IqResampler>& resamplers, const AARTSAAPI_Packet* in, AARTSAAPI_Packet* out)
+    {
+        pool.parallelFor(resamplers.size(), [&](size_t c) { resamplers[c].process(in[c], out[c]); });
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef IQRESAMPLER_H
+#define IQRESAMPLER_H
+
+#include "SimdSupport.h"
+#include "StreamTiming.h"
+#include "WorkerPool.h"
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct IqResamplerSettings
+    {
+        uint32_t interpolation;     // output rate = input rate * interpolation / decimation
+        uint32_t decimation;
+        size_t tapsPerPhase;        // filter length in input samples, rounded up to a multiple of 4; 0 for what bandwidth and stopbandDb need
+        double bandwidth;           // part of the lower Nyquist band passed, the rest is transition
+        double stopbandDb;          // attenuation of everything that would alias
+        SimdLevel level;
+
+        IqResamplerSettings(uint32_t interpolation = 1, uint32_t decimation = 1)
+            : interpolation(interpolation), decimation(decimation), tapsPerPhase(0), bandwidth(0.8), stopbandDb(80.0),
+              level(DetectSimdLevel())
+        {
+        }
+    };
+
+    // Streaming rational resampler for complex IQ, e.g. to reach a rate the
+    // power of two steps of main/decimation do not offer. A polyphase FIR with
+    // interpolation phases computes only the output samples, each as one
+    // multiply-accumulate over tapsPerPhase input samples.
+    //
+    // Filter state carries over from packet to packet, so a packet stream
+    // resamples like one long signal. Output packets get the new
+    // stepFrequency, a spanFrequency and startFrequency cut to the passband,
+    // and the startTime of their first sample, which lies delay() input
+    // samples before the input sample it is computed at. A gap, detected from
+    // the timestamps or AARTSAAPI_PACKET_SEGMENT_START, or a rate change
+    // restarts the filter; the next output packet then has
+    // AARTSAAPI_PACKET_SEGMENT_START set and starts with the transient of the
+    // filter again.
+    class IqResampler
+    {
+    public:
+        explicit IqResampler(const IqResamplerSettings& settings = IqResamplerSettings());
+
+        const IqResamplerSettings& settings() const { return m_settings; }
+        size_t taps() const { return m_taps.size() / 2; }
+
+        // Group delay of the filter in input samples
+        double delay() const;
+
+        // Resamples an IQ packet (size 2, or the first receiver of Rx12). out
+        // points into the resampler and stays valid until the next call; it
+        // may have no samples. Returns out.num.
+        size_t process(const AARTSAAPI_Packet& in, AARTSAAPI_Packet& out);
+
+        // Resamples interleaved I/Q without timestamps, out needs room for
+        // maxOutput(samples) samples. Returns the samples written.
+        size_t process(const float* iq, size_t samples, float* out);
+        size_t maxOutput(size_t samples) const;
+
+        // Drops the filter state and the timing
+        void reset();
+
+    private:
+        void restartFilter();
+        size_t run(float* out);
+
+        IqResamplerSettings m_settings;
+        size_t m_tapsPerPhase;
+        std::vector<float> m_taps;      // per phase tapsPerPhase taps, reversed and paired for FirDotIq
+        std::vector<float> m_buffer;    // tapsPerPhase - 1 samples of history followed by new input
+        size_t m_index;                 // buffer sample of the next output's newest input
+        uint32_t m_phase;               // interpolation phase of the next output
+        int64_t m_bufferStart;          // stream index of the first buffer sample
+
+        StreamTiming m_timing;
+        std::vector<float> m_output;
+    };
+
+    // Resamples one packet per channel, channel c with resamplers[c], the
+    // channels spread over the pool. out[c] as from IqResampler::process.
+    void ResampleChannels(WorkerPool& pool, std::vector<IqResampler>& resamplers, const AARTSAAPI_Packet* in, AARTSAAPI_Packet* out);
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "BenchmarkSupport.h"
+#include "IqResampler.h"
+#include <cmath>
+#include <complex>
+#include <iomanip>
+#include <numbers>
+#include <vector>
+
+// Resamples a stream of IQ packets at several rational ratios. Checks the
+// output of a tone in the passband against the ideal tone at the output
+// timestamps, which checks filter, images and timing at once, the attenuation
+// of a tone that would alias when decimating, and every SIMD level against
+// the scalar one. Then times one channel per SIMD level and eight channels
+// spread over worker pools of one thread up to one per core. Runs without a
+// device; takes the packets per run and the samples per packet.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const double InputRate = 1e6;
+
+    std::vector<AARTSAAPI_Packet> makePackets(std::vector<float>& iq, size_t packets, size_t samples, double frequency)
+    {
+        iq.resize(2 * packets * samples);
+        for (size_t j = 0; j < packets * samples; j++)
+        {
+            double phase = 2 * std::numbers::pi * frequency * double(j) / InputRate;
+            iq[2 * j] = float(0.5 * std::cos(phase));
+            iq[2 * j + 1] = float(0.5 * std::sin(phase));
+        }
+
+        std::vector<AARTSAAPI_Packet> list(packets);
+        for (size_t p = 0; p < packets; p++)
+        {
+            AARTSAAPI_Packet& packet = list[p];
+            packet = AARTSAAPI_Packet();
+            packet.num = packet.total = int64_t(samples);
+            packet.size = packet.stride = 2;
+            packet.fp32 = iq.data() + 2 * p * samples;
+            packet.stepFrequency = InputRate;
+            packet.spanFrequency = 0.8 * InputRate;
+            packet.startFrequency = 100e6 - packet.spanFrequency / 2;
+            packet.startTime = 1000.0 + double(p * samples) / InputRate;
+            packet.endTime = packet.startTime + double(samples) / InputRate;
+        }
+        list[0].flags = AARTSAAPI_PACKET_STREAM_START;
+        return list;
+    }
+
+    struct Quality
+    {
+        double toneErrorDb;         // largest deviation from the ideal tone after the transient, relative to it
+        double aliasDb;             // level of the aliasing tone at the output, 0 when not decimating
+        double timeStepError;       // largest gap between one packet's end and the next packet's start, in seconds
+        float simdDifference;       // largest difference of any level from the scalar output
+    };
+
+    Quality measure(uint32_t interpolation, uint32_t decimation, size_t samples)
+    {
+        Quality quality = {};
+        const size_t packets = 64;
+        const double outRate = InputRate * interpolation / decimation;
+        const double lowerRate = std::min(InputRate, outRate);
+
+        std::vector<float> iq;
+        std::vector<AARTSAAPI_Packet> in = makePackets(iq, packets, samples, 0.2 * lowerRate);
+        IqResamplerSettings settings(interpolation, decimation);
+        std::vector<std::vector<float>> outputs;
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+        {
+            settings.level = level;
+            IqResampler resampler(settings);
+            std::vector<float> all;
+            double lastEnd = 0;
+            double maxError = 0;
+            for (size_t p = 0; p < packets; p++)
+            {
+                AARTSAAPI_Packet out;
+                size_t n = resampler.process(in[p], out);
+                if (lastEnd > 0 && n)
+                    quality.timeStepError = std::max(quality.timeStepError, std::fabs(out.startTime - lastEnd));
+                if (n)
+                    lastEnd = out.endTime;
+                all.insert(all.end(), out.fp32, out.fp32 + 2 * n);
+
+                // The tone at the output times, after the filter has filled
+                for (size_t j = 0; p >= 4 && j < n; j++)
+                {
+                    double t = out.startTime + double(j) / out.stepFrequency - in[0].startTime;
+                    std::complex<double> ideal = std::polar(0.5, 2 * std::numbers::pi * 0.2 * lowerRate * t);
+                    maxError = std::max(maxError, std::abs(std::complex<double>(out.fp32[2 * j], out.fp32[2 * j + 1]) - ideal));
+                }
+            }
+            if (level == SimdLevel::Scalar)
+                quality.toneErrorDb = 20 * std::log10(maxError / 0.5);
+            outputs.push_back(all);
+        }
+        for (const std::vector<float>& output : outputs)
+        {
+            for (size_t k = 0; k < output.size() && k < outputs[0].size(); k++)
+                quality.simdDifference = std::max(quality.simdDifference, std::fabs(output[k] - outputs[0][k]));
+        }
+
+        // A tone between the output and the input Nyquist frequency would fold
+        // into the output band
+        if (outRate >= InputRate)
+            return quality;
+        in = makePackets(iq, packets, samples, (outRate + InputRate) / 4);
+        IqResampler resampler(IqResamplerSettings(interpolation, decimation));
+        double power = 0;
+        size_t count = 0;
+        for (size_t p = 0; p < packets; p++)
+        {
+            AARTSAAPI_Packet out;
+            size_t n = resampler.process(in[p], out);
+            for (size_t j = 0; p >= 4 && j < n; j++, count++)
+                power += double(out.fp32[2 * j]) * out.fp32[2 * j] + double(out.fp32[2 * j + 1]) * out.fp32[2 * j + 1];
+        }
+        quality.aliasDb = 10 * std::log10(std::max(power / double(std::max<size_t>(count, 1)), 1e-30) / 0.25);
+        return quality;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t packets = NumberArgument<size_t>(argc, argv, 1, 2000);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 1024);
+    const uint32_t ratios[][2] = { { 3, 4 }, { 2, 5 }, { 147, 160 }, { 5, 2 } };
+
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (int(DetectSimdLevel()) >= int(SimdLevel::SSE2))
+        levels.push_back(SimdLevel::SSE2);
+    if (DetectSimdLevel() == SimdLevel::AVX2)
+        levels.push_back(SimdLevel::AVX2);
+
+    std::cout << "Quality        : passband " << IqResamplerSettings().bandwidth << " of the lower Nyquist band, stopband "
+        << IqResamplerSettings().stopbandDb << " dB" << std::endl
+        << "ratio     taps  tone error dB   alias dB   packet time step s   SIMD difference" << std::endl;
+    for (const uint32_t* ratio : ratios)
+    {
+        Quality quality = measure(ratio[0], ratio[1], samples);
+        std::cout << std::setw(3) << ratio[0] << "/" << std::left << std::setw(5) << ratio[1] << std::right << std::fixed << std::setprecision(1)
+            << std::setw(5) << IqResampler(IqResamplerSettings(ratio[0], ratio[1])).settings().tapsPerPhase
+            << std::setw(15) << quality.toneErrorDb << std::setw(11);
+        if (quality.aliasDb < 0)
+            std::cout << quality.aliasDb;
+        else
+            std::cout << "-";
+        std::cout
+            << std::scientific << std::setprecision(1) << std::setw(21) << quality.timeStepError << std::setw(18) << quality.simdDifference << std::endl;
+    }
+
+    // Throughput in input samples per second
+    std::vector<float> iq;
+    std::vector<AARTSAAPI_Packet> in = makePackets(iq, 64, samples, 12345.0);
+    std::cout << std::endl << "Throughput     : MSamples/s of input, one channel" << std::endl << "ratio    ";
+    for (SimdLevel level : levels)
+        std::cout << std::setw(10) << SimdLevelName(level);
+    std::cout << std::endl;
+    for (const uint32_t* ratio : ratios)
+    {
+        std::cout << std::setw(3) << ratio[0] << "/" << std::left << std::setw(5) << ratio[1] << std::right << std::fixed << std::setprecision(1);
+        for (SimdLevel level : levels)
+        {
+            IqResamplerSettings settings(ratio[0], ratio[1]);
+            settings.level = level;
+            IqResampler resampler(settings);
+            AARTSAAPI_Packet out;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t p = 0; p < packets; p++)
+            {
+                // The timestamps restart every 64 packets, like a new segment
+                resampler.process(in[p % in.size()], out);
+                DoNotOptimize(out.fp32);
+            }
+            std::cout << std::setw(10) << double(packets * samples) / SecondsSince(start) / 1e6;
+        }
+        std::cout << std::endl;
+    }
+
+    // Eight channels at 3/4 per worker pool size
+    const size_t channels = 8;
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::cout << std::endl << "Channels       : " << channels << " at 3/4, MSamples/s of input over all channels" << std::endl;
+    for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+    {
+        WorkerPool pool{ WorkerPoolSettings(threads) };
+        std::vector<IqResampler> resamplers(channels, IqResampler(IqResamplerSettings(3, 4)));
+        std::vector<AARTSAAPI_Packet> batch(channels), out(channels);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t p = 0; p < packets; p++)
+        {
+            std::fill(batch.begin(), batch.end(), in[p % in.size()]);
+            ResampleChannels(pool, resamplers, batch.data(), out.data());
+            DoNotOptimize(out[0].fp32);
+        }
+        std::cout << std::setw(3) << threads << " threads " << std::setw(10) << double(channels * packets * samples) / SecondsSince(start) / 1e6 << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Logarithmic nanosecond buckets shared by the latency statistics of the
+    // wrapper. Values below 4 get their own bucket, above that there are four
+    // buckets per power of two, so a bucket bound is within 25% of its values.
+    const size_t LatencyBucketCount = 256;
+
+    inline size_t LatencyBucketIndex(uint64_t ns)
+    {
+        if (ns < 4)
+            return size_t(ns);
+        unsigned msb = unsigned(std::bit_width(ns)) - 1;
+        return 4 * (msb - 1) + size_t((ns >> (msb - 2)) & 3);
+    }
+
+    inline uint64_t LatencyBucketLowerBound(size_t index)
+    {
+        if (index < 4)
+            return index;
+        unsigned msb = unsigned(index / 4) + 1;
+        return uint64_t(4 + index % 4) << (msb - 2);
+    }
+
+    // Upper bound of the bucket holding the given fraction of `count` values,
+    // clamped to the largest recorded value
+    inline uint64_t LatencyPercentile(const uint64_t* buckets, uint64_t count, uint64_t maxNs, double fraction)
+    {
+        uint64_t rank = uint64_t(fraction * double(count) + 0.5);
+        if (rank < 1)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < LatencyBucketCount; i++)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+            {
+                uint64_t upper = i + 1 < LatencyBucketCount ? LatencyBucketLowerBound(i + 1) - 1 : maxNs;
+                return upper < maxNs ? upper : maxNs;
+            }
+        }
+        return maxNs;
+    }
+
+    // Single threaded histogram for statistics owned by one consumer
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram() { reset(); }
+
+        void add(uint64_t ns)
+        {
+            m_buckets[LatencyBucketIndex(ns)]++;
+            m_count++;
+            m_totalNs += ns;
+            if (ns > m_maxNs)
+                m_maxNs = ns;
+        }
+
+        void reset()
+        {
+            for (uint64_t& bucket : m_buckets)
+                bucket = 0;
+            m_count = m_totalNs = m_maxNs = 0;
+        }
+
+        uint64_t count() const { return m_count; }
+        uint64_t maxNs() const { return m_maxNs; }
+        double meanNs() const { return m_count ? double(m_totalNs) / double(m_count) : 0.0; }
+        uint64_t percentileNs(double fraction) const { return m_count ? LatencyPercentile(m_buckets, m_count, m_maxNs, fraction) : 0; }
+
+    private:
+        uint64_t m_buckets[LatencyBucketCount];
+        uint64_t m_count, m_totalNs, m_maxNs;
+    };
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "BenchmarkSupport.h"
+#include "MultiDeviceSession.h"
+#include <iomanip>
+#include <thread>
+
+// Brings up every enumerated device once one after another, like the samples do
+// for their single device, and once through a MultiDeviceSession that opens and
+// connects them in parallel. Then streams raw IQ from all devices through their
+// acquisition workers. With the simulated backend, AARTSAAPI_SIM_DEVICES and
+// AARTSAAPI_SIM_CONNECT_MS set the number of units and their connect latency.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    // Open, connect and start in sequence, the time until all devices stream
+    double sequentialBringUp(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Handle* handle, const MultiDeviceSettings& settings, size_t& devices)
+    {
+        auto start = std::chrono::steady_clock::now();
+        sdkWrapper.RescanDevices(handle, settings.rescanTimeout);
+
+        std::vector<AARTSAAPI_Device> opened;
+        for (const std::string& family : settings.families)
+        {
+            Wrapper_DeviceInfo info;
+            for (int32_t index = 0; sdkWrapper.EnumDevice(handle, family, index, &info) == AARTSAAPI_OK; index++)
+            {
+                AARTSAAPI_Device device = { nullptr };
+                if (sdkWrapper.OpenDevice(handle, &device, family + "/" + settings.mode, info.serialNumber) != AARTSAAPI_OK)
+                    continue;
+                sdkWrapper.ConnectDevice(&device);
+                sdkWrapper.StartDevice(&device);
+                opened.push_back(device);
+            }
+        }
+        double seconds = SecondsSince(start);
+
+        for (AARTSAAPI_Device& device : opened)
+        {
+            sdkWrapper.StopDevice(&device);
+            sdkWrapper.DisconnectDevice(&device);
+            sdkWrapper.CloseDevice(handle, &device);
+        }
+        devices = opened.size();
+        return seconds;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const double seconds = NumberArgument<double>(argc, argv, 2, 2.0);
+
+    AARTSAAPI_Result res;
+    if ((res = sdkWrapper.Init_With_Path(AARTSAAPI_MEMORY_MEDIUM, CFG_AARONIA_XML_LOOKUP_DIRECTORY)) != AARTSAAPI_OK)
+    {
+        std::cerr << "AARTSAAPI_Init_With_Path failed: " << sdkWrapper.getErrorString(res) << std::endl;
+        return -1;
+    }
+    AARTSAAPI_Handle handle;
+    if ((res = sdkWrapper.Open(&handle)) != AARTSAAPI_OK)
+    {
+        std::cerr << "AARTSAAPI_Open failed: " << sdkWrapper.getErrorString(res) << std::endl;
+        sdkWrapper.Shutdown();
+        return -1;
+    }
+
+    MultiDeviceSettings settings;
+    for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+        settings.cpus.push_back(int(cpu));
+
+    size_t sequentialDevices = 0;
+    double sequential = sequentialBringUp(sdkWrapper, &handle, settings, sequentialDevices);
+
+    int status = 0;
+    {
+        MultiDeviceSession session(sdkWrapper, &handle, settings);
+        auto start = std::chrono::steady_clock::now();
+        res = session.open();
+        double parallel = SecondsSince(start);
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "Opening the devices failed: " << sdkWrapper.getErrorString(res) << std::endl;
+            status = -1;
+        }
+        else
+        {
+            // One consumer per device draining its acquisition ring
+            session.startAcquisition();
+            CancelToken stop;
+            std::vector<std::thread> consumers;
+            for (size_t i = 0; i < session.size(); i++)
+            {
+                PacketAcquisition* acquisition = session.acquisition(i);
+                if (!acquisition)
+                    continue;
+                consumers.emplace_back([acquisition, &stop]()
+                    {
+                        PacketWaiter waiter(PacketWaitPolicy::Yield);
+                        const AARTSAAPI_Packet* packet;
+                        while (acquisition->wait(&packet, waiter, std::chrono::milliseconds(100), &stop) == AARTSAAPI_OK)
+                        {
+                            DoNotOptimize(packet->fp32[0]);
+                            acquisition->release();
+                        }
+                    });
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            stop.cancel();
+            for (std::thread& consumer : consumers)
+                consumer.join();
+            session.stopAcquisition();
+
+            MultiDeviceStatistics stats = session.statistics();
+            std::cout << std::fixed << std::setprecision(3)
+                << "Sequential    : " << sequentialDevices << " devices streaming after " << sequential << " s" << std::endl
+                << "Parallel      : " << stats.started << " of " << stats.devices << " devices streaming after " << parallel << " s" << std::endl;
+            for (size_t i = 0; i < session.size(); i++)
+            {
+                const SessionDevice& dev = session.device(i);
+                std::cout << "  " << std::left << std::setw(14) << dev.family << std::setw(14) << dev.info.serialNumber << std::right
+                    << " connect " << dev.connectSeconds << " s, " << stats.perDevice[i].packets << " packets" << std::endl;
+            }
+            std::cout << std::setprecision(0)
+                << "Aggregate     : " << stats.packets << " packets, " << double(stats.packets) / seconds << " packets/s, "
+                << stats.overruns << " ring overruns, " << stats.hardwareGaps << " device side gaps" << std::endl;
+        }
+    }
+
+    sdkWrapper.Close(&handle);
+    sdkWrapper.Shutdown();
+    return status;
+}
@@ -0,0 +1,168 @@
+#include "MultiDeviceSession.h"
+#include <chrono>
+#include <thread>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // RescanDevices calls before open gives up on a scan that keeps asking for a retry
+        const int MaxRescans = 10;
+
+        double secondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    MultiDeviceSession::MultiDeviceSession(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Handle* handle, const MultiDeviceSettings& settings)
+        : m_sdkWrapper(sdkWrapper), m_handle(handle), m_settings(settings)
+    {
+    }
+
+    MultiDeviceSession::~MultiDeviceSession()
+    {
+        close();
+    }
+
+    AARTSAAPI_Result MultiDeviceSession::open()
+    {
+        close();
+
+        // RETRY means the scan has not finished, enumerating then could miss units
+        AARTSAAPI_Result res = AARTSAAPI_RETRY;
+        for (int attempt = 0; attempt < MaxRescans && res == AARTSAAPI_RETRY; attempt++)
+            res = m_sdkWrapper.RescanDevices(m_handle, m_settings.rescanTimeout);
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        for (const std::string& family : m_settings.families)
+        {
+            for (int32_t index = 0;; index++)
+            {
+                std::unique_ptr<SessionDevice> dev(new SessionDevice());
+                if (m_sdkWrapper.EnumDevice(m_handle, family, index, &dev->info) != AARTSAAPI_OK)
+                    break;
+                dev->family = family;
+                m_devices.push_back(std::move(dev));
+            }
+        }
+        if (m_devices.empty())
+            return AARTSAAPI_ERROR_NOT_FOUND;
+
+        std::vector<std::thread> threads;
+        threads.reserve(m_devices.size());
+        for (std::unique_ptr<SessionDevice>& dev : m_devices)
+            threads.emplace_back(&MultiDeviceSession::bringUp, this, std::ref(*dev));
+        for (std::thread& thread : threads)
+            thread.join();
+
+        AARTSAAPI_Result first = AARTSAAPI_OK;
+        for (const std::unique_ptr<SessionDevice>& dev : m_devices)
+        {
+            if (dev->started)
+                return AARTSAAPI_OK;
+            if (first == AARTSAAPI_OK)
+                first = dev->status;
+        }
+        return first;
+    }
+
+    void MultiDeviceSession::bringUp(SessionDevice& dev)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if ((dev.status = m_sdkWrapper.OpenDevice(m_handle, &dev.device, dev.family + "/" + m_settings.mode, dev.info.serialNumber)) != AARTSAAPI_OK)
+            return;
+        dev.open = true;
+
+        if (m_settings.configure)
+        {
+            std::lock_guard<std::mutex> guard(m_configureLock);
+            if ((dev.status = m_settings.configure(m_sdkWrapper, &dev.device)) != AARTSAAPI_OK)
+                return;
+        }
+        dev.openSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        if ((dev.status = m_sdkWrapper.ConnectDevice(&dev.device)) != AARTSAAPI_OK)
+            return;
+        dev.connected = true;
+        if ((dev.status = m_sdkWrapper.StartDevice(&dev.device)) != AARTSAAPI_OK)
+            return;
+        dev.started = true;
+        dev.connectSeconds = secondsSince(start);
+    }
+
+    bool MultiDeviceSession::startAcquisition()
+    {
+        bool all = true;
+        size_t worker = 0;
+        for (std::unique_ptr<SessionDevice>& dev : m_devices)
+        {
+            if (!dev->started)
+                continue;
+            if (!dev->acquisition)
+            {
+                PacketAcquisitionSettings settings = m_settings.acquisition;
+                settings.thread.cpu = m_settings.cpus.empty() ? -1 : m_settings.cpus[worker % m_settings.cpus.size()];
+                dev->acquisition.reset(new PacketAcquisition(m_sdkWrapper, &dev->device, m_settings.channel, settings));
+            }
+            worker++;
+            if (!dev->acquisition->running() && !dev->acquisition->start())
+                all = false;
+        }
+        return all;
+    }
+
+    void MultiDeviceSession::stopAcquisition()
+    {
+        for (std::unique_ptr<SessionDevice>& dev : m_devices)
+        {
+            if (dev->acquisition)
+                dev->acquisition->stop();
+        }
+    }
+
+    void MultiDeviceSession::close()
+    {
+        stopAcquisition();
+        for (std::unique_ptr<SessionDevice>& dev : m_devices)
+        {
+            dev->acquisition.reset();
+            if (dev->started)
+                m_sdkWrapper.StopDevice(&dev->device);
+            if (dev->connected)
+                m_sdkWrapper.DisconnectDevice(&dev->device);
+            if (dev->open)
+                m_sdkWrapper.CloseDevice(m_handle, &dev->device);
+        }
+        m_devices.clear();
+    }
+
+    MultiDeviceStatistics MultiDeviceSession::statistics() const
+    {
+        MultiDeviceStatistics stats = {};
+        stats.devices = m_devices.size();
+        stats.perDevice.resize(m_devices.size());
+        for (size_t i = 0; i < m_devices.size(); i++)
+        {
+            const SessionDevice& dev = *m_devices[i];
+            if (dev.started)
+                stats.started++;
+            if (!dev.acquisition)
+                continue;
+
+            PacketAcquisitionStatistics& device = stats.perDevice[i];
+            device = dev.acquisition->statistics();
+            if (dev.acquisition->running())
+                stats.running++;
+            stats.packets += device.packets;
+            stats.overruns += device.overruns;
+            stats.hardwareGaps += device.hardwareGaps;
+            if (device.highWater > stats.highWater)
+                stats.highWater = device.highWater;
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef MULTIDEVICESESSION_H
+#define MULTIDEVICESESSION_H
+
+#include "AaroniaRtsaSdkWrapper.h"
+#include "PacketAcquisition.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct MultiDeviceSettings
+    {
+        std::vector<std::string> families;      // device types to enumerate
+        std::string mode;                       // opened as family/mode
+        int32_t channel;                        // channel the acquisition workers read
+        int rescanTimeout;                      // ms per RescanDevices call, repeated while the scan returns AARTSAAPI_RETRY
+        PacketAcquisitionSettings acquisition;  // per device, thread.cpu is taken from cpus
+        std::vector<int> cpus;                  // cores for the workers of device 0, 1, ..., repeated; empty for none
+
+        // Called for every opened device before it connects, one device at a
+        // time under the session lock, so it may resolve config handles
+        std::function<AARTSAAPI_Result(AaroniaRtsaSdkWrapper&, AARTSAAPI_Device*)> configure;
+
+        MultiDeviceSettings()
+            : families({ "spectranv6", "spectranv6eco" }), mode("raw"), channel(0), rescanTimeout(2000)
+        {
+        }
+    };
+
+    struct SessionDevice
+    {
+        std::string family;
+        Wrapper_DeviceInfo info;
+        AARTSAAPI_Device device;
+        AARTSAAPI_Result status;        // of the first failed open, configure, connect or start step
+        double openSeconds;             // open and configure
+        double connectSeconds;          // connect and start
+        bool open, connected, started;
+        std::unique_ptr<PacketAcquisition> acquisition;
+
+        SessionDevice() : device{ nullptr }, status(AARTSAAPI_OK), openSeconds(0), connectSeconds(0), open(false), connected(false), started(false) {}
+    };
+
+    struct MultiDeviceStatistics
+    {
+        size_t devices;                 // enumerated
+        size_t started;                 // streaming
+        size_t running;                 // with a running acquisition worker
+        uint64_t packets, overruns, hardwareGaps;
+        size_t highWater;               // largest of the devices
+        std::vector<PacketAcquisitionStatistics> perDevice;     // empty entries for devices without worker
+    };
+
+    // Enumerates every device of the given types and brings them up in parallel,
+    // one thread per device for open, configure, connect and start, so the
+    // connect latency of a rack is that of its slowest unit instead of the sum.
+    // Each started device then gets its own PacketAcquisition worker, pinned to
+    // its core from the settings. The library has to be initialized and the
+    // handle opened before; close undoes everything the session did.
+    class MultiDeviceSession
+    {
+    public:
+        MultiDeviceSession(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Handle* handle, const MultiDeviceSettings& settings = MultiDeviceSettings());
+        ~MultiDeviceSession();
+
+        MultiDeviceSession(const MultiDeviceSession&) = delete;
+        MultiDeviceSession& operator=(const MultiDeviceSession&) = delete;
+
+        // Rescans, enumerates and starts all devices. AARTSAAPI_OK if at least
+        // one device started, the status of every device tells about the rest.
+        // Fails with AARTSAAPI_RETRY if the rescan does not finish.
+        AARTSAAPI_Result open();
+
+        // Starts the acquisition workers of the started devices
+        bool startAcquisition();
+        void stopAcquisition();
+
+        // Stops, disconnects and closes all devices
+        void close();
+
+        size_t size() const { return m_devices.size(); }
+        SessionDevice& device(size_t index) { return *m_devices[index]; }
+        PacketAcquisition* acquisition(size_t index) { return m_devices[index]->acquisition.get(); }
+
+        MultiDeviceStatistics statistics() const;
+
+    private:
+        void bringUp(SessionDevice& dev);
+
+        AaroniaRtsaSdkWrapper& m_sdkWrapper;
+        AARTSAAPI_Handle* m_handle;
+        MultiDeviceSettings m_settings;
+        std::vector<std::unique_ptr<SessionDevice>> m_devices;
+        std::mutex m_configureLock;
+    };
+}
+
+#endif
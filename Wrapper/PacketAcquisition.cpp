@@ -0,0 +1,180 @@
+#include "PacketAcquisition.h"
+#include "AaroniaRtsaSdkWrapper.h"
+#include "PacketDistributor.h"
+#include <cstring>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // How long the acquisition thread waits before it checks for a stop
+        const std::chrono::milliseconds StopCheckInterval(100);
+
+        // Packets between two reads of the thread's context switch counters
+        const uint64_t SwitchSampleInterval = 1024;
+    }
+
+    PacketAcquisition::PacketAcquisition(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, int32_t channel,
+        const PacketAcquisitionSettings& settings)
+        : m_sdkWrapper(sdkWrapper), m_device(dhandle), m_channel(channel), m_settings(settings), m_ring(settings.ringPackets),
+          m_running(false), m_packets(0), m_overruns(0), m_hardwareGaps(0), m_highWater(0), m_lastError(AARTSAAPI_OK),
+          m_policyApplied(false), m_voluntarySwitches(0), m_involuntarySwitches(0)
+    {
+        for (size_t i = 0; i < m_ring.capacity(); i++)
+            m_ring.slot(i).payload.reserve(m_settings.reserveFloats);
+    }
+
+    PacketAcquisition::~PacketAcquisition()
+    {
+        stop();
+    }
+
+    bool PacketAcquisition::start()
+    {
+        if (m_thread.joinable())
+            return false;
+
+        m_stop.reset();
+        m_lastError.store(AARTSAAPI_OK);
+        m_running.store(true, std::memory_order_release);
+        m_thread = std::thread(&PacketAcquisition::run, this);
+        return true;
+    }
+
+    void PacketAcquisition::stop()
+    {
+        m_stop.cancel();
+        if (m_thread.joinable())
+            m_thread.join();
+        m_running.store(false, std::memory_order_release);
+    }
+
+    void PacketAcquisition::run()
+    {
+        m_policyApplied.store(Succeeded(ApplyThreadPolicy(m_settings.thread)), std::memory_order_relaxed);
+
+        PacketWaiter waiter(m_settings.wait);
+        AARTSAAPI_Packet packet;
+        bool first = true, overrun = false;
+        if (m_settings.distributor)
+            m_settings.distributor->begin();
+
+        while (!m_stop.cancelled())
+        {
+            AARTSAAPI_Result res = m_sdkWrapper.WaitPacket(m_device, m_channel, &packet, waiter, StopCheckInterval, &m_stop);
+            if (res == AARTSAAPI_EMPTY)
+                continue;
+            if (res != AARTSAAPI_OK)
+            {
+                m_lastError.store(res);
+                break;
+            }
+
+            uint64_t packets = m_packets.load(std::memory_order_relaxed) + 1;
+            m_packets.store(packets, std::memory_order_relaxed);
+            if (packets % SwitchSampleInterval == 0)
+                sampleSwitches();
+            if (!first && (packet.flags & AARTSAAPI_PACKET_SEGMENT_START))
+                m_hardwareGaps.store(m_hardwareGaps.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            first = false;
+            if (m_settings.monitor)
+                m_settings.monitor->check(packet);
+
+            if (m_settings.distributor)
+            {
+                // The consumer queues apply their own policies
+                m_settings.distributor->deliver(packet, &m_stop);
+            }
+            else
+            {
+                AcquiredPacket* slot = m_ring.reserve();
+                if (!slot)
+                {
+                    m_overruns.store(m_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    overrun = true;
+                }
+                else
+                {
+                    size_t floats = size_t(PacketPayloadFloats(packet));
+                    slot->payload.resize(floats);
+                    if (floats)
+                        std::memcpy(slot->payload.data(), packet.fp32, floats * sizeof(float));
+
+                    slot->packet = packet;
+                    slot->packet.fp32 = floats ? slot->payload.data() : nullptr;
+                    if (overrun)
+                        slot->packet.flags |= AARTSAAPI_PACKET_SEGMENT_START;
+                    overrun = false;
+                    m_ring.commit();
+
+                    size_t occupancy = m_ring.size();
+                    if (occupancy > m_highWater.load(std::memory_order_relaxed))
+                        m_highWater.store(occupancy, std::memory_order_relaxed);
+                }
+            }
+
+            // The SDK slot is returned whether or not the packet fit into the ring
+            m_sdkWrapper.ConsumePackets(m_device, m_channel, 1);
+        }
+
+        sampleSwitches();
+        if (m_settings.distributor)
+            m_settings.distributor->end();
+        m_running.store(false, std::memory_order_release);
+    }
+
+    void PacketAcquisition::sampleSwitches()
+    {
+        ThreadSwitches switches = CurrentThreadSwitches();
+        m_voluntarySwitches.store(switches.voluntary, std::memory_order_relaxed);
+        m_involuntarySwitches.store(switches.involuntary, std::memory_order_relaxed);
+    }
+
+    const AARTSAAPI_Packet* PacketAcquisition::front()
+    {
+        AcquiredPacket* slot = m_ring.front();
+        return slot ? &slot->packet : nullptr;
+    }
+
+    void PacketAcquisition::release()
+    {
+        m_ring.pop();
+    }
+
+    AARTSAAPI_Result PacketAcquisition::wait(const AARTSAAPI_Packet** packet, PacketWaiter& waiter,
+        std::chrono::nanoseconds timeout, const CancelToken* cancel)
+    {
+        return waiter.wait([&]() -> AARTSAAPI_Result
+            {
+                *packet = front();
+                if (*packet)
+                    return AARTSAAPI_OK;
+                if (!running())
+                {
+                    // The thread may have committed its last packet before it ended
+                    *packet = front();
+                    if (*packet)
+                        return AARTSAAPI_OK;
+                    return m_lastError.load() != AARTSAAPI_OK ? m_lastError.load() : AARTSAAPI_IDLE;
+                }
+                return AARTSAAPI_EMPTY;
+            }, timeout, cancel);
+    }
+
+    PacketAcquisitionStatistics PacketAcquisition::statistics() const
+    {
+        PacketAcquisitionStatistics stats;
+        stats.packets = m_packets.load(std::memory_order_relaxed);
+        stats.overruns = m_overruns.load(std::memory_order_relaxed);
+        stats.hardwareGaps = m_hardwareGaps.load(std::memory_order_relaxed);
+        stats.occupancy = m_ring.size();
+        stats.highWater = m_highWater.load(std::memory_order_relaxed);
+        stats.capacity = m_ring.capacity();
+        stats.lastError = m_lastError.load();
+        stats.policyApplied = m_policyApplied.load(std::memory_order_relaxed);
+        stats.threadSwitches.voluntary = m_voluntarySwitches.load(std::memory_order_relaxed);
+        stats.threadSwitches.involuntary = m_involuntarySwitches.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef PACKETACQUISITION_H
+#define PACKETACQUISITION_H
+
+#include "ContinuityMonitor.h"
+#include "PacketWait.h"
+#include "SpscRing.h"
+#include "ThreadPolicy.h"
+#include <aaroniartsaapi.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    class AaroniaRtsaSdkWrapper;
+    class PacketDistributor;
+
+    // Packet copied out of the SDK queue, fp32 of the header points into payload
+    struct AcquiredPacket
+    {
+        AARTSAAPI_Packet packet;
+        std::vector<float> payload;
+    };
+
+    struct PacketAcquisitionSettings
+    {
+        size_t ringPackets;             // ring capacity, rounded up to a power of two
+        size_t reserveFloats;           // payload floats preallocated per slot, grown on demand
+        ThreadPolicy thread;            // core, priority and memory locking of the acquisition thread
+        PacketWaitSettings wait;        // how the acquisition thread waits for the SDK
+        ContinuityMonitor* monitor;     // checks every packet taken from the SDK, nullptr for none
+        PacketDistributor* distributor; // takes every packet instead of the ring (then set ringPackets to 1), nullptr for none
+
+        PacketAcquisitionSettings()
+            : ringPackets(256), reserveFloats(2 * 1024), wait(PacketWaitPolicy::Adaptive), monitor(nullptr), distributor(nullptr)
+        {
+        }
+    };
+
+    struct PacketAcquisitionStatistics
+    {
+        uint64_t packets;               // taken from the SDK
+        uint64_t overruns;              // dropped because the ring was full, host side loss
+        uint64_t hardwareGaps;          // segment starts set by the SDK after the first packet, device side loss
+        size_t occupancy;               // packets in the ring
+        size_t highWater;               // largest occupancy seen
+        size_t capacity;
+        AARTSAAPI_Result lastError;     // error that ended the acquisition thread, AARTSAAPI_OK otherwise
+        bool policyApplied;             // the thread policy took effect completely
+        ThreadSwitches threadSwitches;  // of the acquisition thread, updated every 1024 packets
+    };
+
+    // Pulls the packets of one channel on a dedicated thread, copies them into a
+    // preallocated single producer, single consumer ring and returns the SDK slot
+    // right away, so a slow consumer fills the ring instead of the SDK queue. When
+    // the ring is full the packet is dropped, counted as overrun, and the next
+    // packet in the ring is marked with AARTSAAPI_PACKET_SEGMENT_START.
+    class PacketAcquisition
+    {
+    public:
+        PacketAcquisition(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, int32_t channel,
+            const PacketAcquisitionSettings& settings = PacketAcquisitionSettings());
+        ~PacketAcquisition();
+
+        PacketAcquisition(const PacketAcquisition&) = delete;
+        PacketAcquisition& operator=(const PacketAcquisition&) = delete;
+
+        // The device has to be started before
+        bool start();
+        void stop();
+        bool running() const { return m_running.load(std::memory_order_acquire); }
+
+        // Consumer side, one thread only. The packet stays valid until release.
+        const AARTSAAPI_Packet* front();
+        void release();
+
+        // Waits for front with the policy of waiter. AARTSAAPI_EMPTY on timeout or
+        // cancellation, AARTSAAPI_IDLE once stopped and drained, or the error that
+        // ended the acquisition thread.
+        AARTSAAPI_Result wait(const AARTSAAPI_Packet** packet, PacketWaiter& waiter,
+            std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max(), const CancelToken* cancel = nullptr);
+
+        PacketAcquisitionStatistics statistics() const;
+
+    private:
+        void run();
+        void sampleSwitches();
+
+        AaroniaRtsaSdkWrapper& m_sdkWrapper;
+        AARTSAAPI_Device* m_device;
+        int32_t m_channel;
+        PacketAcquisitionSettings m_settings;
+        SpscRing<AcquiredPacket> m_ring;
+        std::thread m_thread;
+        CancelToken m_stop;
+        std::atomic<bool> m_running;
+
+        std::atomic<uint64_t> m_packets, m_overruns, m_hardwareGaps;
+        std::atomic<size_t> m_highWater;
+        std::atomic<AARTSAAPI_Result> m_lastError;
+        std::atomic<bool> m_policyApplied;
+        std::atomic<uint64_t> m_voluntarySwitches, m_involuntarySwitches;
+    };
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include "PacketBatch.h"
+#include "AaroniaRtsaSdkWrapper.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace AarRtsaSdkWrapper
+{
+
+    PacketBatchReader::PacketBatchReader(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, int32_t channel,
+        const PacketBatchSettings& settings)
+        : m_sdkWrapper(sdkWrapper), m_device(dhandle), m_channel(channel), m_settings(settings), m_waiter(settings.wait),
+          m_fillWaiter(PacketWaitPolicy::Yield), m_batches(0), m_packetsRead(0)
+    {
+        if (m_settings.maxPackets < 1)
+            m_settings.maxPackets = 1;
+        m_packets.reserve(m_settings.maxPackets);
+    }
+
+    AARTSAAPI_Result PacketBatchReader::retire()
+    {
+        if (m_packets.empty())
+            return AARTSAAPI_OK;
+        AARTSAAPI_Result res = m_sdkWrapper.ConsumePackets(m_device, m_channel, int32_t(m_packets.size()));
+        m_packets.clear();
+        return res;
+    }
+
+    AARTSAAPI_Result PacketBatchReader::next(std::chrono::nanoseconds timeout, const CancelToken* cancel)
+    {
+        AARTSAAPI_Result res = retire();
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        const int32_t maxPackets = int32_t(std::min<size_t>(m_settings.maxPackets, INT32_MAX));
+        int32_t queued = 0;
+        auto poll = [&](int32_t wanted) -> AARTSAAPI_Result
+            {
+                AARTSAAPI_Result avail = m_sdkWrapper.AvailPackets(m_device, m_channel, &queued);
+                if (avail != AARTSAAPI_OK)
+                    return avail;
+                return queued >= wanted ? AARTSAAPI_OK : AARTSAAPI_EMPTY;
+            };
+
+        // Skip the waiter while the consumer is behind and packets are queued
+        if ((res = poll(1)) == AARTSAAPI_EMPTY)
+            res = m_waiter.wait([&]() { return poll(1); }, timeout, cancel);
+        if (res != AARTSAAPI_OK)
+            return res;
+
+        // Give the batch up to maxLatency to fill, a timeout here just ends the batch
+        if (queued < maxPackets && m_settings.maxLatency > std::chrono::nanoseconds::zero())
+        {
+            res = m_fillWaiter.wait([&]() { return poll(maxPackets); }, m_settings.maxLatency, cancel);
+            if (res != AARTSAAPI_OK && res != AARTSAAPI_EMPTY)
+                return res;
+        }
+
+        int32_t count = std::min(queued, maxPackets);
+        m_packets.resize(size_t(count));
+        for (int32_t i = 0; i < count; i++)
+        {
+            AARTSAAPI_Packet& packet = m_packets[size_t(i)];
+            if ((res = m_sdkWrapper.GetPacket(m_device, m_channel, i, &packet)) != AARTSAAPI_OK)
+            {
+                m_packets.resize(size_t(i));
+                if (i == 0)
+                    return res;
+                break;
+            }
+        }
+
+        m_batches++;
+        m_packetsRead += m_packets.size();
+        return AARTSAAPI_OK;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef PACKETBATCH_H
+#define PACKETBATCH_H
+
+#include "PacketWait.h"
+#include <aaroniartsaapi.h>
+#include <span>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    class AaroniaRtsaSdkWrapper;
+
+    struct PacketBatchSettings
+    {
+        size_t maxPackets;                      // largest batch
+        std::chrono::nanoseconds maxLatency;    // how long a queued packet may wait for the batch to fill, 0 takes what is queued
+        PacketWaitSettings wait;                // waiting for the first packet of a batch
+
+        PacketBatchSettings()
+            : maxPackets(64), maxLatency(0), wait(PacketWaitPolicy::Adaptive)
+        {
+        }
+    };
+
+    // Reads the packets of one channel in batches: AvailPackets, GetPacket of the
+    // indices 0..N-1 and one ConsumePackets(N) for the whole batch, instead of a
+    // GetPacket and ConsumePackets pair per packet. The packets of a batch point
+    // into the SDK queue and stay valid until the batch is retired.
+    class PacketBatchReader
+    {
+    public:
+        PacketBatchReader(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, int32_t channel,
+            const PacketBatchSettings& settings = PacketBatchSettings());
+
+        // Retires the current batch and fetches the next one. AARTSAAPI_EMPTY on
+        // timeout or cancellation, then the batch is empty.
+        AARTSAAPI_Result next(std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max(), const CancelToken* cancel = nullptr);
+
+        std::span<const AARTSAAPI_Packet> packets() const { return std::span<const AARTSAAPI_Packet>(m_packets.data(), m_packets.size()); }
+
+        // Consumes the packets of the current batch, called by next as well
+        AARTSAAPI_Result retire();
+
+        const PacketWaiter& waiter() const { return m_waiter; }
+        uint64_t batches() const { return m_batches; }
+        uint64_t packetsRead() const { return m_packetsRead; }
+
+    private:
+        AaroniaRtsaSdkWrapper& m_sdkWrapper;
+        AARTSAAPI_Device* m_device;
+        int32_t m_channel;
+        PacketBatchSettings m_settings;
+        PacketWaiter m_waiter;
+        PacketWaiter m_fillWaiter;
+        std::vector<AARTSAAPI_Packet> m_packets;
+        uint64_t m_batches, m_packetsRead;
+    };
+}
+
+#endif
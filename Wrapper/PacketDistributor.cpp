@@ -0,0 +1,185 @@
+#include "PacketDistributor.h"
+#include "PacketRecording.h"
+#include <cstring>
+
+namespace AarRtsaSdkWrapper
+{
+
+    PacketConsumer::PacketConsumer(const PacketConsumerSettings& settings, const std::atomic<bool>& producing)
+        : m_settings(settings), m_producing(producing), m_first(0), m_count(0), m_held(None), m_gap(false),
+          m_offered(0), m_queued(0), m_read(0), m_droppedOldest(0), m_droppedNewest(0), m_decimated(0), m_highWater(0), m_blocked(0),
+          m_phase(0), m_blockWaiter(PacketWaitPolicy::Yield)
+    {
+        if (m_settings.queuePackets < 1)
+            m_settings.queuePackets = 1;
+        if (m_settings.decimation < 1)
+            m_settings.decimation = 1;
+
+        m_buffers.resize(m_settings.queuePackets + 1);
+        m_free.reserve(m_buffers.size());
+        for (size_t i = m_buffers.size(); i-- > 0;)
+        {
+            m_buffers[i].payload.reserve(m_settings.reserveFloats);
+            m_free.push_back(i);
+        }
+        m_queue.resize(m_settings.queuePackets);
+        m_space.store(m_settings.queuePackets, std::memory_order_relaxed);
+    }
+
+    bool PacketConsumer::offer(const AARTSAAPI_Packet& packet, const CancelToken* stop)
+    {
+        const size_t capacity = m_queue.size();
+        const bool keep = m_settings.policy != BackpressurePolicy::Decimate || m_phase++ % m_settings.decimation == 0;
+
+        // Block waits outside the lock until the consumer made room
+        if (keep && m_settings.policy == BackpressurePolicy::Block && m_space.load(std::memory_order_acquire) == 0)
+        {
+            auto start = std::chrono::steady_clock::now();
+            AARTSAAPI_Result res = m_blockWaiter.wait([&]()
+                {
+                    return m_space.load(std::memory_order_acquire) > 0 ? AARTSAAPI_OK : AARTSAAPI_EMPTY;
+                }, std::chrono::nanoseconds::max(), stop);
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_blocked += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            if (res != AARTSAAPI_OK)
+            {
+                m_offered++;
+                m_droppedNewest++;
+                m_gap = true;
+                return false;
+            }
+        }
+
+        size_t buffer;
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_offered++;
+            if (!keep)
+            {
+                m_decimated++;
+                m_gap = true;
+                return true;
+            }
+            if (m_count == capacity)
+            {
+                if (m_settings.policy != BackpressurePolicy::DropOldest)
+                {
+                    m_droppedNewest++;
+                    m_gap = true;
+                    return true;
+                }
+
+                m_free.push_back(m_queue[m_first]);
+                m_first = (m_first + 1) % capacity;
+                m_count--;
+                m_droppedOldest++;
+                if (m_count)
+                    m_buffers[m_queue[m_first]].packet.flags |= AARTSAAPI_PACKET_SEGMENT_START;
+                else
+                    m_gap = true;
+            }
+            buffer = m_free.back();
+            m_free.pop_back();
+        }
+
+        // Only the producer touches a buffer taken from the free list
+        AcquiredPacket& slot = m_buffers[buffer];
+        size_t floats = size_t(PacketPayloadFloats(packet));
+        slot.payload.resize(floats);
+        if (floats)
+            std::memcpy(slot.payload.data(), packet.fp32, floats * sizeof(float));
+        slot.packet = packet;
+        slot.packet.fp32 = floats ? slot.payload.data() : nullptr;
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_gap)
+            slot.packet.flags |= AARTSAAPI_PACKET_SEGMENT_START;
+        m_gap = false;
+        m_queue[(m_first + m_count) % capacity] = buffer;
+        m_count++;
+        m_queued++;
+        if (m_count > m_highWater)
+            m_highWater = m_count;
+        m_space.store(capacity - m_count, std::memory_order_release);
+        return true;
+    }
+
+    const AARTSAAPI_Packet* PacketConsumer::front()
+    {
+        if (m_held != None)
+            return &m_buffers[m_held].packet;
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_count == 0)
+            return nullptr;
+        m_held = m_queue[m_first];
+        m_first = (m_first + 1) % m_queue.size();
+        m_count--;
+        m_space.store(m_queue.size() - m_count, std::memory_order_release);
+        return &m_buffers[m_held].packet;
+    }
+
+    void PacketConsumer::release()
+    {
+        if (m_held == None)
+            return;
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_free.push_back(m_held);
+        m_held = None;
+        m_read++;
+    }
+
+    AARTSAAPI_Result PacketConsumer::wait(const AARTSAAPI_Packet** packet, PacketWaiter& waiter,
+        std::chrono::nanoseconds timeout, const CancelToken* cancel)
+    {
+        return waiter.wait([&]() -> AARTSAAPI_Result
+            {
+                *packet = front();
+                if (*packet)
+                    return AARTSAAPI_OK;
+                if (!m_producing.load(std::memory_order_acquire))
+                {
+                    // The producer may have queued its last packet before it ended
+                    *packet = front();
+                    return *packet ? AARTSAAPI_OK : AARTSAAPI_IDLE;
+                }
+                return AARTSAAPI_EMPTY;
+            }, timeout, cancel);
+    }
+
+    PacketConsumerStatistics PacketConsumer::statistics() const
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        PacketConsumerStatistics stats;
+        stats.offered = m_offered;
+        stats.queued = m_queued;
+        stats.read = m_read;
+        stats.droppedOldest = m_droppedOldest;
+        stats.droppedNewest = m_droppedNewest;
+        stats.decimated = m_decimated;
+        stats.blockedSeconds = std::chrono::duration<double>(m_blocked).count();
+        stats.occupancy = m_count;
+        stats.highWater = m_highWater;
+        stats.capacity = m_queue.size();
+        return stats;
+    }
+
+    PacketDistributor::PacketDistributor()
+        : m_producing(true)
+    {
+    }
+
+    PacketConsumer& PacketDistributor::addConsumer(const PacketConsumerSettings& settings)
+    {
+        m_consumers.emplace_back(new PacketConsumer(settings, m_producing));
+        return *m_consumers.back();
+    }
+
+    bool PacketDistributor::deliver(const AARTSAAPI_Packet& packet, const CancelToken* stop)
+    {
+        bool delivered = true;
+        for (std::unique_ptr<PacketConsumer>& consumer : m_consumers)
+            delivered = consumer->offer(packet, stop) && delivered;
+        return delivered;
+    }
+}
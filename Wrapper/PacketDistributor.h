@@ -0,0 +1,126 @@
+#ifndef PACKETDISTRIBUTOR_H
+#define PACKETDISTRIBUTOR_H
+
+#include "PacketAcquisition.h"
+#include <memory>
+#include <mutex>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // What happens to a packet for a consumer whose queue is full
+    enum class BackpressurePolicy
+    {
+        Block,          // the producer waits for space, the SDK queue takes up the slack
+        DropOldest,     // the oldest queued packet makes room, the consumer stays current
+        DropNewest,     // the new packet is discarded, the queue keeps its order
+        Decimate        // only every Nth packet is queued at all, the rest as DropNewest
+    };
+
+    struct PacketConsumerSettings
+    {
+        size_t queuePackets;            // packets queued for the consumer
+        BackpressurePolicy policy;
+        uint32_t decimation;            // Decimate: queue one packet out of this many
+        size_t reserveFloats;           // payload floats preallocated per buffer, grown on demand
+
+        PacketConsumerSettings(BackpressurePolicy policy = BackpressurePolicy::Block, size_t queuePackets = 256, uint32_t decimation = 1)
+            : queuePackets(queuePackets), policy(policy), decimation(decimation), reserveFloats(2 * 1024)
+        {
+        }
+    };
+
+    // Every packet offered to a consumer ends up in exactly one of queued,
+    // decimated, droppedNewest; queued ones are later either read or droppedOldest
+    struct PacketConsumerStatistics
+    {
+        uint64_t offered;
+        uint64_t queued;
+        uint64_t read;                  // released by the consumer
+        uint64_t droppedOldest, droppedNewest, decimated;
+        double blockedSeconds;          // the producer spent waiting for this consumer
+        size_t occupancy, highWater, capacity;
+    };
+
+    // Queue of one consumer of a PacketDistributor, with its own backpressure
+    // policy. Packets are copied into preallocated buffers, the consumer reads
+    // them in place like from PacketAcquisition. The first packet after packets
+    // were discarded carries AARTSAAPI_PACKET_SEGMENT_START.
+    class PacketConsumer
+    {
+    public:
+        PacketConsumer(const PacketConsumerSettings& settings, const std::atomic<bool>& producing);
+
+        PacketConsumer(const PacketConsumer&) = delete;
+        PacketConsumer& operator=(const PacketConsumer&) = delete;
+
+        // Consumer side, one thread only. The packet stays valid until release.
+        const AARTSAAPI_Packet* front();
+        void release();
+
+        // AARTSAAPI_EMPTY on timeout or cancellation, AARTSAAPI_IDLE once the
+        // producer ended and the queue is drained
+        AARTSAAPI_Result wait(const AARTSAAPI_Packet** packet, PacketWaiter& waiter,
+            std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max(), const CancelToken* cancel = nullptr);
+
+        PacketConsumerStatistics statistics() const;
+
+        const PacketConsumerSettings& settings() const { return m_settings; }
+
+        // Producer side, false if a Block wait was cancelled
+        bool offer(const AARTSAAPI_Packet& packet, const CancelToken* stop);
+
+    private:
+        static const size_t None = SIZE_MAX;
+
+        PacketConsumerSettings m_settings;
+        const std::atomic<bool>& m_producing;
+        std::vector<AcquiredPacket> m_buffers;  // queue capacity + 1, one is filled or read
+        mutable std::mutex m_lock;
+
+        // Under m_lock: queued buffer indices as a ring, free buffers and counters
+        std::vector<size_t> m_queue;
+        size_t m_first, m_count;
+        std::vector<size_t> m_free;
+        size_t m_held;                          // buffer the consumer reads, None without
+        bool m_gap;                             // mark the next queued packet
+        uint64_t m_offered, m_queued, m_read, m_droppedOldest, m_droppedNewest, m_decimated;
+        size_t m_highWater;
+        std::chrono::nanoseconds m_blocked;
+
+        std::atomic<size_t> m_space;            // free queue entries, polled by a blocked producer
+        uint64_t m_phase;                       // producer only, decimation counter
+        PacketWaiter m_blockWaiter;             // producer only
+    };
+
+    // Hands each packet of one stream to any number of consumers, each with its
+    // own queue and backpressure policy, so a display can drop or decimate while
+    // a recorder on the same stream gets every packet. Set as the distributor of
+    // a PacketAcquisition, or call deliver from any single producer thread.
+    // Consumers are added before the first packet.
+    class PacketDistributor
+    {
+    public:
+        PacketDistributor();
+
+        PacketConsumer& addConsumer(const PacketConsumerSettings& settings);
+
+        size_t consumers() const { return m_consumers.size(); }
+        PacketConsumer& consumer(size_t index) { return *m_consumers[index]; }
+
+        // Offers the packet to every consumer in the order they were added. A
+        // blocking consumer holds up all others, false if stop ended such a wait.
+        bool deliver(const AARTSAAPI_Packet& packet, const CancelToken* stop = nullptr);
+
+        // The producer starts and ends, consumers report AARTSAAPI_IDLE once the
+        // producer ended and their queue is empty
+        void begin() { m_producing.store(true, std::memory_order_release); }
+        void end() { m_producing.store(false, std::memory_order_release); }
+
+    private:
+        std::vector<std::unique_ptr<PacketConsumer>> m_consumers;
+        std::atomic<bool> m_producing;
+    };
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include "PacketRecording.h"
+#include <algorithm>
+#include <cstring>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const char RecordingMagic[8] = { 'A', 'A', 'R', 'P', 'K', 'T', 'R', 'C' };
+        // Version 2 added packed payloads, version 1 recordings read unchanged
+        const uint32_t RecordingFormatVersion = 2;
+
+        // Guards against allocating garbage sizes from a damaged file
+        const uint64_t MaxRecordFloats = uint64_t(1) << 28;
+
+        struct RecordingFileHeader
+        {
+            char magic[8];
+            uint32_t formatVersion;
+            uint32_t deviceTypeLength;
+        };
+    }
+
+    PacketRecorder::PacketRecorder()
+        : m_packets(0), m_bytes(0), m_format(PackedIqFormat::Float32), m_blockFloats(DefaultPackedIqBlockFloats)
+    {
+    }
+
+    PacketRecorder::~PacketRecorder()
+    {
+        close();
+    }
+
+    bool PacketRecorder::open(const std::string& fileName, const std::string& deviceType)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_file.is_open())
+            m_file.close();
+
+        m_file.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!m_file)
+            return false;
+
+        RecordingFileHeader header;
+        std::memcpy(header.magic, RecordingMagic, sizeof(header.magic));
+        header.formatVersion = RecordingFormatVersion;
+        header.deviceTypeLength = uint32_t(deviceType.size());
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_file.write(deviceType.data(), deviceType.size());
+
+        m_recordedAhead.clear();
+        m_packets = 0;
+        m_bytes = sizeof(header) + deviceType.size();
+        return bool(m_file);
+    }
+
+    void PacketRecorder::close()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_file.is_open())
+            m_file.close();
+        m_recordedAhead.clear();
+    }
+
+    void PacketRecorder::setPayloadFormat(PackedIqFormat format, size_t blockFloats)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_format = format;
+        m_blockFloats = std::min<size_t>(std::max<size_t>(1, blockFloats), UINT16_MAX);
+    }
+
+    void PacketRecorder::record(int32_t channel, const AARTSAAPI_Packet& packet)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_file.is_open() || channel < 0)
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_packets == 0)
+            m_firstPacket = now;
+
+        PacketRecord record;
+        record.channel = channel;
+        record.payloadFormat = 0;
+        record.blockFloats = 0;
+        record.captureTime = std::chrono::duration<double>(now - m_firstPacket).count();
+        record.flags = packet.flags;
+        record.startTime = packet.startTime;
+        record.endTime = packet.endTime;
+        record.startFrequency = packet.startFrequency;
+        record.stepFrequency = packet.stepFrequency;
+        record.spanFrequency = packet.spanFrequency;
+        record.rbwFrequency = packet.rbwFrequency;
+        record.num = packet.num;
+        record.size = packet.size;
+        record.stride = packet.stride;
+        record.floats = PacketPayloadFloats(packet);
+
+        uint64_t payloadBytes = record.floats * sizeof(float);
+        if (m_format != PackedIqFormat::Float32 && record.floats)
+        {
+            PackIqPacket(packet, m_format, m_packed, m_blockFloats);
+            record.payloadFormat = uint16_t(m_format);
+            record.blockFloats = uint16_t(m_blockFloats);
+            record.stride = record.size;
+            record.floats = uint64_t(record.num * record.size);
+            payloadBytes = m_packed.bytes();
+        }
+
+        m_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        if (record.payloadFormat)
+        {
+            m_file.write(reinterpret_cast<const char*>(m_packed.scales.data()), std::streamsize(m_packed.scales.size() * sizeof(float)));
+            m_file.write(reinterpret_cast<const char*>(m_packed.values.data()), std::streamsize(m_packed.values.size()));
+        }
+        else if (record.floats)
+        {
+            m_file.write(reinterpret_cast<const char*>(packet.fp32), std::streamsize(payloadBytes));
+        }
+
+        if (size_t(channel) >= m_recordedAhead.size())
+            m_recordedAhead.resize(size_t(channel) + 1, 0);
+        m_recordedAhead[size_t(channel)]++;
+        m_packets++;
+        m_bytes += sizeof(record) + payloadBytes;
+    }
+
+    int32_t PacketRecorder::recordedAhead(int32_t channel)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        return channel >= 0 && size_t(channel) < m_recordedAhead.size() ? m_recordedAhead[size_t(channel)] : 0;
+    }
+
+    void PacketRecorder::consumed(int32_t channel, int32_t num)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (channel < 0 || size_t(channel) >= m_recordedAhead.size())
+            return;
+        int32_t& ahead = m_recordedAhead[size_t(channel)];
+        ahead = num < ahead ? ahead - num : 0;
+    }
+
+    bool PacketRecordingReader::open(const std::string& fileName)
+    {
+        if (m_file.is_open())
+            m_file.close();
+        m_deviceType.clear();
+
+        m_file.open(fileName, std::ios::binary);
+        if (!m_file)
+            return false;
+
+        RecordingFileHeader header;
+        if (!m_file.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || std::memcmp(header.magic, RecordingMagic, sizeof(header.magic)) != 0
+            || header.formatVersion < 1 || header.formatVersion > RecordingFormatVersion
+            || header.deviceTypeLength > 256)
+        {
+            m_file.close();
+            return false;
+        }
+
+        m_deviceType.resize(header.deviceTypeLength);
+        if (!m_file.read(&m_deviceType[0], m_deviceType.size()))
+        {
+            m_file.close();
+            return false;
+        }
+
+        m_firstRecord = m_file.tellg();
+        return true;
+    }
+
+    bool PacketRecordingReader::next(PacketRecord& record, std::vector<float>& payload)
+    {
+        if (!m_file.is_open() || !m_file.read(reinterpret_cast<char*>(&record), sizeof(record)) || record.floats > MaxRecordFloats)
+            return false;
+
+        payload.resize(size_t(record.floats));
+        if (record.payloadFormat == 0)
+            return record.floats == 0 || bool(m_file.read(reinterpret_cast<char*>(payload.data()), std::streamsize(record.floats * sizeof(float))));
+
+        PackedIqFormat format = PackedIqFormat(record.payloadFormat);
+        if ((format != PackedIqFormat::Int16 && format != PackedIqFormat::Int8) || record.blockFloats == 0)
+            return false;
+        m_scales.resize(size_t((record.floats + record.blockFloats - 1) / record.blockFloats));
+        m_values.resize(size_t(record.floats) * PackedIqValueBytes(format));
+        if (!m_file.read(reinterpret_cast<char*>(m_scales.data()), std::streamsize(m_scales.size() * sizeof(float)))
+            || !m_file.read(reinterpret_cast<char*>(m_values.data()), std::streamsize(m_values.size())))
+            return false;
+
+        if (format == PackedIqFormat::Int16)
+            UnpackIqInt16(reinterpret_cast<const int16_t*>(m_values.data()), m_scales.data(), payload.size(), record.blockFloats, payload.data());
+        else
+            UnpackIqInt8(reinterpret_cast<const int8_t*>(m_values.data()), m_scales.data(), payload.size(), record.blockFloats, payload.data());
+        return true;
+    }
+
+    void PacketRecordingReader::rewind()
+    {
+        if (!m_file.is_open())
+            return;
+        m_file.clear();
+        m_file.seekg(m_firstRecord);
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef PACKETRECORDING_H
+#define PACKETRECORDING_H
+
+#include "IqPacking.h"
+#include <aaroniartsaapi.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // On disk layout of one recorded packet, followed by `floats` payload values.
+    // A packed payload is stored as its block scales followed by the integer
+    // values, without stride padding. Recordings use the host byte order.
+    struct PacketRecord
+    {
+        int32_t channel;
+        uint16_t payloadFormat; // PackedIqFormat, 0 for floats
+        uint16_t blockFloats;   // values per scale of a packed payload
+        double captureTime;     // seconds since the first recorded packet
+        uint64_t flags;
+        double startTime, endTime;
+        double startFrequency, stepFrequency, spanFrequency, rbwFrequency;
+        int64_t num, size, stride;
+        uint64_t floats;
+    };
+
+    // Number of floats a packet payload spans
+    inline uint64_t PacketPayloadFloats(const AARTSAAPI_Packet& packet)
+    {
+        if (packet.num <= 0 || packet.size <= 0 || !packet.fp32)
+            return 0;
+        return uint64_t((packet.num - 1) * packet.stride + packet.size);
+    }
+
+    // Writes the packets of one device to a recording file. Used through
+    // AaroniaRtsaSdkWrapper::setPacketRecorder, which records every packet once
+    // when it is first read with GetPacket or consumed unread.
+    class PacketRecorder
+    {
+    public:
+        PacketRecorder();
+        ~PacketRecorder();
+
+        // deviceType as passed to OpenDevice, e.g. "spectranv6/raw"
+        bool open(const std::string& fileName, const std::string& deviceType);
+        void close();
+        bool isOpen() const { return m_file.is_open(); }
+
+        // Stores the payloads of the following packets block scaled as int16 or
+        // int8, meant for the IQ modes. Reading the recording restores floats.
+        void setPayloadFormat(PackedIqFormat format, size_t blockFloats = DefaultPackedIqBlockFloats);
+
+        void record(int32_t channel, const AARTSAAPI_Packet& packet);
+
+        // Packets at the front of a channel queue that are already recorded
+        int32_t recordedAhead(int32_t channel);
+        void consumed(int32_t channel, int32_t num);
+
+        uint64_t packets() const { return m_packets; }
+        uint64_t bytes() const { return m_bytes; }
+
+    private:
+        std::mutex m_lock;
+        std::ofstream m_file;
+        std::vector<int32_t> m_recordedAhead;
+        std::chrono::steady_clock::time_point m_firstPacket;
+        uint64_t m_packets;
+        uint64_t m_bytes;
+        PackedIqFormat m_format;
+        size_t m_blockFloats;
+        PackedIqPacket m_packed;
+    };
+
+    // Sequential reader of a recording file
+    class PacketRecordingReader
+    {
+    public:
+        bool open(const std::string& fileName);
+        bool isOpen() const { return m_file.is_open(); }
+        const std::string& deviceType() const { return m_deviceType; }
+
+        // False at the end of the recording or on a damaged record. Packed
+        // payloads come back as floats, with record.stride == record.size.
+        bool next(PacketRecord& record, std::vector<float>& payload);
+        void rewind();
+
+    private:
+        std::ifstream m_file;
+        std::string m_deviceType;
+        std::streampos m_firstRecord;
+        std::vector<float> m_scales;
+        std::vector<uint8_t> m_values;
+    };
+}
+
+#endif
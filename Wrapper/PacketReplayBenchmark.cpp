@@ -0,0 +1,142 @@
+#include "BenchmarkSupport.h"
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+
+// Records a few seconds of raw IQ packets through the wrapper and replays the
+// recording through the simulated backend as fast as it is read. The replay
+// rate is an upper bound for a consumer of the recorded traffic shape.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    struct ReadStatistics
+    {
+        uint64_t packets = 0;
+        uint64_t samples = 0;
+        double checksum = 0;
+    };
+
+    // Reads channel 0 until `packets` packets arrived or `seconds` passed
+    AARTSAAPI_Result readPackets(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* d, uint64_t packets, double seconds, ReadStatistics& stats)
+    {
+        AARTSAAPI_Packet packet;
+        auto start = std::chrono::steady_clock::now();
+        while (stats.packets < packets && SecondsSince(start) < seconds)
+        {
+            AARTSAAPI_Result res = sdkWrapper.GetPacket(d, 0, 0, &packet);
+            if (res == AARTSAAPI_EMPTY)
+                continue;
+            if (res != AARTSAAPI_OK)
+                return res;
+
+            stats.packets++;
+            stats.samples += uint64_t(packet.num);
+            stats.checksum += packet.fp32 ? packet.fp32[0] : 0.0f;
+            sdkWrapper.ConsumePackets(d, 0, 1);
+        }
+        return AARTSAAPI_OK;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const double recordSeconds = NumberArgument<double>(argc, argv, 2, 2.0);
+    const std::string fileName = argc > 3 ? std::string(argv[3]) : (std::filesystem::temp_directory_path() / "aaronia-replay-benchmark.rec").string();
+
+    // The default recording grows by hundreds of MB a second, remove it on every
+    // way out; a path given by the caller is kept
+    struct RemoveRecording
+    {
+        std::string fileName;
+        ~RemoveRecording()
+        {
+            std::error_code error;
+            if (!fileName.empty())
+                std::filesystem::remove(fileName, error);
+        }
+    } removeRecording{ argc > 3 ? std::string() : fileName };
+
+    // Record
+
+    PacketRecorder recorder;
+    ReadStatistics recorded;
+    {
+        BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+        if (!bench.isOpen() || bench.connectAndStart() != AARTSAAPI_OK)
+            return -1;
+
+        if (!recorder.open(fileName, "spectranv6/raw"))
+        {
+            std::cerr << "Opening " << fileName << " failed" << std::endl;
+            return -1;
+        }
+        sdkWrapper.setPacketRecorder(bench.device(), &recorder);
+
+        AARTSAAPI_Result res = readPackets(sdkWrapper, bench.device(), UINT64_MAX, recordSeconds, recorded);
+        sdkWrapper.setPacketRecorder(nullptr, nullptr);
+        recorder.close();
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "Recording failed: " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+    }
+
+    if (recorded.packets == 0)
+    {
+        std::cerr << "No packets recorded" << std::endl;
+        return -1;
+    }
+
+    // Replay, the simulated backend reads its environment when the device is opened
+
+#if defined(_WIN32)
+    _putenv_s("AARTSAAPI_SIM_REPLAY", fileName.c_str());
+    _putenv_s("AARTSAAPI_SIM_REPLAY_SPEED", "0");
+#else
+    setenv("AARTSAAPI_SIM_REPLAY", fileName.c_str(), 1);
+    setenv("AARTSAAPI_SIM_REPLAY_SPEED", "0", 1);
+#endif
+
+    ReadStatistics replayed;
+    double replayTime;
+    {
+        BenchmarkDevice bench(sdkWrapper, "spectranv6", "raw");
+        if (!bench.isOpen() || bench.connectAndStart() != AARTSAAPI_OK)
+            return -1;
+
+        auto start = std::chrono::steady_clock::now();
+        AARTSAAPI_Result res = readPackets(sdkWrapper, bench.device(), recorded.packets, 60.0, replayed);
+        replayTime = SecondsSince(start);
+        if (res != AARTSAAPI_OK)
+        {
+            std::cerr << "Replay failed: " << sdkWrapper.getErrorString(res) << std::endl;
+            return -1;
+        }
+    }
+
+    // The replay has to deliver exactly the recorded packets
+
+    if (replayed.packets != recorded.packets || replayed.samples != recorded.samples || replayed.checksum != recorded.checksum)
+    {
+        std::cerr << "Replay delivered " << replayed.packets << " of " << recorded.packets << " recorded packets" << std::endl;
+        return -1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "Recording     : " << recorded.packets << " packets, " << recorder.bytes() << " bytes in " << fileName << (argc > 3 ? "" : " (removed)") << std::endl
+        << "Replay        : " << replayed.packets / replayTime << " packets/s, "
+        << replayed.samples / replayTime * 1e-6 << " MS/s" << std::endl
+        << "Speedup       : " << recordSeconds / replayTime << "x realtime" << std::endl;
+
+    return 0;
+}
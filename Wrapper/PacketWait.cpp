@@ -0,0 +1,157 @@
+#include "PacketWait.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define PACKETWAIT_SPIN_PAUSE() _mm_pause()
+#elif defined(__aarch64__)
+#define PACKETWAIT_SPIN_PAUSE() __asm__ __volatile__("yield")
+#else
+#define PACKETWAIT_SPIN_PAUSE() ((void)0)
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Weight of a new interval in the running estimate
+        const double IntervalSmoothing = 1.0 / 8.0;
+
+        // First sleep of a late packet, doubled up to sleepTime
+        const std::chrono::microseconds InitialBackoff(50);
+    }
+
+    PacketWaiter::PacketWaiter(const PacketWaitSettings& settings)
+        : m_settings(settings), m_intervalNs(0), m_backoff(Clock::duration::zero())
+    {
+        resetStatistics();
+    }
+
+    PacketWaitStatistics PacketWaiter::statistics() const
+    {
+        PacketWaitStatistics stats = m_statistics;
+        stats.intervalSeconds = m_intervalNs * 1e-9;
+        stats.meanWakeNs = m_wakeLatency.meanNs();
+        stats.p50WakeNs = m_wakeLatency.percentileNs(0.5);
+        stats.p99WakeNs = m_wakeLatency.percentileNs(0.99);
+        stats.maxWakeNs = m_wakeLatency.maxNs();
+        return stats;
+    }
+
+    void PacketWaiter::resetStatistics()
+    {
+        m_statistics = PacketWaitStatistics();
+        m_wakeLatency.reset();
+    }
+
+    void PacketWaiter::resetInterval()
+    {
+        m_intervalNs = 0;
+        m_lastArrival = Clock::time_point();
+    }
+
+    void PacketWaiter::arrived(Clock::time_point now, Clock::time_point lastEmptyPoll)
+    {
+        if (now == lastEmptyPoll)
+        {
+            // Packet was already queued, the consumer is behind the stream. Such
+            // arrivals say nothing about the packet interval.
+            m_statistics.immediate++;
+            m_lastArrival = now;
+            return;
+        }
+
+        m_wakeLatency.add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastEmptyPoll).count()));
+
+        // The packet got queued after the last empty poll. Taking that earliest
+        // possible time keeps late wakeups from shifting the expected arrivals.
+        if (m_lastArrival != Clock::time_point())
+        {
+            double interval = double(std::chrono::duration_cast<std::chrono::nanoseconds>(lastEmptyPoll - m_lastArrival).count());
+            m_intervalNs = m_intervalNs > 0 ? m_intervalNs + (interval - m_intervalNs) * IntervalSmoothing : interval;
+        }
+        m_lastArrival = lastEmptyPoll;
+    }
+
+    void PacketWaiter::sleep(Clock::time_point now, Clock::duration duration, Clock::time_point deadline)
+    {
+        duration = std::min(duration, std::chrono::duration_cast<Clock::duration>(m_settings.sleepTime));
+        if (deadline - now < duration)
+            duration = deadline - now;
+        m_statistics.sleeps++;
+        std::this_thread::sleep_for(duration);
+    }
+
+    void PacketWaiter::idle(Clock::time_point now, Clock::time_point deadline)
+    {
+        switch (m_settings.policy)
+        {
+        case PacketWaitPolicy::Spin:
+            PACKETWAIT_SPIN_PAUSE();
+            return;
+
+        case PacketWaitPolicy::Yield:
+            m_statistics.yields++;
+            std::this_thread::yield();
+            return;
+
+        case PacketWaitPolicy::Sleep:
+            sleep(now, m_settings.sleepTime, deadline);
+            return;
+
+        case PacketWaitPolicy::Adaptive:
+            break;
+        }
+
+        Clock::duration spin = std::chrono::duration_cast<Clock::duration>(m_settings.spinTime);
+        Clock::duration yield = std::chrono::duration_cast<Clock::duration>(m_settings.yieldTime);
+
+        // Escalation starts at the first empty poll or, with a learned interval,
+        // one spin window before the expected arrival
+        Clock::time_point escalateFrom = m_waitStart;
+
+        if (m_intervalNs > 0)
+        {
+            // Sleep through the interval, leaving the yield window to absorb the
+            // oversleep of the scheduler
+
+            Clock::time_point expected = m_lastArrival + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(int64_t(m_intervalNs)));
+            if (expected - now > spin + yield)
+            {
+                sleep(now, expected - now - spin - yield, deadline);
+                return;
+            }
+            if (expected - now > spin)
+            {
+                m_statistics.yields++;
+                std::this_thread::yield();
+                return;
+            }
+            escalateFrom = std::max(escalateFrom, expected - spin);
+        }
+
+        // Packet is due or the interval is unknown: spin, yield, then back off
+        // with growing sleeps
+
+        Clock::duration late = now - escalateFrom;
+        if (late < 2 * spin)
+        {
+            PACKETWAIT_SPIN_PAUSE();
+            return;
+        }
+        if (late < 2 * spin + yield)
+        {
+            m_statistics.yields++;
+            std::this_thread::yield();
+            return;
+        }
+
+        // Bounded by sleepTime, an unbounded wait would overflow the doubling
+        const Clock::duration cap = std::max(std::chrono::duration_cast<Clock::duration>(m_settings.sleepTime),
+            std::chrono::duration_cast<Clock::duration>(InitialBackoff));
+        m_backoff = m_backoff > Clock::duration::zero() ? std::min(m_backoff * 2, cap) : std::chrono::duration_cast<Clock::duration>(InitialBackoff);
+        sleep(now, m_backoff, deadline);
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef PACKETWAIT_H
+#define PACKETWAIT_H
+
+#include "LatencyHistogram.h"
+#include <aaroniartsaapi.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Set from any thread to end the waits it is passed to
+    class CancelToken
+    {
+    public:
+        CancelToken() : m_cancelled(false) {}
+
+        void cancel() { m_cancelled.store(true, std::memory_order_release); }
+        void reset() { m_cancelled.store(false, std::memory_order_release); }
+        bool cancelled() const { return m_cancelled.load(std::memory_order_acquire); }
+
+    private:
+        std::atomic<bool> m_cancelled;
+    };
+
+    enum class PacketWaitPolicy
+    {
+        Adaptive,   // sleep until shortly before the expected packet, then yield and spin
+        Spin,       // poll back to back, lowest latency at the cost of a core
+        Yield,      // yield the time slice between polls
+        Sleep       // sleep sleepTime between polls, like the sample loops
+    };
+
+    struct PacketWaitSettings
+    {
+        PacketWaitPolicy policy;
+        std::chrono::nanoseconds spinTime;      // adaptive: spin window around the expected arrival
+        std::chrono::nanoseconds yieldTime;     // adaptive: yield window before and after the spin window
+        std::chrono::nanoseconds sleepTime;     // sleep: poll interval, adaptive: longest single sleep
+
+        PacketWaitSettings(PacketWaitPolicy waitPolicy = PacketWaitPolicy::Adaptive)
+            : policy(waitPolicy), spinTime(std::chrono::microseconds(20)), yieldTime(std::chrono::microseconds(200)),
+              sleepTime(waitPolicy == PacketWaitPolicy::Sleep ? std::chrono::microseconds(5000) : std::chrono::microseconds(1000))
+        {
+        }
+    };
+
+    struct PacketWaitStatistics
+    {
+        uint64_t waits;             // calls of wait
+        uint64_t immediate;         // waits whose first poll found a packet
+        uint64_t timeouts, cancelled;
+        uint64_t polls, yields, sleeps;
+        double intervalSeconds;     // estimated time between packets, 0 while unknown
+
+        // Time from the last empty poll to the poll that found the packet, an upper
+        // bound of how late the packet was noticed. Immediate waits are not counted.
+        double meanWakeNs;
+        uint64_t p50WakeNs, p99WakeNs, maxWakeNs;
+    };
+
+    // Waits for the next packet of one channel by polling, e.g. GetPacket until it
+    // stops returning AARTSAAPI_EMPTY. The adaptive policy learns the packet
+    // interval and sleeps through most of it, so the poll rate and the CPU load
+    // follow the stream instead of a fixed sleep. A waiter keeps the state of one
+    // stream and is not thread safe.
+    class PacketWaiter
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        explicit PacketWaiter(const PacketWaitSettings& settings = PacketWaitSettings());
+
+        // Returns the first result of poll other than AARTSAAPI_EMPTY, or
+        // AARTSAAPI_EMPTY on timeout and cancellation. Cancellation is noticed
+        // within one sleepTime.
+        template <typename Poll>
+        AARTSAAPI_Result wait(Poll&& poll, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max(), const CancelToken* cancel = nullptr)
+        {
+            Clock::time_point start = Clock::now();
+            m_statistics.waits++;
+            m_statistics.polls++;
+
+            AARTSAAPI_Result res = poll();
+            if (res != AARTSAAPI_EMPTY)
+            {
+                if (res == AARTSAAPI_OK)
+                    arrived(start, start);
+                return res;
+            }
+
+            Clock::time_point deadline = timeout >= Clock::time_point::max() - start ? Clock::time_point::max() : start + timeout;
+            Clock::time_point polled = Clock::now();
+            m_waitStart = polled;
+            m_backoff = Clock::duration::zero();
+
+            for (;;)
+            {
+                if (cancel && cancel->cancelled())
+                {
+                    m_statistics.cancelled++;
+                    return AARTSAAPI_EMPTY;
+                }
+                if (polled >= deadline)
+                {
+                    m_statistics.timeouts++;
+                    return AARTSAAPI_EMPTY;
+                }
+
+                idle(polled, deadline);
+
+                m_statistics.polls++;
+                res = poll();
+                Clock::time_point now = Clock::now();
+                if (res != AARTSAAPI_EMPTY)
+                {
+                    if (res == AARTSAAPI_OK)
+                        arrived(now, polled);
+                    return res;
+                }
+                polled = now;
+            }
+        }
+
+        const PacketWaitSettings& settings() const { return m_settings; }
+        void setSettings(const PacketWaitSettings& settings) { m_settings = settings; }
+
+        PacketWaitStatistics statistics() const;
+        void resetStatistics();
+
+        // Forget the learned interval, e.g. after a configuration change
+        void resetInterval();
+
+    private:
+        void idle(Clock::time_point now, Clock::time_point deadline);
+        void arrived(Clock::time_point now, Clock::time_point lastEmptyPoll);
+        void sleep(Clock::time_point now, Clock::duration duration, Clock::time_point deadline);
+
+        PacketWaitSettings m_settings;
+        PacketWaitStatistics m_statistics;
+        LatencyHistogram m_wakeLatency;
+        Clock::time_point m_lastArrival;
+        Clock::time_point m_waitStart;
+        double m_intervalNs;
+        Clock::duration m_backoff;
+    };
+}
+
+#endif
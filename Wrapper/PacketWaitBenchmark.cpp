@@ -0,0 +1,90 @@
+#include "BenchmarkSupport.h"
+#include <ctime>
+#include <iomanip>
+
+// Waits for the packets of a 1.5 MS/s IQ stream, about 0.7 ms apart, with each
+// wait policy and reports how late packets are noticed and what the wait costs
+// in polls and CPU time. The fixed 5 ms sleep is the loop of the samples.
+
+using namespace AarRtsaSdkWrapper;
+
+int main(int argc, char* argv[])
+{
+    AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
+    if (!sdkWrapper.isSuccessfullyLoaded())
+    {
+        std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
+        return -1;
+    }
+
+    const int packets = NumberArgument<int>(argc, argv, 2, 1000);
+
+    BenchmarkDevice bench(sdkWrapper, "spectranv6", "iqreceiver");
+    if (!bench.isOpen())
+        return -1;
+
+    AARTSAAPI_Device* d = bench.device();
+    Wrapper_ConfigHandle span;
+    if (sdkWrapper.ConfigResolve(d, "main/spanfreq", &span) != AARTSAAPI_OK || sdkWrapper.ConfigSetFloat(span, 1.0e6) != AARTSAAPI_OK)
+    {
+        std::cerr << "Setting main/spanfreq failed" << std::endl;
+        return -1;
+    }
+    if (bench.connectAndStart() != AARTSAAPI_OK)
+        return -1;
+
+    struct Variant
+    {
+        const char* name;
+        PacketWaitSettings settings;
+    };
+
+    PacketWaitSettings sleep1ms(PacketWaitPolicy::Sleep);
+    sleep1ms.sleepTime = std::chrono::milliseconds(1);
+
+    const Variant variants[] = {
+        { "Sleep 5 ms", PacketWaitSettings(PacketWaitPolicy::Sleep) },
+        { "Sleep 1 ms", sleep1ms },
+        { "Yield", PacketWaitSettings(PacketWaitPolicy::Yield) },
+        { "Spin", PacketWaitSettings(PacketWaitPolicy::Spin) },
+        { "Adaptive", PacketWaitSettings(PacketWaitPolicy::Adaptive) },
+    };
+
+    std::cout << std::left << std::setw(12) << "Policy" << std::right
+        << std::setw(12) << "Polls/pkt" << std::setw(12) << "Sleeps/pkt" << std::setw(12) << "Wake p50"
+        << std::setw(12) << "Wake p99" << std::setw(12) << "Wake max" << std::setw(8) << "CPU" << std::endl;
+
+    AARTSAAPI_Packet packet;
+    for (const Variant& variant : variants)
+    {
+        // Start each policy on an empty queue
+        int32_t queued = 0;
+        if (sdkWrapper.AvailPackets(d, 0, &queued) == AARTSAAPI_OK && queued > 0)
+            sdkWrapper.ConsumePackets(d, 0, queued);
+
+        PacketWaiter waiter(variant.settings);
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < packets; i++)
+        {
+            AARTSAAPI_Result res = sdkWrapper.WaitPacket(d, 0, &packet, waiter, std::chrono::seconds(1));
+            if (res != AARTSAAPI_OK)
+            {
+                std::cerr << "WaitPacket failed: " << sdkWrapper.getErrorString(res) << std::endl;
+                return -1;
+            }
+            DoNotOptimize(packet.startTime);
+            sdkWrapper.ConsumePackets(d, 0, 1);
+        }
+        double wall = SecondsSince(start);
+        double cpu = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        PacketWaitStatistics stats = waiter.statistics();
+        std::cout << std::left << std::setw(12) << variant.name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << double(stats.polls) / packets << std::setw(12) << double(stats.sleeps) / packets
+            << std::setw(9) << stats.p50WakeNs / 1000.0 << " us" << std::setw(9) << stats.p99WakeNs / 1000.0 << " us"
+            << std::setw(9) << stats.maxWakeNs / 1000.0 << " us" << std::setw(7) << cpu / wall * 100.0 << "%" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include "PayloadPool.h"
+#include "PacketRecording.h"
+#include <bit>
+#include <cstring>
+#include <new>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const size_t CacheLine = 64;
+        const size_t Page = 4096;
+
+        size_t alignmentOf(size_t bytes)
+        {
+            return bytes >= Page ? Page : CacheLine;
+        }
+    }
+
+    PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+        : m_pool(other.m_pool), m_block(other.m_block), m_data(other.m_data), m_capacity(other.m_capacity)
+    {
+        other.m_pool = nullptr;
+        other.m_data = nullptr;
+        other.m_capacity = 0;
+    }
+
+    PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_pool = other.m_pool;
+            m_block = other.m_block;
+            m_data = other.m_data;
+            m_capacity = other.m_capacity;
+            other.m_pool = nullptr;
+            other.m_data = nullptr;
+            other.m_capacity = 0;
+        }
+        return *this;
+    }
+
+    void PooledBuffer::reset()
+    {
+        if (m_pool)
+            m_pool->release(m_block);
+        m_pool = nullptr;
+        m_data = nullptr;
+        m_capacity = 0;
+    }
+
+    void PooledPacket::reset()
+    {
+        m_payload.reset();
+        m_packet = AARTSAAPI_Packet();
+    }
+
+    PayloadPool::PayloadPool()
+        : m_blockCount(0)
+    {
+        for (size_t i = 0; i < ClassCount; i++)
+        {
+            m_free[i].store(0, std::memory_order_relaxed);
+            m_hits[i].store(0, std::memory_order_relaxed);
+            m_misses[i].store(0, std::memory_order_relaxed);
+            m_releases[i].store(0, std::memory_order_relaxed);
+            m_blocks[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<Block*>& chunk : m_chunks)
+            chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    PayloadPool::~PayloadPool()
+    {
+        for (uint32_t i = 0; i < m_blockCount; i++)
+        {
+            Block& b = block(i);
+            if (b.arena)
+                continue;
+            size_t bytes = size_t(1) << b.sizeClass;
+            ::operator delete(b.data, std::align_val_t(alignmentOf(bytes)));
+        }
+        for (std::atomic<Block*>& chunk : m_chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    bool PayloadPool::pop(size_t sizeClass, uint32_t& index)
+    {
+        std::atomic<uint64_t>& head = m_free[sizeClass];
+        uint64_t current = head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            uint32_t top = uint32_t(current);
+            if (top == 0)
+                return false;
+
+            // A stale next is harmless, the version makes the exchange fail then
+            uint32_t next = block(top - 1).next.load(std::memory_order_relaxed);
+            uint64_t replacement = ((current >> 32) + 1) << 32 | next;
+            if (head.compare_exchange_weak(current, replacement, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                index = top - 1;
+                return true;
+            }
+        }
+    }
+
+    void PayloadPool::push(uint32_t index)
+    {
+        Block& b = block(index);
+        std::atomic<uint64_t>& head = m_free[b.sizeClass - MinClass];
+        uint64_t current = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            b.next.store(uint32_t(current), std::memory_order_relaxed);
+            uint64_t replacement = ((current >> 32) + 1) << 32 | (index + 1);
+            if (head.compare_exchange_weak(current, replacement, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    bool PayloadPool::grow(size_t sizeClass, uint32_t& index, float* arena)
+    {
+        size_t bytes = size_t(1) << (sizeClass + MinClass);
+        void* data = arena ? arena : ::operator new(bytes, std::align_val_t(alignmentOf(bytes)), std::nothrow);
+        if (!data)
+            return false;
+
+        std::lock_guard<std::mutex> guard(m_growLock);
+        size_t chunk = m_blockCount / ChunkBlocks;
+        if (chunk >= MaxChunks)
+        {
+            if (!arena)
+                ::operator delete(data, std::align_val_t(alignmentOf(bytes)));
+            return false;
+        }
+        if (!m_chunks[chunk].load(std::memory_order_relaxed))
+            m_chunks[chunk].store(new Block[ChunkBlocks], std::memory_order_release);
+
+        index = m_blockCount++;
+        Block& b = block(index);
+        b.data = static_cast<float*>(data);
+        b.sizeClass = uint32_t(sizeClass + MinClass);
+        b.arena = arena != nullptr;
+        b.next.store(0, std::memory_order_relaxed);
+
+        m_blocks[sizeClass].fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    PooledBuffer PayloadPool::acquire(size_t floats)
+    {
+        if (floats == 0)
+            return PooledBuffer();
+
+        size_t bytes = floats * sizeof(float);
+        size_t sizeClass = std::bit_width(bytes - 1);
+        sizeClass = sizeClass < MinClass ? 0 : sizeClass - MinClass;
+        if (sizeClass >= ClassCount)
+            return PooledBuffer();
+
+        uint32_t index;
+        if (pop(sizeClass, index))
+            m_hits[sizeClass].fetch_add(1, std::memory_order_relaxed);
+        else if (grow(sizeClass, index))
+            m_misses[sizeClass].fetch_add(1, std::memory_order_relaxed);
+        else
+            return PooledBuffer();
+
+        Block& b = block(index);
+        return PooledBuffer(this, index, b.data, (size_t(1) << b.sizeClass) / sizeof(float));
+    }
+
+    void PayloadPool::release(uint32_t index)
+    {
+        m_releases[block(index).sizeClass - MinClass].fetch_add(1, std::memory_order_relaxed);
+        push(index);
+    }
+
+    void PayloadPool::reserve(size_t floats, size_t count)
+    {
+        if (floats == 0)
+            return;
+        size_t bytes = floats * sizeof(float);
+        size_t sizeClass = std::bit_width(bytes - 1);
+        sizeClass = sizeClass < MinClass ? 0 : sizeClass - MinClass;
+        if (sizeClass >= ClassCount)
+            return;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t index;
+            if (!grow(sizeClass, index))
+                return;
+            push(index);
+        }
+    }
+
+    StreamingMemoryInfo PayloadPool::reserve(size_t floats, size_t count, const StreamingMemorySettings& memory)
+    {
+        if (floats == 0 || count == 0)
+            return StreamingMemoryInfo();
+        size_t bytes = floats * sizeof(float);
+        size_t sizeClass = std::bit_width(bytes - 1);
+        sizeClass = sizeClass < MinClass ? 0 : sizeClass - MinClass;
+        if (sizeClass >= ClassCount)
+            return StreamingMemoryInfo();
+
+        // The arena is page aligned and the blocks are powers of two, so each keeps
+        // the alignment of a heap allocated block
+        bytes = size_t(1) << (sizeClass + MinClass);
+        StreamingBuffer buffer(bytes * count, memory);
+        if (!buffer)
+            return StreamingMemoryInfo();
+        StreamingMemoryInfo info = buffer.info();
+        char* data = static_cast<char*>(buffer.data());
+        {
+            std::lock_guard<std::mutex> guard(m_growLock);
+            m_arenas.push_back(std::move(buffer));
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t index;
+            if (!grow(sizeClass, index, reinterpret_cast<float*>(data + i * bytes)))
+                break;
+            push(index);
+        }
+        return info;
+    }
+
+    PooledPacket PayloadPool::copy(const AARTSAAPI_Packet& packet)
+    {
+        PooledPacket owned;
+        owned.m_packet = packet;
+
+        size_t floats = size_t(PacketPayloadFloats(packet));
+        owned.m_payload = acquire(floats);
+        if (owned.m_payload)
+            std::memcpy(owned.m_payload.data(), packet.fp32, floats * sizeof(float));
+        else
+            owned.m_packet.num = owned.m_packet.total = 0;  // nothing to read behind the null fp32
+        owned.m_packet.fp32 = owned.m_payload.data();
+        return owned;
+    }
+
+    PayloadPoolStatistics PayloadPool::statistics() const
+    {
+        PayloadPoolStatistics stats = {};
+        for (size_t i = 0; i < ClassCount; i++)
+        {
+            // Releases first, so a concurrent acquire and release pair cannot go negative
+            uint64_t releases = m_releases[i].load(std::memory_order_relaxed);
+            uint64_t hits = m_hits[i].load(std::memory_order_relaxed);
+            uint64_t misses = m_misses[i].load(std::memory_order_relaxed);
+            uint64_t blocks = m_blocks[i].load(std::memory_order_relaxed);
+            uint64_t inUse = hits + misses > releases ? hits + misses - releases : 0;
+            uint64_t bytes = uint64_t(1) << (i + MinClass);
+
+            stats.hits += hits;
+            stats.misses += misses;
+            stats.releases += releases;
+            stats.blocks += blocks;
+            stats.blocksInUse += inUse;
+            stats.footprintBytes += blocks * bytes;
+            stats.inUseBytes += inUse * bytes;
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef PAYLOADPOOL_H
+#define PAYLOADPOOL_H
+
+#include "StreamingMemory.h"
+#include <aaroniartsaapi.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    class PayloadPool;
+
+    struct PayloadPoolStatistics
+    {
+        uint64_t hits;              // acquisitions served from a free list
+        uint64_t misses;            // acquisitions that allocated a new block
+        uint64_t releases;
+        uint64_t blocks;            // allocated, in use or free
+        uint64_t blocksInUse;
+        uint64_t footprintBytes;    // memory of all blocks
+        uint64_t inUseBytes;        // memory of the blocks in use
+
+        double hitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+    // Payload buffer drawn from a PayloadPool, returned to it on destruction
+    class PooledBuffer
+    {
+    public:
+        PooledBuffer() : m_pool(nullptr), m_block(0), m_data(nullptr), m_capacity(0) {}
+        ~PooledBuffer() { reset(); }
+
+        PooledBuffer(PooledBuffer&& other) noexcept;
+        PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+        PooledBuffer(const PooledBuffer&) = delete;
+        PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+        float* data() const { return m_data; }
+        size_t capacity() const { return m_capacity; }      // in floats
+        explicit operator bool() const { return m_data != nullptr; }
+
+        // Hands the block back to its pool
+        void reset();
+
+    private:
+        friend class PayloadPool;
+        PooledBuffer(PayloadPool* pool, uint32_t block, float* data, size_t capacity)
+            : m_pool(pool), m_block(block), m_data(data), m_capacity(capacity)
+        {
+        }
+
+        PayloadPool* m_pool;
+        uint32_t m_block;
+        float* m_data;
+        size_t m_capacity;
+    };
+
+    // Packet that outlives ConsumePackets: the header with fp32 pointing into a
+    // pooled copy of the payload
+    class PooledPacket
+    {
+    public:
+        PooledPacket() : m_packet() {}
+
+        const AARTSAAPI_Packet& packet() const { return m_packet; }
+        const AARTSAAPI_Packet* operator->() const { return &m_packet; }
+
+        void reset();
+
+    private:
+        friend class PayloadPool;
+
+        AARTSAAPI_Packet m_packet;
+        PooledBuffer m_payload;
+    };
+
+    // Recycles payload buffers in power of two size classes from 64 bytes up.
+    // Blocks are aligned to a cache line, from 4 KiB up to a page, and are never
+    // freed before the pool, so a steady stream of packets allocates nothing once
+    // every class has enough blocks. Returned blocks go onto a lock-free stack
+    // per class; only growing the pool takes a lock. Buffers may be acquired and
+    // released on any thread, the pool has to outlive them.
+    class PayloadPool
+    {
+    public:
+        PayloadPool();
+        ~PayloadPool();
+
+        PayloadPool(const PayloadPool&) = delete;
+        PayloadPool& operator=(const PayloadPool&) = delete;
+
+        // Buffer of at least the given floats, empty for 0 or when out of memory
+        PooledBuffer acquire(size_t floats);
+
+        // Copies header and payload, the payload is num * stride floats. Out of
+        // memory the copy keeps the header with num and total 0 and fp32 null.
+        PooledPacket copy(const AARTSAAPI_Packet& packet);
+
+        // Allocates blocks ahead, so the first packets do not miss
+        void reserve(size_t floats, size_t count);
+
+        // Same, but carves the blocks from one StreamingBuffer held by the pool,
+        // huge page backed, pre-faulted and locked as far as the settings and the
+        // system allow. Returns what the arena got.
+        StreamingMemoryInfo reserve(size_t floats, size_t count, const StreamingMemorySettings& memory);
+
+        PayloadPoolStatistics statistics() const;
+
+    private:
+        friend class PooledBuffer;
+
+        struct Block
+        {
+            float* data;
+            uint32_t sizeClass;
+            bool arena;                     // part of a StreamingBuffer, not freed on its own
+            std::atomic<uint32_t> next;     // free list link, block index + 1, 0 ends
+        };
+
+        static const size_t MinClass = 6;           // 64 bytes
+        static const size_t ClassCount = 31;        // up to 64 GiB
+        static const size_t ChunkBlocks = 1024;
+        static const size_t MaxChunks = 4096;
+
+        Block& block(uint32_t index) { return m_chunks[index / ChunkBlocks].load(std::memory_order_acquire)[index % ChunkBlocks]; }
+        bool pop(size_t sizeClass, uint32_t& index);
+        void push(uint32_t index);
+        bool grow(size_t sizeClass, uint32_t& index, float* arena = nullptr);
+        void release(uint32_t index);
+
+        // Free list heads: version in the upper half against ABA, block index + 1 below
+        std::atomic<uint64_t> m_free[ClassCount];
+        std::atomic<Block*> m_chunks[MaxChunks];
+        uint32_t m_blockCount;          // under m_growLock
+        std::vector<StreamingBuffer> m_arenas;  // under m_growLock
+        std::mutex m_growLock;
+
+        // Per class, one atomic add per acquire and per release
+        std::atomic<uint64_t> m_hits[ClassCount], m_misses[ClassCount], m_releases[ClassCount], m_blocks[ClassCount];
+    };
+}
+
+#endif
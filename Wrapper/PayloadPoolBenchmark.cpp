@@ -0,0 +1,107 @@
+#include "BenchmarkSupport.h"
+#include "PayloadPool.h"
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+// Holds on to the last packets of a stream beyond ConsumePackets, once with a
+// heap copy of every payload, once with pooled copies, and the same without the
+// copy to show the allocation alone. The packets mix raw IQ, Rx12 and spectra
+// sizes. Runs without a device; takes the packet count and the packets held at
+// a time.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    struct HeapPacket
+    {
+        AARTSAAPI_Packet packet;
+        std::unique_ptr<float[]> payload;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations = NumberArgument<int>(argc, argv, 1, 200000);
+    const size_t held = NumberArgument<size_t>(argc, argv, 2, 64);
+
+    // IQ of 1024 samples, Rx12 of 1024 samples, 2048 and 16384 bin spectra
+    const int64_t shapes[][2] = { { 1024, 2 }, { 1024, 4 }, { 1, 2048 }, { 1, 16384 } };
+    std::vector<float> source(16384);
+    for (size_t i = 0; i < source.size(); i++)
+        source[i] = float(i);
+
+    std::vector<AARTSAAPI_Packet> packets;
+    for (const int64_t* shape : shapes)
+    {
+        AARTSAAPI_Packet packet = {};
+        packet.num = shape[0];
+        packet.size = shape[1];
+        packet.stride = shape[1];
+        packet.fp32 = source.data();
+        packets.push_back(packet);
+    }
+
+    double checksum = 0;
+    auto heapRun = [&](bool copy)
+        {
+            // The oldest copy is freed as the next is made
+            std::vector<HeapPacket> heapHeld(held);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                const AARTSAAPI_Packet& packet = packets[size_t(i) % packets.size()];
+                HeapPacket& slot = heapHeld[size_t(i) % held];
+                size_t floats = size_t(packet.num * packet.stride);
+                slot.payload.reset(new float[floats]);
+                if (copy)
+                    std::memcpy(slot.payload.get(), packet.fp32, floats * sizeof(float));
+                slot.packet = packet;
+                slot.packet.fp32 = slot.payload.get();
+                DoNotOptimize(slot.packet.fp32);
+            }
+            return SecondsSince(start);
+        };
+
+    PayloadPool pool;
+    auto poolRun = [&](bool copy)
+        {
+            std::vector<PooledPacket> copies(held);
+            std::vector<PooledBuffer> buffers(held);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                const AARTSAAPI_Packet& packet = packets[size_t(i) % packets.size()];
+                if (copy)
+                {
+                    PooledPacket& slot = copies[size_t(i) % held];
+                    slot = pool.copy(packet);
+                    checksum += slot->fp32[0];
+                }
+                else
+                {
+                    PooledBuffer& slot = buffers[size_t(i) % held];
+                    slot = pool.acquire(size_t(packet.num * packet.stride));
+                    DoNotOptimize(slot.data());
+                }
+            }
+            return SecondsSince(start);
+        };
+
+    double heapAllocate = heapRun(false), poolAllocate = poolRun(false);
+    double heapCopy = heapRun(true), poolCopy = poolRun(true);
+    DoNotOptimize(checksum);
+
+    PayloadPoolStatistics stats = pool.statistics();
+    std::cout << std::fixed << std::setprecision(1)
+        << "                   allocate      copy  ns/packet" << std::endl
+        << "Heap           " << std::setw(12) << heapAllocate / iterations * 1e9 << std::setw(10) << heapCopy / iterations * 1e9 << std::endl
+        << "PayloadPool    " << std::setw(12) << poolAllocate / iterations * 1e9 << std::setw(10) << poolCopy / iterations * 1e9 << std::endl
+        << std::setprecision(4)
+        << "Pool           : hit rate " << stats.hitRate() << ", " << stats.blocks << " blocks, footprint "
+        << stats.footprintBytes / 1024 << " KiB, in use " << stats.inUseBytes / 1024 << " KiB" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,1572 @@
+// Simulated RTSA API backend
+//
+// Builds a stand-in for libAaroniaRTSAAPI.so that exports the same AARTSAAPI_* C ABI,
+// so that the wrapper (via its library path override) and the directly linked samples
+// (via LD_LIBRARY_PATH) can run without a Spectran V6 attached.
+//
+// The simulated devices expose a configuration tree modelled on the real one for the
+// raw, iqreceiver, iqtransceiver, iqtransmitter, sweepsa and rtsa modes, and produce
+// IQ, spectra and sweep packets with consistent startTime/endTime, stepFrequency
+// and flags. Packets are generated lazily when the consumer polls, either paced to
+// the configured sample rate or as fast as they are consumed.
+//
+// Environment:
+//   AARTSAAPI_SIM_DEVICES     number of simulated devices per type (default 1)
+//   AARTSAAPI_SIM_PACING      "realtime" (default) or "unlimited"
+//   AARTSAAPI_SIM_CONNECT_MS  simulated connect latency in milliseconds (default 0)
+//   AARTSAAPI_SIM_REPLAY      packet recording to replay instead of generating packets,
+//                             written by the wrapper's PacketRecorder
+//   AARTSAAPI_SIM_REPLAY_SPEED  1 replays at the recorded timing (default), 10 ten times
+//                             faster, 0 as fast as the consumer reads
+//   AARTSAAPI_SIM_REPLAY_LOOP   1 restarts the recording at its end, with continuing
+//                             timestamps
+//
+// A replayed device has to be opened with the device type of the recording. Its
+// config tree is the simulated one, but only the recorded packets are delivered.
+
+#include <aaroniartsaapi.h>
+#include "PacketRecording.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <cwctype>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const double kPi = 3.14159265358979323846;
+
+    enum SimPacing
+    {
+        SIM_PACING_REALTIME = 0,
+        SIM_PACING_UNLIMITED = 1
+    };
+
+    enum SimChannelKind
+    {
+        SIM_CHANNEL_OFF,
+        SIM_CHANNEL_IQ,
+        SIM_CHANNEL_SPECTRA,
+        SIM_CHANNEL_SWEEP
+    };
+
+    struct SimConfigNode
+    {
+        std::wstring name;
+        std::wstring title;
+        std::wstring unit;
+        std::wstring options;
+        AARTSAAPI_ConfigType type;
+        double minValue, maxValue, stepValue;
+
+        double number;
+        std::wstring text;
+
+        SimConfigNode* parent;
+        size_t indexInParent;
+        std::vector<std::unique_ptr<SimConfigNode>> children;
+
+        SimConfigNode() : type(AARTSAAPI_CONFIG_TYPE_OTHER), minValue(0), maxValue(0), stepValue(0), number(0), parent(nullptr), indexInParent(0) {}
+    };
+
+    struct SimPacketSlot
+    {
+        AARTSAAPI_Packet packet;
+        std::vector<float> data;
+    };
+
+    struct SimChannel
+    {
+        SimChannelKind kind;
+        int receivers;          // 1 for plain streams, 2 for the interleaved Rx12 stream
+        int receiverIndex;      // which receiver feeds a non interleaved stream
+        double sampleRate;
+        double startFrequency;
+        double spanFrequency;
+        double rbwFrequency;
+        double stepFrequency;
+        int64_t packetSamples;
+        int64_t size;
+        int64_t stride;
+        double packetDuration;
+
+        double nextTime;
+        uint64_t nextFlags;
+        double phase[2];
+        uint32_t rng;
+
+        std::deque<SimPacketSlot*> queue;
+        std::vector<std::unique_ptr<SimPacketSlot>> slots;
+        std::vector<SimPacketSlot*> freeSlots;
+
+        int64_t producedSamples;
+        int64_t droppedPackets;
+
+        SimChannel()
+            : kind(SIM_CHANNEL_OFF), receivers(1), receiverIndex(0), sampleRate(0), startFrequency(0), spanFrequency(0), rbwFrequency(0), stepFrequency(0),
+              packetSamples(0), size(0), stride(0), packetDuration(0), nextTime(0), nextFlags(0), rng(0x9e3779b9u), producedSamples(0), droppedPackets(0)
+        {
+            phase[0] = phase[1] = 0;
+        }
+    };
+
+    enum SimDeviceState
+    {
+        SIM_STATE_IDLE,
+        SIM_STATE_CONNECTED,
+        SIM_STATE_RUNNING
+    };
+
+    struct SimDevice
+    {
+        std::wstring family;    // spectranv6 or spectranv6eco
+        std::wstring mode;      // raw, iqreceiver, ...
+        std::wstring serial;
+
+        std::unique_ptr<SimConfigNode> root;
+        std::unique_ptr<SimConfigNode> health;
+        bool configDirty;
+        // Read from the config tree by ApplyConfig, so generating a packet needs no path lookups
+        double dropRate;
+        bool unlimitedPacing;
+        double toneFrequency, toneOffset;
+        float toneLevel, noiseLevel, toneAmplitude, noiseAmplitude;
+
+        std::mutex lock;
+        SimDeviceState state;
+        SimChannel channels[2];
+
+        double streamTimeBase;
+        std::chrono::steady_clock::time_point steadyBase;
+
+        int64_t txSamples;
+        std::chrono::steady_clock::time_point healthTime;
+        int64_t healthSamples[2];
+        int64_t healthDropped;
+        int64_t healthTxSamples;
+
+        // Replay of a packet recording
+        std::unique_ptr<AarRtsaSdkWrapper::PacketRecordingReader> replay;
+        double replaySpeed;
+        bool replayLoop;
+        std::chrono::steady_clock::time_point replayStart;
+        bool replayPending;                         // pendingRecord has been read but is not due yet
+        AarRtsaSdkWrapper::PacketRecord pendingRecord;
+        std::vector<float> pendingPayload;
+        double replayCaptureShift, replayTimeShift; // added per loop iteration
+        double replayFirstStartTime, replayLastEndTime, replayLastCapture;
+        double replayStreamTime;
+
+        SimDevice() : configDirty(true), dropRate(0), unlimitedPacing(false), toneFrequency(0), toneOffset(0),
+              toneLevel(0), noiseLevel(0), toneAmplitude(0), noiseAmplitude(0), state(SIM_STATE_IDLE), streamTimeBase(0), txSamples(0), healthDropped(0), healthTxSamples(0),
+              replaySpeed(1), replayLoop(false), replayPending(false), replayCaptureShift(0), replayTimeShift(0),
+              replayFirstStartTime(-1), replayLastEndTime(0), replayLastCapture(0), replayStreamTime(0)
+        {
+            healthSamples[0] = healthSamples[1] = 0;
+        }
+    };
+
+    struct SimHandle
+    {
+        std::vector<std::unique_ptr<SimDevice>> devices;
+    };
+
+    struct SimLibrary
+    {
+        std::mutex lock;
+        bool initialized = false;
+        uint32_t memory = AARTSAAPI_MEMORY_MEDIUM;
+        std::vector<std::unique_ptr<SimHandle>> handles;
+    };
+
+    SimLibrary& Library()
+    {
+        static SimLibrary library;
+        return library;
+    }
+
+    int EnvInteger(const char* name, int fallback)
+    {
+        const char* value = std::getenv(name);
+        if (!value || !*value)
+            return fallback;
+        return std::atoi(value);
+    }
+
+    double EnvDouble(const char* name, double fallback)
+    {
+        const char* value = std::getenv(name);
+        if (!value || !*value)
+            return fallback;
+        return std::atof(value);
+    }
+
+    bool EnvEquals(const char* name, const char* expected)
+    {
+        const char* value = std::getenv(name);
+        if (!value)
+            return false;
+        for (; *value && *expected; value++, expected++)
+        {
+            if (std::tolower((unsigned char)*value) != std::tolower((unsigned char)*expected))
+                return false;
+        }
+        return *value == *expected;
+    }
+
+    bool EqualsNoCase(const std::wstring& a, const std::wstring& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (std::towlower(a[i]) != std::towlower(b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<std::wstring> SplitOptions(const std::wstring& options)
+    {
+        std::vector<std::wstring> result;
+        size_t start = 0;
+        while (start <= options.size() && !options.empty())
+        {
+            size_t end = options.find(L';', start);
+            if (end == std::wstring::npos)
+            {
+                result.push_back(options.substr(start));
+                break;
+            }
+            result.push_back(options.substr(start, end - start));
+            start = end + 1;
+        }
+        return result;
+    }
+
+    std::wstring FormatNumber(double value)
+    {
+        wchar_t buffer[64];
+        std::swprintf(buffer, sizeof(buffer) / sizeof(wchar_t), L"%g", value);
+        return buffer;
+    }
+
+    void CopyWide(wchar_t* target, size_t capacity, const std::wstring& source)
+    {
+        if (capacity == 0)
+            return;
+        size_t n = std::min(capacity - 1, source.size());
+        std::wmemcpy(target, source.c_str(), n);
+        target[n] = 0;
+    }
+
+    // Configuration tree construction
+
+    SimConfigNode* AddNode(SimConfigNode* parent, AARTSAAPI_ConfigType type, const wchar_t* name, const wchar_t* title, const wchar_t* unit = L"")
+    {
+        std::unique_ptr<SimConfigNode> node(new SimConfigNode());
+        node->type = type;
+        node->name = name;
+        node->title = title;
+        node->unit = unit;
+        node->parent = parent;
+        node->indexInParent = parent->children.size();
+        SimConfigNode* result = node.get();
+        parent->children.push_back(std::move(node));
+        return result;
+    }
+
+    SimConfigNode* AddGroup(SimConfigNode* parent, const wchar_t* name, const wchar_t* title)
+    {
+        return AddNode(parent, AARTSAAPI_CONFIG_TYPE_GROUP, name, title);
+    }
+
+    SimConfigNode* AddNumber(SimConfigNode* parent, const wchar_t* name, const wchar_t* title, const wchar_t* unit, double value, double minValue, double maxValue, double stepValue = 0)
+    {
+        SimConfigNode* node = AddNode(parent, AARTSAAPI_CONFIG_TYPE_NUMBER, name, title, unit);
+        node->number = value;
+        node->minValue = minValue;
+        node->maxValue = maxValue;
+        node->stepValue = stepValue;
+        return node;
+    }
+
+    SimConfigNode* AddEnum(SimConfigNode* parent, const wchar_t* name, const wchar_t* title, const wchar_t* options, int value)
+    {
+        SimConfigNode* node = AddNode(parent, AARTSAAPI_CONFIG_TYPE_ENUM, name, title);
+        node->options = options;
+        std::vector<std::wstring> list = SplitOptions(node->options);
+        node->maxValue = double(list.size() - 1);
+        node->stepValue = 1;
+        node->number = value;
+        node->text = list[value];
+        return node;
+    }
+
+    SimConfigNode* AddBool(SimConfigNode* parent, const wchar_t* name, const wchar_t* title, bool value)
+    {
+        SimConfigNode* node = AddNode(parent, AARTSAAPI_CONFIG_TYPE_BOOL, name, title);
+        node->maxValue = 1;
+        node->stepValue = 1;
+        node->number = value ? 1 : 0;
+        node->text = value ? L"true" : L"false";
+        return node;
+    }
+
+    SimConfigNode* AddString(SimConfigNode* parent, const wchar_t* name, const wchar_t* title, const wchar_t* value)
+    {
+        SimConfigNode* node = AddNode(parent, AARTSAAPI_CONFIG_TYPE_STRING, name, title);
+        node->text = value;
+        return node;
+    }
+
+    SimConfigNode* FindChild(SimConfigNode* group, const std::wstring& name)
+    {
+        for (auto& child : group->children)
+        {
+            if (child->name == name)
+                return child.get();
+        }
+        return nullptr;
+    }
+
+    SimConfigNode* FindPath(SimConfigNode* group, const wchar_t* path)
+    {
+        std::wstring remaining(path);
+        SimConfigNode* node = group;
+        while (node && !remaining.empty())
+        {
+            size_t slash = remaining.find(L'/');
+            std::wstring part = remaining.substr(0, slash);
+            node = FindChild(node, part);
+            if (slash == std::wstring::npos)
+                break;
+            remaining.erase(0, slash + 1);
+        }
+        return node;
+    }
+
+    double NumberAt(SimConfigNode* root, const wchar_t* path, double fallback)
+    {
+        SimConfigNode* node = FindPath(root, path);
+        return node ? node->number : fallback;
+    }
+
+    std::wstring TextAt(SimConfigNode* root, const wchar_t* path, const wchar_t* fallback)
+    {
+        SimConfigNode* node = FindPath(root, path);
+        return node ? node->text : std::wstring(fallback);
+    }
+
+    void AddFFTGroup(SimConfigNode* device, const wchar_t* name, const wchar_t* title)
+    {
+        SimConfigNode* fft = AddGroup(device, name, title);
+        AddEnum(fft, L"fftmergemode", L"FFT Merge Mode", L"avg;sum;min;max", 0);
+        AddNumber(fft, L"fftaggregate", L"FFT Merge Length", L"", 1, 1, 65536, 1);
+        AddEnum(fft, L"fftsizemode", L"FFT Size Mode", L"FFT;Bins;Step Frequency;RBW", 0);
+        AddNumber(fft, L"fftsize", L"FFT Size", L"", 2048, 32, 65536, 1);
+        AddNumber(fft, L"fftbinsize", L"FFT Bins", L"", 2048, 32, 65536, 1);
+        AddNumber(fft, L"fftstepfreq", L"FFT Step Frequency", L"Frequency", 100000, 1, 1e9);
+        AddNumber(fft, L"fftrbwfreq", L"FFT RBW Frequency", L"Frequency", 100000, 1, 1e9);
+        AddEnum(fft, L"fftwindow", L"FFT Window", L"Hamming;Hann;Uniform;Blackman;Blackman Harris;Flat Top", 0);
+    }
+
+    void BuildConfigTree(SimDevice* dev)
+    {
+        bool eco = dev->family == L"spectranv6eco";
+        bool raw = dev->mode == L"raw";
+        bool sweep = dev->mode == L"sweepsa" || dev->mode == L"rtsa";
+        bool tx = dev->mode == L"iqtransmitter" || dev->mode == L"iqtransceiver";
+        bool rx = dev->mode != L"iqtransmitter";
+
+        dev->root.reset(new SimConfigNode());
+        dev->root->type = AARTSAAPI_CONFIG_TYPE_GROUP;
+
+        SimConfigNode* main = AddGroup(dev->root.get(), L"main", L"Main");
+        if (sweep)
+        {
+            AddNumber(main, L"startfreq", L"Start Frequency", L"Frequency", 2.4e9, 1e6, 6.0e9);
+            AddNumber(main, L"stopfreq", L"Stop Frequency", L"Frequency", 2.5e9, 1e6, 6.0e9);
+            AddNumber(main, L"rbwfreq", L"RBW Frequency", L"Frequency", 100e3, 1.0, 50e6);
+        }
+        else
+        {
+            AddNumber(main, L"centerfreq", L"Center Frequency", L"Frequency", 2.44e9, 1e6, 6.0e9);
+            if (raw)
+                AddEnum(main, L"decimation", L"Span", L"Full;1 / 2;1 / 4;1 / 8;1 / 16;1 / 32;1 / 64;1 / 128;1 / 256;1 / 512", 0);
+            else
+                AddNumber(main, L"spanfreq", L"Span Frequency", L"Frequency", 40e6, 1e3, 245e6);
+            if (dev->mode == L"iqtransceiver")
+            {
+                AddNumber(main, L"centerfreqrx", L"Rx Center Frequency", L"Frequency", 2.44e9, 1e6, 6.0e9);
+                AddNumber(main, L"centerfreqtx", L"Tx Center Frequency", L"Frequency", 2.44e9, 1e6, 6.0e9);
+                AddNumber(main, L"demodcenterfreq", L"Demod Center Frequency", L"Frequency", 2.44e9, 1e6, 6.0e9);
+                AddNumber(main, L"demodspanfreq", L"Demod Span Frequency", L"Frequency", 5e6, 1e3, 245e6);
+            }
+        }
+        AddNumber(main, L"reflevel", L"Reference Level", L"dBm", 0, -100, 30);
+        if (tx || raw)
+            AddNumber(main, L"transgain", L"Transmitter Gain", L"dB", -20, -100, 10);
+
+        SimConfigNode* device = AddGroup(dev->root.get(), L"device", L"Board Config");
+        AddEnum(device, L"usbcompression", L"USB Compression", L"auto;compressed;raw", 0);
+        if (raw)
+        {
+            AddEnum(device, L"outputformat", L"Output Format", L"iq;spectra;both;auto", 3);
+            AddFFTGroup(device, L"fft0", L"Spectra 1");
+            AddFFTGroup(device, L"fft1", L"Spectra 2");
+        }
+        if (!eco)
+            AddEnum(device, L"receiverclock", L"Receiver Clock", L"92MHz;122MHz;184MHz;245MHz;492MHz;77MHz;61MHz;46MHz", 0);
+        if (rx)
+        {
+            AddEnum(device, L"receiverchannel", L"Receiver Channels", L"Rx1;Rx2;Rx1+Rx2;Rx1/Rx2;Rx12;Rx Off;auto", 6);
+            AddEnum(device, L"receiverchannelsel", L"Receiver Select", L"Rx1;Rx2;Rx2->1;Rx1->2", 0);
+        }
+        AddEnum(device, L"transmittermode", L"Transmitter Mode", L"Off;Test;Stream;Reactive;Signal Generator;Pattern Generator", tx ? 2 : 0);
+        AddNumber(device, L"transmitterclockvar", L"Tx Clock Tolerance", L"Time", 0.0002, 0, 1);
+        AddEnum(device, L"sclksource", L"Stream Clock Source", L"Consumer;Oscillator;GPS;PPS;10MHz;Oscillator Provider;GPS Provider;PPS Provider", 0);
+        AddEnum(device, L"gpsmode", L"GPS Mode", L"Disabled;Location;Time;Location and Time", 0);
+        AddNumber(device, L"gpsrate", L"GPS Update Rate", L"Time", 0.5, 0.1, 10);
+        AddString(device, L"serial", L"Serial Number", L"");
+
+        SimConfigNode* calibration = AddGroup(dev->root.get(), L"calibration", L"Calibration");
+        AddBool(calibration, L"bypassfilter", L"Bypass Filter", false);
+        AddEnum(calibration, L"preamp", L"RF Amplifier", L"Disabled;Auto;None;Amp;Preamp;Both", 0);
+
+        SimConfigNode* simulator = AddGroup(dev->root.get(), L"simulator", L"Simulator");
+        AddEnum(simulator, L"pacing", L"Packet Pacing", L"Realtime;Unlimited", EnvEquals("AARTSAAPI_SIM_PACING", "unlimited") ? SIM_PACING_UNLIMITED : SIM_PACING_REALTIME);
+        AddNumber(simulator, L"packetsamples", L"IQ Samples per Packet", L"", 1024, 16, 1 << 20, 1);
+        AddNumber(simulator, L"toneoffset", L"Tone Offset", L"Frequency", 1.0e6, -250e6, 250e6);
+        AddNumber(simulator, L"tonelevel", L"Tone Level", L"dBm", -30, -150, 20);
+        AddNumber(simulator, L"noiselevel", L"Noise Level", L"dBm", -90, -200, 0);
+        AddNumber(simulator, L"droprate", L"Packet Drop Rate", L"%", 0, 0, 100);
+
+        dev->health.reset(new SimConfigNode());
+        dev->health->type = AARTSAAPI_CONFIG_TYPE_GROUP;
+        SimConfigNode* health = dev->health.get();
+        AddNumber(health, L"rx1iqsamplessecond", L"Rx1 IQ Samples/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"rx2iqsamplessecond", L"Rx2 IQ Samples/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"tx1iqsamplessecond", L"Tx IQ Samples/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"rx1spectrasecond", L"Rx1 Spectra/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"rx2spectrasecond", L"Rx2 Spectra/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"errors", L"Errors", L"", 0, 0, 1e18);
+        AddNumber(health, L"usboverflowssecond", L"USB Overflows/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"frontendtemp", L"Frontend Temperature", L"Number", 42.0, -50, 150);
+        AddNumber(health, L"fpgatemp", L"FPGA Temperature", L"Number", 48.0, -50, 150);
+        AddNumber(health, L"mainusbbytessecond", L"Main USB Bytes/s", L"Number", 0, 0, 1e12);
+        AddNumber(health, L"boostusbbytessecond", L"Boost USB Bytes/s", L"Number", 0, 0, 1e12);
+        AddBool(health, L"gpsposvalid", L"GPS Position Valid", false);
+        AddBool(health, L"gpstimevalid", L"GPS Time Valid", false);
+        AddNumber(health, L"gpssats", L"GPS Satellites", L"", 0, 0, 64);
+        AddNumber(health, L"gpstime", L"GPS Time", L"DateTime", 0, 0, 1e12);
+        AddNumber(health, L"gpstimeoffset", L"GPS Time Offset", L"Time", 0, -1e6, 1e6);
+    }
+
+    // Stream time and packet generation
+
+    double WallClockSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    double StreamTimeNow(SimDevice* dev)
+    {
+        return dev->streamTimeBase + std::chrono::duration<double>(std::chrono::steady_clock::now() - dev->steadyBase).count();
+    }
+
+    double ReceiverClock(SimDevice* dev)
+    {
+        if (dev->family == L"spectranv6eco")
+            return 61.44e6;
+
+        static const double clocks[] = { 92.16e6, 122.88e6, 184.32e6, 245.76e6, 491.52e6, 76.8e6, 61.44e6, 46.08e6 };
+        int index = int(NumberAt(dev->root.get(), L"device/receiverclock", 0));
+        if (index < 0 || index >= int(sizeof(clocks) / sizeof(clocks[0])))
+            index = 0;
+        return clocks[index];
+    }
+
+    size_t QueueDepth()
+    {
+        switch (Library().memory)
+        {
+        case AARTSAAPI_MEMORY_SMALL:
+            return 64;
+        case AARTSAAPI_MEMORY_LARGE:
+            return 1024;
+        case AARTSAAPI_MEMORY_LUDICROUS:
+            return 4096;
+        default:
+            return 256;
+        }
+    }
+
+    void SetupChannel(SimChannel& ch, SimChannelKind kind, double sampleRate, double centerFrequency, double spanFrequency, int64_t packetSamples)
+    {
+        ch.kind = kind;
+        ch.sampleRate = sampleRate;
+        ch.spanFrequency = spanFrequency;
+        ch.startFrequency = centerFrequency - 0.5 * spanFrequency;
+        ch.rbwFrequency = 0;
+        ch.stepFrequency = sampleRate;
+        ch.packetSamples = packetSamples;
+        ch.size = 2 * ch.receivers;
+        ch.stride = ch.size;
+        ch.packetDuration = double(packetSamples) / sampleRate;
+    }
+
+    // Derive the packet layout of every channel from the current configuration.
+    // Only the frequency plan changes for a running stream, timing continues.
+
+    void ApplyConfig(SimDevice* dev)
+    {
+        SimConfigNode* root = dev->root.get();
+        double clock = ReceiverClock(dev);
+        double center = NumberAt(root, L"main/centerfreq", 2.44e9);
+        int64_t packetSamples = int64_t(NumberAt(root, L"simulator/packetsamples", 1024));
+        dev->dropRate = NumberAt(root, L"simulator/droprate", 0) * 0.01;
+        dev->unlimitedPacing = int(NumberAt(root, L"simulator/pacing", 0)) == SIM_PACING_UNLIMITED;
+        dev->toneOffset = NumberAt(root, L"simulator/toneoffset", 1.0e6);
+        dev->toneFrequency = (dev->mode == L"iqtransceiver" ? NumberAt(root, L"main/demodcenterfreq", center) : center) + dev->toneOffset;
+        dev->toneLevel = float(NumberAt(root, L"simulator/tonelevel", -30));
+        dev->noiseLevel = float(NumberAt(root, L"simulator/noiselevel", -90));
+        dev->toneAmplitude = float(std::pow(10.0, dev->toneLevel / 20.0));
+        dev->noiseAmplitude = float(std::pow(10.0, dev->noiseLevel / 20.0));
+
+        for (SimChannel& ch : dev->channels)
+        {
+            ch.kind = SIM_CHANNEL_OFF;
+            ch.receivers = 1;
+            ch.receiverIndex = 0;
+        }
+
+        if (dev->mode == L"iqtransmitter")
+        {
+            dev->configDirty = false;
+            return;
+        }
+
+        if (dev->mode == L"sweepsa" || dev->mode == L"rtsa")
+        {
+            SimChannel& ch = dev->channels[0];
+            double startFreq = NumberAt(root, L"main/startfreq", 2.4e9);
+            double stopFreq = std::max(startFreq + 1.0, NumberAt(root, L"main/stopfreq", 2.5e9));
+            double rbw = NumberAt(root, L"main/rbwfreq", 100e3);
+            int64_t bins = std::min<int64_t>(int64_t(1) << 20, std::max<int64_t>(16, int64_t(std::ceil((stopFreq - startFreq) / rbw))));
+
+            ch.kind = SIM_CHANNEL_SWEEP;
+            ch.startFrequency = startFreq;
+            ch.spanFrequency = stopFreq - startFreq;
+            ch.stepFrequency = ch.spanFrequency / double(bins);
+            ch.rbwFrequency = std::max(rbw, ch.stepFrequency);
+            ch.size = bins;
+            ch.stride = bins;
+            ch.packetSamples = 1;
+            ch.sampleRate = clock;
+            // Sweep speed of roughly 100 GHz/s with a 1 ms floor
+            ch.packetDuration = std::max(1.0e-3, ch.spanFrequency / 100.0e9);
+            dev->configDirty = false;
+            return;
+        }
+
+        double sampleRate, span;
+        if (dev->mode == L"raw")
+        {
+            int decimation = int(NumberAt(root, L"main/decimation", 0));
+            sampleRate = clock / double(1 << decimation);
+            span = sampleRate * 0.8;
+        }
+        else
+        {
+            span = NumberAt(root, L"main/spanfreq", 40e6);
+            if (dev->mode == L"iqtransceiver")
+            {
+                span = NumberAt(root, L"main/demodspanfreq", span);
+                center = NumberAt(root, L"main/demodcenterfreq", center);
+            }
+            span = std::min(span, clock / 1.5);
+            sampleRate = span * 1.5;
+        }
+
+        std::wstring channels = TextAt(root, L"device/receiverchannel", L"Rx1");
+        std::wstring format = TextAt(root, L"device/outputformat", L"iq");
+        bool spectra = format == L"spectra";
+        bool both = format == L"both";
+
+        int64_t fftSize = int64_t(NumberAt(root, L"device/fft0/fftsize", 2048));
+        int64_t aggregate = std::max<int64_t>(1, int64_t(NumberAt(root, L"device/fft0/fftaggregate", 1)));
+
+        auto setupStream = [&](SimChannel& ch, bool asSpectra)
+        {
+            if (asSpectra)
+            {
+                SetupChannel(ch, SIM_CHANNEL_SPECTRA, sampleRate, center, sampleRate, 1);
+                ch.stepFrequency = sampleRate / double(fftSize);
+                ch.rbwFrequency = 1.36 * ch.stepFrequency;
+                ch.size = fftSize;
+                ch.stride = fftSize;
+                ch.packetDuration = double(fftSize * aggregate) / sampleRate;
+            }
+            else
+                SetupChannel(ch, SIM_CHANNEL_IQ, sampleRate, center, span, packetSamples);
+        };
+
+        if (channels == L"Rx Off")
+        {
+        }
+        else if (channels == L"Rx1+Rx2" || channels == L"Rx1/Rx2")
+        {
+            setupStream(dev->channels[0], spectra);
+            dev->channels[1].receiverIndex = 1;
+            setupStream(dev->channels[1], spectra);
+        }
+        else if (channels == L"Rx12")
+        {
+            dev->channels[0].receivers = 2;
+            setupStream(dev->channels[0], false);
+        }
+        else
+        {
+            dev->channels[0].receiverIndex = channels == L"Rx2" ? 1 : 0;
+            setupStream(dev->channels[0], spectra);
+            if (both)
+            {
+                dev->channels[1].receiverIndex = dev->channels[0].receiverIndex;
+                setupStream(dev->channels[1], true);
+            }
+        }
+
+        dev->configDirty = false;
+    }
+
+    inline float NextNoise(uint32_t& state)
+    {
+        // xorshift32, sum of two uniforms gives a cheap triangular noise
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        float a = float(state & 0xffff) * (1.0f / 65536.0f);
+        float b = float(state >> 16) * (1.0f / 65536.0f);
+        return a + b - 1.0f;
+    }
+
+    void FillIQ(SimDevice* dev, SimChannel& ch, SimPacketSlot& slot)
+    {
+        float toneAmplitude = dev->toneAmplitude;
+        float noiseAmplitude = dev->noiseAmplitude;
+        double delta = 2.0 * kPi * dev->toneOffset / ch.sampleRate;
+
+        int64_t num = ch.packetSamples;
+        slot.data.resize(size_t(num * ch.stride));
+        float* out = slot.data.data();
+
+        for (int r = 0; r < ch.receivers; r++)
+        {
+            int receiver = ch.receivers > 1 ? r : ch.receiverIndex;
+
+            // Rotate a complex phasor, renormalized once per packet
+            double c = std::cos(ch.phase[r]), s = std::sin(ch.phase[r]);
+            double dc = std::cos(delta), ds = std::sin(delta);
+            // Second receiver sees the tone with a fixed phase offset
+            if (receiver == 1)
+            {
+                double pc = std::cos(0.25 * kPi), ps = std::sin(0.25 * kPi);
+                double nc = c * pc - s * ps;
+                s = c * ps + s * pc;
+                c = nc;
+            }
+
+            float* p = out + 2 * r;
+            for (int64_t j = 0; j < num; j++)
+            {
+                p[0] = float(c) * toneAmplitude + NextNoise(ch.rng) * noiseAmplitude;
+                p[1] = float(s) * toneAmplitude + NextNoise(ch.rng) * noiseAmplitude;
+                double nc = c * dc - s * ds;
+                s = c * ds + s * dc;
+                c = nc;
+                p += ch.stride;
+            }
+
+            ch.phase[r] = std::fmod(ch.phase[r] + delta * double(num), 2.0 * kPi);
+        }
+    }
+
+    void FillSpectrum(SimDevice* dev, SimChannel& ch, SimPacketSlot& slot, double centerOfTone)
+    {
+        float toneLevel = dev->toneLevel;
+        float noiseLevel = dev->noiseLevel;
+
+        slot.data.resize(size_t(ch.stride));
+        float* out = slot.data.data();
+        for (int64_t j = 0; j < ch.size; j++)
+            out[j] = noiseLevel + 3.0f * NextNoise(ch.rng);
+
+        int64_t bin = int64_t(std::floor((centerOfTone - ch.startFrequency) / ch.stepFrequency));
+        for (int64_t k = -2; k <= 2; k++)
+        {
+            int64_t j = bin + k;
+            if (j >= 0 && j < ch.size)
+                out[j] = std::max(out[j], toneLevel - 6.0f * float(k * k));
+        }
+    }
+
+    SimPacketSlot* AcquireSlot(SimChannel& ch)
+    {
+        if (!ch.freeSlots.empty())
+        {
+            SimPacketSlot* slot = ch.freeSlots.back();
+            ch.freeSlots.pop_back();
+            return slot;
+        }
+        ch.slots.emplace_back(new SimPacketSlot());
+        return ch.slots.back().get();
+    }
+
+    void ClearQueue(SimChannel& ch)
+    {
+        for (SimPacketSlot* slot : ch.queue)
+            ch.freeSlots.push_back(slot);
+        ch.queue.clear();
+    }
+
+    void GeneratePacket(SimDevice* dev, SimChannel& ch)
+    {
+        SimPacketSlot* slot = AcquireSlot(ch);
+        double toneFrequency = dev->toneFrequency;
+
+        switch (ch.kind)
+        {
+        case SIM_CHANNEL_IQ:
+            FillIQ(dev, ch, *slot);
+            break;
+        case SIM_CHANNEL_SPECTRA:
+        case SIM_CHANNEL_SWEEP:
+            FillSpectrum(dev, ch, *slot, toneFrequency);
+            break;
+        default:
+            break;
+        }
+
+        AARTSAAPI_Packet& packet = slot->packet;
+        std::memset(&packet, 0, sizeof(packet));
+        packet.cbsize = sizeof(AARTSAAPI_Packet);
+        packet.flags = ch.nextFlags;
+        packet.startTime = ch.nextTime;
+        packet.endTime = ch.nextTime + ch.packetDuration;
+        packet.startFrequency = ch.startFrequency;
+        packet.stepFrequency = ch.stepFrequency;
+        packet.spanFrequency = ch.spanFrequency;
+        packet.rbwFrequency = ch.rbwFrequency;
+        packet.num = ch.packetSamples;
+        packet.size = ch.size;
+        packet.stride = ch.stride;
+        packet.fp32 = slot->data.data();
+
+        // A sweep is a complete segment of its own
+        if (ch.kind == SIM_CHANNEL_SWEEP)
+            packet.flags |= AARTSAAPI_PACKET_STREAM_START | AARTSAAPI_PACKET_SEGMENT_START | AARTSAAPI_PACKET_SEGMENT_END;
+
+        ch.nextTime = packet.endTime;
+        ch.nextFlags = 0;
+        ch.producedSamples += ch.kind == SIM_CHANNEL_IQ ? ch.packetSamples : 1;
+        ch.queue.push_back(slot);
+    }
+
+    // Skip packets that did not fit into the queue in time, the stream continues
+    // with a gap and a new segment just like an overflowing USB transfer.
+
+    void DropPackets(SimChannel& ch, int64_t count)
+    {
+        ch.nextTime += double(count) * ch.packetDuration;
+        ch.nextFlags |= AARTSAAPI_PACKET_SEGMENT_START;
+        ch.droppedPackets += count;
+    }
+
+    void RewindReplay(SimDevice* dev)
+    {
+        dev->replay->rewind();
+        dev->replayPending = false;
+        dev->replayCaptureShift = 0;
+        dev->replayTimeShift = 0;
+        dev->replayFirstStartTime = -1;
+        dev->replayLastEndTime = 0;
+        dev->replayLastCapture = 0;
+        dev->replayStreamTime = 0;
+        dev->replayStart = std::chrono::steady_clock::now();
+    }
+
+    // Move all recorded packets that are due into their channel queues. Paced
+    // replays drop packets that do not fit, like an overflowing USB transfer, an
+    // unpaced replay waits for the consumer instead.
+
+    void PumpReplay(SimDevice* dev)
+    {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - dev->replayStart).count();
+        size_t depth = QueueDepth();
+        AarRtsaSdkWrapper::PacketRecord& record = dev->pendingRecord;
+
+        for (;;)
+        {
+            if (!dev->replayPending)
+            {
+                if (!dev->replay->next(record, dev->pendingPayload))
+                {
+                    if (!dev->replayLoop || dev->replayFirstStartTime < 0)
+                        return;
+
+                    // Continue behind the last packet of the previous pass
+                    double captureShift = dev->replayLastCapture + 1.0e-6;
+                    double timeShift = dev->replayLastEndTime - dev->replayFirstStartTime;
+                    dev->replay->rewind();
+                    dev->replayCaptureShift = captureShift;
+                    dev->replayTimeShift = timeShift;
+                    if (!dev->replay->next(record, dev->pendingPayload))
+                        return;
+                }
+                dev->replayPending = true;
+                record.captureTime += dev->replayCaptureShift;
+                record.startTime += dev->replayTimeShift;
+                record.endTime += dev->replayTimeShift;
+            }
+
+            if (dev->replaySpeed > 0 && record.captureTime / dev->replaySpeed > elapsed)
+                return;
+
+            if (record.channel < 0 || record.channel > 1)
+            {
+                dev->replayPending = false;
+                continue;
+            }
+
+            SimChannel& ch = dev->channels[record.channel];
+            if (ch.queue.size() >= depth)
+            {
+                if (dev->replaySpeed <= 0)
+                    return;
+                ch.nextFlags |= AARTSAAPI_PACKET_SEGMENT_START;
+                ch.droppedPackets++;
+            }
+            else
+            {
+                SimPacketSlot* slot = AcquireSlot(ch);
+                slot->data.swap(dev->pendingPayload);
+
+                AARTSAAPI_Packet& packet = slot->packet;
+                std::memset(&packet, 0, sizeof(packet));
+                packet.cbsize = sizeof(AARTSAAPI_Packet);
+                packet.flags = record.flags | ch.nextFlags;
+                packet.startTime = record.startTime;
+                packet.endTime = record.endTime;
+                packet.startFrequency = record.startFrequency;
+                packet.stepFrequency = record.stepFrequency;
+                packet.spanFrequency = record.spanFrequency;
+                packet.rbwFrequency = record.rbwFrequency;
+                packet.num = record.num;
+                packet.size = record.size;
+                packet.stride = record.stride;
+                packet.fp32 = slot->data.empty() ? nullptr : slot->data.data();
+
+                ch.nextFlags = 0;
+                ch.producedSamples += record.num;
+                ch.queue.push_back(slot);
+            }
+
+            if (dev->replayFirstStartTime < 0)
+                dev->replayFirstStartTime = record.startTime;
+            dev->replayLastEndTime = std::max(dev->replayLastEndTime, record.endTime);
+            dev->replayLastCapture = record.captureTime;
+            dev->replayStreamTime = record.endTime;
+            dev->replayPending = false;
+        }
+    }
+
+    void PumpChannel(SimDevice* dev, SimChannel& ch)
+    {
+        if (dev->state == SIM_STATE_RUNNING && dev->replay)
+        {
+            PumpReplay(dev);
+            return;
+        }
+        if (dev->state != SIM_STATE_RUNNING || ch.kind == SIM_CHANNEL_OFF)
+            return;
+        if (dev->configDirty)
+            ApplyConfig(dev);
+
+        size_t depth = QueueDepth();
+        double dropRate = dev->dropRate;
+
+        int64_t due;
+        if (dev->unlimitedPacing)
+            due = int64_t(depth) - int64_t(ch.queue.size());
+        else
+        {
+            due = int64_t(std::floor((StreamTimeNow(dev) - ch.nextTime) / ch.packetDuration));
+            int64_t room = int64_t(depth) - int64_t(ch.queue.size());
+            if (due > room)
+            {
+                DropPackets(ch, due - room);
+                due = room;
+            }
+        }
+
+        for (int64_t i = 0; i < due; i++)
+        {
+            if (dropRate > 0 && (NextNoise(ch.rng) + 1.0f) * 0.5f < dropRate)
+            {
+                DropPackets(ch, 1);
+                continue;
+            }
+            GeneratePacket(dev, ch);
+        }
+    }
+
+    SimDevice* DeviceOf(AARTSAAPI_Device* dhandle)
+    {
+        return dhandle ? static_cast<SimDevice*>(dhandle->d) : nullptr;
+    }
+
+    SimConfigNode* ConfigOf(AARTSAAPI_Config* config)
+    {
+        return config ? static_cast<SimConfigNode*>(config->d) : nullptr;
+    }
+
+    bool IsHealthNode(SimDevice* dev, SimConfigNode* node)
+    {
+        while (node->parent)
+            node = node->parent;
+        return node == dev->health.get();
+    }
+
+    void UpdateHealth(SimDevice* dev)
+    {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - dev->healthTime).count();
+        if (elapsed <= 0)
+            return;
+
+        SimConfigNode* health = dev->health.get();
+        int64_t dropped = dev->channels[0].droppedPackets + dev->channels[1].droppedPackets;
+
+        for (int c = 0; c < 2; c++)
+        {
+            SimChannel& ch = dev->channels[c];
+            double rate = double(ch.producedSamples - dev->healthSamples[c]) / elapsed;
+            int receiver = c == 0 ? 0 : 1;
+            if (ch.kind == SIM_CHANNEL_IQ)
+            {
+                // Rx12 carries both receivers at the full rate each
+                FindChild(health, receiver == 0 ? L"rx1iqsamplessecond" : L"rx2iqsamplessecond")->number = rate;
+                if (ch.receivers > 1)
+                    FindChild(health, L"rx2iqsamplessecond")->number = rate;
+            }
+            else if (ch.kind != SIM_CHANNEL_OFF)
+                FindChild(health, receiver == 0 ? L"rx1spectrasecond" : L"rx2spectrasecond")->number = rate;
+            dev->healthSamples[c] = ch.producedSamples;
+        }
+
+        double txRate = double(dev->txSamples - dev->healthTxSamples) / elapsed;
+        FindChild(health, L"tx1iqsamplessecond")->number = txRate;
+        FindChild(health, L"usboverflowssecond")->number = double(dropped - dev->healthDropped) / elapsed;
+        FindChild(health, L"errors")->number = double(dropped);
+        // Compressed transfer with 16 bit per component
+        double samples = FindChild(health, L"rx1iqsamplessecond")->number + FindChild(health, L"rx2iqsamplessecond")->number + txRate;
+        FindChild(health, L"mainusbbytessecond")->number = samples * 4.0 * 0.5;
+        FindChild(health, L"boostusbbytessecond")->number = samples * 4.0 * 0.5;
+        FindChild(health, L"gpstime")->number = StreamTimeNow(dev);
+
+        dev->healthTxSamples = dev->txSamples;
+        dev->healthDropped = dropped;
+        dev->healthTime = now;
+    }
+
+    AARTSAAPI_Result SetNodeText(SimConfigNode* node, const std::wstring& value)
+    {
+        switch (node->type)
+        {
+        case AARTSAAPI_CONFIG_TYPE_ENUM:
+        {
+            std::vector<std::wstring> options = SplitOptions(node->options);
+            for (size_t i = 0; i < options.size(); i++)
+            {
+                if (EqualsNoCase(options[i], value))
+                {
+                    node->number = double(i);
+                    node->text = options[i];
+                    return AARTSAAPI_OK;
+                }
+            }
+            return AARTSAAPI_ERROR_VALUE_INVALID;
+        }
+        case AARTSAAPI_CONFIG_TYPE_BOOL:
+            if (EqualsNoCase(value, L"true") || value == L"1")
+                node->number = 1;
+            else if (EqualsNoCase(value, L"false") || value == L"0")
+                node->number = 0;
+            else
+                return AARTSAAPI_ERROR_VALUE_MALFORMED;
+            node->text = node->number != 0 ? L"true" : L"false";
+            return AARTSAAPI_OK;
+        case AARTSAAPI_CONFIG_TYPE_NUMBER:
+        {
+            wchar_t* end = nullptr;
+            double number = std::wcstod(value.c_str(), &end);
+            if (end == value.c_str())
+                return AARTSAAPI_ERROR_VALUE_MALFORMED;
+            node->number = std::min(node->maxValue, std::max(node->minValue, number));
+            return node->number == number ? AARTSAAPI_OK : AARTSAAPI_WARNING_VALUE_ADJUSTED;
+        }
+        case AARTSAAPI_CONFIG_TYPE_STRING:
+        case AARTSAAPI_CONFIG_TYPE_BLOB:
+            node->text = value;
+            return AARTSAAPI_OK;
+        default:
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        }
+    }
+
+    AARTSAAPI_Result SetNodeNumber(SimConfigNode* node, double value)
+    {
+        switch (node->type)
+        {
+        case AARTSAAPI_CONFIG_TYPE_ENUM:
+        case AARTSAAPI_CONFIG_TYPE_BOOL:
+        {
+            int64_t index = int64_t(std::llround(value));
+            if (index < 0 || index > int64_t(node->maxValue))
+                return AARTSAAPI_ERROR_VALUE_INVALID;
+            node->number = double(index);
+            if (node->type == AARTSAAPI_CONFIG_TYPE_ENUM)
+                node->text = SplitOptions(node->options)[size_t(index)];
+            else
+                node->text = index ? L"true" : L"false";
+            return AARTSAAPI_OK;
+        }
+        case AARTSAAPI_CONFIG_TYPE_NUMBER:
+            node->number = std::min(node->maxValue, std::max(node->minValue, value));
+            return node->number == value ? AARTSAAPI_OK : AARTSAAPI_WARNING_VALUE_ADJUSTED;
+        case AARTSAAPI_CONFIG_TYPE_STRING:
+            node->text = FormatNumber(value);
+            return AARTSAAPI_OK;
+        default:
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        }
+    }
+
+    std::wstring NodeText(SimConfigNode* node)
+    {
+        if (node->type == AARTSAAPI_CONFIG_TYPE_NUMBER)
+            return FormatNumber(node->number);
+        return node->text;
+    }
+
+    double NodeNumber(SimConfigNode* node)
+    {
+        if (node->type == AARTSAAPI_CONFIG_TYPE_STRING)
+            return std::wcstod(node->text.c_str(), nullptr);
+        return node->number;
+    }
+}
+
+extern "C"
+{
+    AARTSAAPI_Result AARTSAAPI_Init(uint32_t memory)
+    {
+        SimLibrary& lib = Library();
+        std::lock_guard<std::mutex> guard(lib.lock);
+        lib.initialized = true;
+        lib.memory = memory;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_Init_With_Path(uint32_t memory, const wchar_t* path)
+    {
+        (void)path;
+        return AARTSAAPI_Init(memory);
+    }
+
+    AARTSAAPI_Result AARTSAAPI_Shutdown(void)
+    {
+        SimLibrary& lib = Library();
+        std::lock_guard<std::mutex> guard(lib.lock);
+        lib.handles.clear();
+        lib.initialized = false;
+        return AARTSAAPI_OK;
+    }
+
+    uint32_t AARTSAAPI_Version(void)
+    {
+        return 0x00010000;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_Open(AARTSAAPI_Handle* handle)
+    {
+        SimLibrary& lib = Library();
+        std::lock_guard<std::mutex> guard(lib.lock);
+        if (!lib.initialized)
+            return AARTSAAPI_ERROR_NOT_INITIALIZED;
+        if (!handle)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        lib.handles.emplace_back(new SimHandle());
+        handle->d = lib.handles.back().get();
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_Close(AARTSAAPI_Handle* handle)
+    {
+        SimLibrary& lib = Library();
+        std::lock_guard<std::mutex> guard(lib.lock);
+        if (!handle || !handle->d)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        for (auto it = lib.handles.begin(); it != lib.handles.end(); ++it)
+        {
+            if (it->get() == handle->d)
+            {
+                lib.handles.erase(it);
+                handle->d = nullptr;
+                return AARTSAAPI_OK;
+            }
+        }
+        return AARTSAAPI_ERROR_NOT_OPEN;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_RescanDevices(AARTSAAPI_Handle* handle, int timeout)
+    {
+        (void)timeout;
+        return handle && handle->d ? AARTSAAPI_OK : AARTSAAPI_ERROR_NOT_OPEN;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ResetDevices(AARTSAAPI_Handle* handle)
+    {
+        return handle && handle->d ? AARTSAAPI_OK : AARTSAAPI_ERROR_NOT_OPEN;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_EnumDevice(AARTSAAPI_Handle* handle, const wchar_t* type, int32_t index, AARTSAAPI_DeviceInfo* dinfo)
+    {
+        if (!handle || !handle->d)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (!type || !dinfo)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+
+        std::wstring family(type);
+        if (family != L"spectranv6" && family != L"spectranv6eco")
+            return AARTSAAPI_ERROR_NOT_FOUND;
+        if (index < 0 || index >= EnvInteger("AARTSAAPI_SIM_DEVICES", 1))
+            return AARTSAAPI_ERROR_NOT_FOUND;
+
+        wchar_t serial[32];
+        std::swprintf(serial, sizeof(serial) / sizeof(wchar_t), family == L"spectranv6" ? L"SIMV6%05d" : L"SIMECO%05d", int(index));
+        CopyWide(dinfo->serialNumber, sizeof(dinfo->serialNumber) / sizeof(wchar_t), serial);
+        dinfo->ready = true;
+        dinfo->boost = family == L"spectranv6";
+        dinfo->superspeed = true;
+        dinfo->active = false;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_OpenDevice(AARTSAAPI_Handle* handle, AARTSAAPI_Device* dhandle, const wchar_t* type, const wchar_t* serialNumber)
+    {
+        if (!handle || !handle->d)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (!dhandle || !type || !serialNumber)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+
+        std::wstring fullType(type);
+        size_t slash = fullType.find(L'/');
+        if (slash == std::wstring::npos)
+            return AARTSAAPI_ERROR_NOT_FOUND;
+
+        std::unique_ptr<SimDevice> dev(new SimDevice());
+        dev->family = fullType.substr(0, slash);
+        dev->mode = fullType.substr(slash + 1);
+        dev->serial = serialNumber;
+
+        static const wchar_t* modes[] = { L"raw", L"iqreceiver", L"iqtransceiver", L"iqtransmitter", L"sweepsa", L"rtsa" };
+        bool known = false;
+        for (const wchar_t* mode : modes)
+            known = known || dev->mode == mode;
+        if ((dev->family != L"spectranv6" && dev->family != L"spectranv6eco") || !known)
+            return AARTSAAPI_ERROR_NOT_FOUND;
+
+        const char* replayFile = std::getenv("AARTSAAPI_SIM_REPLAY");
+        if (replayFile && *replayFile)
+        {
+            dev->replay.reset(new AarRtsaSdkWrapper::PacketRecordingReader());
+            if (!dev->replay->open(replayFile))
+                return AARTSAAPI_ERROR_NOT_FOUND;
+
+            std::wstring recordedType(dev->replay->deviceType().begin(), dev->replay->deviceType().end());
+            if (!EqualsNoCase(recordedType, fullType))
+                return AARTSAAPI_ERROR_NOT_FOUND;
+
+            dev->replaySpeed = EnvDouble("AARTSAAPI_SIM_REPLAY_SPEED", 1.0);
+            dev->replayLoop = EnvInteger("AARTSAAPI_SIM_REPLAY_LOOP", 0) != 0;
+        }
+
+        BuildConfigTree(dev.get());
+        SetNodeText(FindPath(dev->root.get(), L"device/serial"), dev->serial);
+
+        SimLibrary& lib = Library();
+        std::lock_guard<std::mutex> guard(lib.lock);
+        SimHandle* sh = static_cast<SimHandle*>(handle->d);
+        dhandle->d = dev.get();
+        sh->devices.push_back(std::move(dev));
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_CloseDevice(AARTSAAPI_Handle* handle, AARTSAAPI_Device* dhandle)
+    {
+        if (!handle || !handle->d)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+
+        SimLibrary& lib = Library();
+        std::lock_guard<std::mutex> guard(lib.lock);
+        SimHandle* sh = static_cast<SimHandle*>(handle->d);
+        for (auto it = sh->devices.begin(); it != sh->devices.end(); ++it)
+        {
+            if (dhandle && it->get() == dhandle->d)
+            {
+                sh->devices.erase(it);
+                dhandle->d = nullptr;
+                return AARTSAAPI_OK;
+            }
+        }
+        return AARTSAAPI_ERROR_NOT_OPEN;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConnectDevice(AARTSAAPI_Device* dhandle)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+
+        int connectMs = EnvInteger("AARTSAAPI_SIM_CONNECT_MS", 0);
+        if (connectMs > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(connectMs));
+
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (dev->state == SIM_STATE_IDLE)
+        {
+            dev->state = SIM_STATE_CONNECTED;
+            dev->streamTimeBase = WallClockSeconds();
+            dev->steadyBase = std::chrono::steady_clock::now();
+            dev->healthTime = dev->steadyBase;
+        }
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_DisconnectDevice(AARTSAAPI_Device* dhandle)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        for (SimChannel& ch : dev->channels)
+            ClearQueue(ch);
+        dev->state = SIM_STATE_IDLE;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_StartDevice(AARTSAAPI_Device* dhandle)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (dev->state == SIM_STATE_IDLE)
+            return AARTSAAPI_ERROR_NOT_CONNECTED;
+        if (dev->state == SIM_STATE_RUNNING)
+            return AARTSAAPI_OK;
+
+        ApplyConfig(dev);
+        double now = StreamTimeNow(dev);
+        for (SimChannel& ch : dev->channels)
+        {
+            ClearQueue(ch);
+            ch.nextTime = now;
+            ch.nextFlags = dev->replay ? 0 : AARTSAAPI_PACKET_STREAM_START | AARTSAAPI_PACKET_SEGMENT_START;
+        }
+        if (dev->replay)
+            RewindReplay(dev);
+        dev->state = SIM_STATE_RUNNING;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_StopDevice(AARTSAAPI_Device* dhandle)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (dev->state == SIM_STATE_RUNNING)
+            dev->state = SIM_STATE_CONNECTED;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_GetDeviceState(AARTSAAPI_Device* dhandle)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        switch (dev->state)
+        {
+        case SIM_STATE_RUNNING:
+            return AARTSAAPI_RUNNING;
+        case SIM_STATE_CONNECTED:
+            return AARTSAAPI_CONNECTED;
+        default:
+            return AARTSAAPI_IDLE;
+        }
+    }
+
+    AARTSAAPI_Result AARTSAAPI_AvailPackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t* num)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (channel < 0 || channel > 1 || !num)
+            return AARTSAAPI_ERROR_INVALID_CHANNEL;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        SimChannel& ch = dev->channels[channel];
+        PumpChannel(dev, ch);
+        *num = int32_t(ch.queue.size());
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_GetPacket(AARTSAAPI_Device* dhandle, int32_t channel, int32_t index, AARTSAAPI_Packet* packet)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (channel < 0 || channel > 1)
+            return AARTSAAPI_ERROR_INVALID_CHANNEL;
+        if (!packet || index < 0)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+
+        std::lock_guard<std::mutex> guard(dev->lock);
+        SimChannel& ch = dev->channels[channel];
+        if (size_t(index) >= ch.queue.size())
+            PumpChannel(dev, ch);
+        if (size_t(index) >= ch.queue.size())
+            return AARTSAAPI_EMPTY;
+
+        int64_t cbsize = packet->cbsize;
+        size_t bytes = cbsize > 0 ? std::min<size_t>(size_t(cbsize), sizeof(AARTSAAPI_Packet)) : sizeof(AARTSAAPI_Packet);
+        std::memcpy(packet, &ch.queue[size_t(index)]->packet, bytes);
+        packet->cbsize = cbsize > 0 ? cbsize : int64_t(sizeof(AARTSAAPI_Packet));
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConsumePackets(AARTSAAPI_Device* dhandle, int32_t channel, int32_t num)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (channel < 0 || channel > 1)
+            return AARTSAAPI_ERROR_INVALID_CHANNEL;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        SimChannel& ch = dev->channels[channel];
+        for (int32_t i = 0; i < num && !ch.queue.empty(); i++)
+        {
+            ch.freeSlots.push_back(ch.queue.front());
+            ch.queue.pop_front();
+        }
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_GetMasterStreamTime(AARTSAAPI_Device* dhandle, double& stime)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (dev->state == SIM_STATE_IDLE)
+            return AARTSAAPI_ERROR_NOT_CONNECTED;
+        stime = dev->replay ? dev->replayStreamTime : StreamTimeNow(dev);
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_SendPacket(AARTSAAPI_Device* dhandle, int32_t channel, const AARTSAAPI_Packet* packet)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (channel != 0 || (dev->mode != L"iqtransmitter" && dev->mode != L"iqtransceiver"))
+            return AARTSAAPI_ERROR_INVALID_CHANNEL;
+        if (!packet || packet->num < 0 || (packet->num > 0 && (!packet->fp32 || packet->size < 2 || packet->stride < packet->size)))
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (dev->state == SIM_STATE_IDLE)
+            return AARTSAAPI_ERROR_NOT_CONNECTED;
+        dev->txSamples += packet->num;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigRoot(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (!config)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        config->d = dev->root.get();
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigHealth(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        if (!dev)
+            return AARTSAAPI_ERROR_NOT_OPEN;
+        if (!config)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (dev->state != SIM_STATE_IDLE)
+            UpdateHealth(dev);
+        config->d = dev->health.get();
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigFirst(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config)
+    {
+        SimConfigNode* node = ConfigOf(group);
+        if (!DeviceOf(dhandle) || !node || !config)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        if (node->children.empty())
+            return AARTSAAPI_EMPTY;
+        config->d = node->children.front().get();
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigNext(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config)
+    {
+        SimConfigNode* parent = ConfigOf(group);
+        SimConfigNode* node = ConfigOf(config);
+        if (!DeviceOf(dhandle) || !parent || !node || node->parent != parent)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        size_t next = node->indexInParent + 1;
+        if (next >= parent->children.size())
+            return AARTSAAPI_EMPTY;
+        config->d = parent->children[next].get();
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigFind(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* group, AARTSAAPI_Config* config, const wchar_t* name)
+    {
+        SimConfigNode* node = ConfigOf(group);
+        if (!DeviceOf(dhandle) || !node || !config || !name)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        SimConfigNode* found = FindPath(node, name);
+        if (!found || found == node)
+            return AARTSAAPI_ERROR_NOT_FOUND;
+        config->d = found;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigGetName(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, wchar_t* name)
+    {
+        SimConfigNode* node = ConfigOf(config);
+        if (!DeviceOf(dhandle) || !node || !name)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        CopyWide(name, 80, node->name);
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigGetInfo(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, AARTSAAPI_ConfigInfo* cinfo)
+    {
+        SimConfigNode* node = ConfigOf(config);
+        if (!DeviceOf(dhandle) || !node || !cinfo)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        CopyWide(cinfo->name, sizeof(cinfo->name) / sizeof(wchar_t), node->name);
+        CopyWide(cinfo->title, sizeof(cinfo->title) / sizeof(wchar_t), node->title);
+        CopyWide(cinfo->unit, sizeof(cinfo->unit) / sizeof(wchar_t), node->unit);
+        CopyWide(cinfo->options, sizeof(cinfo->options) / sizeof(wchar_t), node->options);
+        cinfo->type = node->type;
+        cinfo->minValue = node->minValue;
+        cinfo->maxValue = node->maxValue;
+        cinfo->stepValue = node->stepValue;
+        cinfo->disabledOptions = 0;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigSetFloat(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, double value)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        SimConfigNode* node = ConfigOf(config);
+        if (!dev || !node)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (IsHealthNode(dev, node))
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        dev->configDirty = true;
+        return SetNodeNumber(node, value);
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigGetFloat(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, double* value)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        SimConfigNode* node = ConfigOf(config);
+        if (!dev || !node || !value)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        *value = NodeNumber(node);
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigSetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, const wchar_t* value)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        SimConfigNode* node = ConfigOf(config);
+        if (!dev || !node || !value)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (IsHealthNode(dev, node))
+            return AARTSAAPI_ERROR_INVALID_CONFIG;
+        dev->configDirty = true;
+        return SetNodeText(node, value);
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigGetString(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, wchar_t* value, int64_t* size)
+    {
+        SimDevice* dev = DeviceOf(dhandle);
+        SimConfigNode* node = ConfigOf(config);
+        if (!dev || !node || !size)
+            return AARTSAAPI_ERROR_INVALID_PARAMETR;
+        std::lock_guard<std::mutex> guard(dev->lock);
+        std::wstring text = NodeText(node);
+        int64_t required = int64_t(text.size()) + 1;
+        if (!value || *size < required)
+        {
+            *size = required;
+            return AARTSAAPI_ERROR_BUFFER_SIZE;
+        }
+        CopyWide(value, size_t(*size), text);
+        *size = required;
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigSetInteger(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, int64_t value)
+    {
+        return AARTSAAPI_ConfigSetFloat(dhandle, config, double(value));
+    }
+
+    AARTSAAPI_Result AARTSAAPI_ConfigGetInteger(AARTSAAPI_Device* dhandle, AARTSAAPI_Config* config, int64_t* value)
+    {
+        double number = 0;
+        AARTSAAPI_Result res = AARTSAAPI_ConfigGetFloat(dhandle, config, &number);
+        if (res == AARTSAAPI_OK && value)
+            *value = int64_t(std::llround(number));
+        return res;
+    }
+}
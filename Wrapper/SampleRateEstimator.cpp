@@ -0,0 +1,83 @@
+#include "SampleRateEstimator.h"
+#include <cmath>
+
+namespace AarRtsaSdkWrapper
+{
+
+    SampleRateEstimator::SampleRateEstimator(double halfLifePackets, uint64_t minPackets)
+        : m_decay(halfLifePackets > 0 ? std::exp2(-1.0 / halfLifePackets) : 1.0), m_minPackets(minPackets < 3 ? 3 : minPackets), m_restarts(0)
+    {
+        restart();
+        m_restarts = 0;
+    }
+
+    void SampleRateEstimator::restart()
+    {
+        m_restarts++;
+        m_packets = 0;
+        m_origin = 0;
+        m_delivered = 0;
+        m_nominalRate = 0;
+        m_weight = m_meanT = m_meanN = m_ctt = m_ctn = m_sse = 0;
+    }
+
+    void SampleRateEstimator::add(const AARTSAAPI_Packet& packet)
+    {
+        if ((packet.flags & (AARTSAAPI_PACKET_STREAM_START | AARTSAAPI_PACKET_SEGMENT_START)) && m_packets > 0)
+            restart();
+        add(packet.startTime, packet.num, packet.stepFrequency);
+    }
+
+    void SampleRateEstimator::add(double startTime, int64_t samples, double nominalRate)
+    {
+        if (m_packets == 0)
+            m_origin = startTime;
+        m_packets++;
+        m_nominalRate = nominalRate;
+
+        // West's weighted update, relative to the first packet to keep the
+        // precision of large timestamps
+        double t = startTime - m_origin, n = m_delivered;
+        double dt = t - m_meanT, dn = n - m_meanN;
+
+        // The residual sum grows by the prediction error of the previous fit,
+        // scaled by its leverage, which avoids subtracting the large co-moments
+        if (m_ctt > 0)
+        {
+            double error = dn - m_ctn / m_ctt * dt;
+            double leverage = 1.0 + (1.0 / m_weight + dt * dt / m_ctt) / m_decay;
+            m_sse = m_decay * m_sse + error * error / leverage;
+        }
+
+        m_weight = m_decay * m_weight + 1.0;
+        m_meanT += dt / m_weight;
+        m_meanN += dn / m_weight;
+        m_ctt = m_decay * m_ctt + dt * (t - m_meanT);
+        m_ctn = m_decay * m_ctn + dt * (n - m_meanN);
+
+        m_delivered += double(samples > 0 ? samples : 0);
+    }
+
+    SampleRateEstimate SampleRateEstimator::estimate() const
+    {
+        SampleRateEstimate est = {};
+        est.packets = m_packets;
+        est.nominalRate = m_nominalRate;
+        if (m_packets < 2 || m_ctt <= 0)
+            return est;
+
+        est.rate = m_ctn / m_ctt;
+        if (m_nominalRate > 0)
+            est.driftPpm = (est.rate / m_nominalRate - 1.0) * 1e6;
+
+        // Residuals of the sample count, as time through the fitted rate
+        if (m_weight > 2 && est.rate > 0)
+        {
+            double residual = m_sse / (m_weight - 2);
+            est.jitter = std::sqrt(residual) / est.rate;
+            est.errorPpm = std::sqrt(residual / m_ctt) / est.rate * 1e6;
+        }
+        est.valid = m_packets >= m_minPackets && est.rate > 0;
+        return est;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SAMPLERATEESTIMATOR_H
+#define SAMPLERATEESTIMATOR_H
+
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct SampleRateEstimate
+    {
+        uint64_t packets;       // in the current fit
+        double rate;            // samples per second of device time
+        double nominalRate;     // stepFrequency of the latest packet
+        double driftPpm;        // rate against nominalRate
+        double errorPpm;        // standard error of rate
+        double jitter;          // standard deviation of the packet start times from the fit, in seconds
+        bool valid;             // enough packets for the figures above
+    };
+
+    // Estimates the sample rate of a stream from the packet timestamps instead of
+    // the wall clock: a streaming least squares fit of the samples delivered so
+    // far against the packet startTime. Each packet is one O(1) update of running
+    // means and co-moments, so it can run on the acquisition thread. Works for any
+    // receiver clock and decimation, the packet stepFrequency is only used as
+    // reference for the drift.
+    //
+    // A stream or segment start restarts the fit, since the samples lost in
+    // between are unknown. With a half life, older packets fade out
+    // exponentially and the estimate follows a drifting clock. Not thread safe.
+    class SampleRateEstimator
+    {
+    public:
+        // halfLifePackets 0 weights all packets of the fit equally
+        explicit SampleRateEstimator(double halfLifePackets = 0, uint64_t minPackets = 8);
+
+        void add(const AARTSAAPI_Packet& packet);
+        void add(double startTime, int64_t samples, double nominalRate);
+
+        // Ends the current fit, the next packet starts a new one
+        void restart();
+
+        SampleRateEstimate estimate() const;
+
+        // Fits ended since construction
+        uint64_t restarts() const { return m_restarts; }
+
+    private:
+        double m_decay;
+        uint64_t m_minPackets;
+        uint64_t m_restarts;
+
+        uint64_t m_packets;
+        double m_origin;        // startTime of the first packet of the fit
+        double m_delivered;     // samples of the fit before the next packet
+        double m_nominalRate;
+
+        // Weighted running means and co-moments of time t and sample count n,
+        // and the sum of squared residuals
+        double m_weight, m_meanT, m_meanN, m_ctt, m_ctn, m_sse;
+    };
+}
+
+#endif
@@ -0,0 +1,218 @@
+#include "BenchmarkSupport.h"
+#include "SampleRateEstimator.h"
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// Feeds SampleRateEstimator synthetic packet timestamps of a clock off by a
+// known ppm with known Gaussian jitter, at epoch times like the device's.
+// Checks per case that the drift lies within four standard errors, that the
+// reported standard error matches the spread of the drift over many runs, that
+// the jitter is the one added, when the estimate becomes valid, that stream
+// and segment starts restart the fit across lost samples, and that a half
+// life follows a drifting clock. Then times one update. Runs without a
+// device; takes the packets per run and the samples per packet.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const double NominalRate = 1e6;
+    const double EpochStart = 1.7e9;
+    const uint64_t MinPackets = 8;
+
+    // Clock of a stream: the true time of the next sample, with a ppm offset
+    // that may change linearly over the run. The time runs on from the start
+    // and is rounded to an epoch timestamp once per packet; summing epoch
+    // timestamps would round every step the same way, a drift of its own.
+    struct StreamClock
+    {
+        double ppm, ppmPerSecond;
+        double start, elapsed;
+
+        StreamClock(double ppm, double ppmPerSecond = 0, double start = EpochStart)
+            : ppm(ppm), ppmPerSecond(ppmPerSecond), start(start), elapsed(0)
+        {
+        }
+
+        double rateNow() const { return NominalRate * (1 + (ppm + ppmPerSecond * elapsed) * 1e-6); }
+
+        // Packet of samples at the current sample, stamped with jitter; the
+        // clock then moves past it
+        AARTSAAPI_Packet next(size_t samples, double jitter, std::mt19937& random, uint64_t flags = 0)
+        {
+            AARTSAAPI_Packet packet = AARTSAAPI_Packet();
+            packet.num = packet.total = int64_t(samples);
+            packet.size = packet.stride = 2;
+            packet.stepFrequency = NominalRate;
+            packet.startTime = start + (elapsed + (jitter > 0 ? std::normal_distribution<double>(0.0, jitter)(random) : 0.0));
+            packet.endTime = packet.startTime + double(samples) / NominalRate;
+            packet.flags = flags;
+            skip(samples);
+            return packet;
+        }
+
+        void skip(size_t samples) { elapsed += double(samples) / rateNow(); }
+    };
+
+    bool fail(const std::string& message)
+    {
+        std::cerr << "SampleRateEstimator check failed: " << message << std::endl;
+        return false;
+    }
+
+    // Drift and jitter of one clock over many runs: the drift of every run
+    // within four standard errors, the reported standard error against the
+    // spread of the drift, the jitter against the one added
+    bool checkAccuracy(double ppm, double jitter, size_t packets, size_t samples)
+    {
+        const int runs = 64;
+        double squaredDeviation = 0, errorSum = 0, jitterSum = 0;
+        for (int run = 0; run < runs; run++)
+        {
+            // A start of its own per run, so the timestamp rounding differs too
+            std::mt19937 random(uint32_t(run + 1));
+            StreamClock clock(ppm, 0, EpochStart + std::uniform_real_distribution<double>(0.0, 1.0)(random));
+            SampleRateEstimator estimator;
+            for (size_t p = 0; p < packets; p++)
+            {
+                estimator.add(clock.next(samples, jitter, random, p == 0 ? AARTSAAPI_PACKET_STREAM_START : 0));
+                bool valid = estimator.estimate().valid;
+                if (valid != (p + 1 >= MinPackets))
+                    return fail("valid is " + std::string(valid ? "set" : "clear") + " after " + std::to_string(p + 1) + " packets");
+            }
+
+            SampleRateEstimate est = estimator.estimate();
+            double deviation = est.driftPpm - ppm;
+            if (est.packets != packets || std::fabs(deviation) > 4 * est.errorPpm + 1e-3)
+                return fail("drift " + std::to_string(est.driftPpm) + " ppm +- " + std::to_string(est.errorPpm) + " for a clock off by "
+                    + std::to_string(ppm) + " ppm");
+            squaredDeviation += deviation * deviation;
+            errorSum += est.errorPpm;
+            jitterSum += est.jitter;
+        }
+
+        // Timestamps near 1.7e9 s resolve to about 0.24 us, which shows as jitter
+        const double resolution = std::nextafter(EpochStart, 2 * EpochStart) - EpochStart;
+        double spread = std::sqrt(squaredDeviation / runs), error = errorSum / runs, measuredJitter = jitterSum / runs;
+        double expectedJitter = std::sqrt(jitter * jitter + resolution * resolution / 12);
+        std::cout << std::setw(8) << std::setprecision(1) << ppm << std::setw(10) << jitter * 1e6
+            << std::setw(14) << std::setprecision(4) << spread << std::setw(13) << error
+            << std::setw(16) << std::setprecision(3) << measuredJitter * 1e6 << std::endl;
+        // Rounding alone is no independent noise, its standard error is only a bound
+        if (jitter > 0 ? spread > 1.5 * error || spread < 0.6 * error : spread > error)
+            return fail("standard error " + std::to_string(error) + " ppm against a spread of " + std::to_string(spread) + " ppm");
+        if (jitter > 0 ? std::fabs(measuredJitter / expectedJitter - 1) > 0.1 : measuredJitter > resolution)
+            return fail("jitter " + std::to_string(measuredJitter * 1e6) + " us for " + std::to_string(jitter * 1e6) + " us added");
+        return true;
+    }
+
+    // Samples lost between two runs of packets throw a single fit off; a
+    // SEGMENT_START, and then a STREAM_START, on the packet behind the loss
+    // restarts it
+    bool checkRestart(size_t packets, size_t samples)
+    {
+        const double ppm = 12.5, jitter = 1e-6;
+        std::mt19937 random(7);
+        StreamClock clock(ppm);
+        SampleRateEstimator estimator, unflagged;
+        uint64_t restarts = 0;
+        for (uint64_t flag : { uint64_t(AARTSAAPI_PACKET_STREAM_START), uint64_t(AARTSAAPI_PACKET_SEGMENT_START), uint64_t(AARTSAAPI_PACKET_STREAM_START) })
+        {
+            for (size_t p = 0; p < packets; p++)
+            {
+                AARTSAAPI_Packet packet = clock.next(samples, jitter, random, p == 0 ? flag : 0);
+                estimator.add(packet);
+                unflagged.add(packet.startTime, packet.num, packet.stepFrequency);
+            }
+            clock.skip(samples * 37 / 10);
+
+            SampleRateEstimate est = estimator.estimate();
+            if (estimator.restarts() != restarts || est.packets != packets)
+                return fail(std::to_string(estimator.restarts()) + " restarts and " + std::to_string(est.packets) + " packets in the fit after "
+                    + std::to_string(restarts) + " flagged starts");
+            if (!est.valid || std::fabs(est.driftPpm - ppm) > 4 * est.errorPpm)
+                return fail("drift " + std::to_string(est.driftPpm) + " ppm after restart " + std::to_string(restarts));
+            restarts++;
+        }
+
+        SampleRateEstimate est = estimator.estimate(), lost = unflagged.estimate();
+        std::cout << "Restart        : drift " << std::setprecision(3) << est.driftPpm << " +- " << est.errorPpm << " ppm after "
+            << estimator.restarts() << " restarts, " << lost.driftPpm << " +- " << lost.errorPpm << " ppm without them" << std::endl;
+        if (std::fabs(lost.driftPpm - ppm) < 4 * lost.errorPpm)
+            return fail("the lost samples went unnoticed without restarts");
+        return true;
+    }
+
+    // A clock drifting 2 ppm per second: an equally weighted fit reads the
+    // offset halfway through the run, one with a half life follows the clock
+    // at a lag of twice the mean age of its packets, halfLife / ln 2
+    bool checkHalfLife(size_t samples)
+    {
+        const size_t packets = 4000;
+        const double halfLife = 64;
+        std::mt19937 random(3);
+        StreamClock clock(0, 2);
+        SampleRateEstimator fading(halfLife), equal;
+        for (size_t p = 0; p < packets; p++)
+        {
+            AARTSAAPI_Packet packet = clock.next(samples, 0.1e-6, random);
+            fading.add(packet);
+            equal.add(packet);
+        }
+
+        const double seconds = double(packets * samples) / NominalRate;
+        const double lagged = 2 * (seconds - 2 * halfLife / std::log(2.0) * double(samples) / NominalRate);
+        SampleRateEstimate fade = fading.estimate(), all = equal.estimate();
+        std::cout << "Half life      : clock at " << std::setprecision(2) << 2 * seconds << " ppm after " << seconds << " s, " << size_t(halfLife)
+            << " packets half life " << fade.driftPpm << " +- " << fade.errorPpm << " ppm (expected " << lagged << "), all packets "
+            << all.driftPpm << " ppm" << std::endl;
+        const double slack = 0.02 * 2 * seconds;
+        if (std::fabs(fade.driftPpm - lagged) > 4 * fade.errorPpm + slack || std::fabs(all.driftPpm - seconds) > 4 * all.errorPpm + slack)
+            return fail("the half life fit does not follow the drifting clock");
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t packets = NumberArgument<size_t>(argc, argv, 1, 1000);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 1024);
+
+    std::cout << "Accuracy       : " << packets << " packets of " << samples << " samples at " << NominalRate / 1e6
+        << " MS/s, 64 runs per clock" << std::endl
+        << "     ppm  jitter us  drift spread  std. error  jitter read us" << std::endl << std::fixed;
+    const double cases[][2] = { { 0, 0 }, { -25, 0 }, { 3.5, 1e-6 }, { 40, 1e-6 }, { -8, 20e-6 } };
+    for (const double* c : cases)
+    {
+        if (!checkAccuracy(c[0], c[1], packets, samples))
+            return -1;
+    }
+    std::cout << std::endl;
+    if (!checkRestart(packets, samples) || !checkHalfLife(samples))
+        return -1;
+
+    // One update per packet on the acquisition thread
+    std::mt19937 random(1);
+    StreamClock clock(10);
+    std::vector<AARTSAAPI_Packet> stream;
+    for (size_t p = 0; p < 4096; p++)
+        stream.push_back(clock.next(samples, 1e-6, random));
+    const double span = clock.elapsed;
+    SampleRateEstimator estimator(256);
+    const size_t updates = 1000 * packets;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < updates; k++)
+    {
+        // The recorded stream repeated, its timestamps running on
+        AARTSAAPI_Packet packet = stream[k % stream.size()];
+        packet.startTime += double(k / stream.size()) * span;
+        estimator.add(packet);
+    }
+    double seconds = SecondsSince(start);
+    DoNotOptimize(estimator);
+    std::cout << std::endl << "Update         : " << std::setprecision(1) << seconds / double(updates) * 1e9 << " ns per packet" << std::endl;
+
+    return 0;
+}
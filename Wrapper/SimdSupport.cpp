@@ -0,0 +1,63 @@
+#include "SimdSupport.h"
+
+#if defined(WRAPPER_SIMD_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        SimdLevel detect()
+        {
+#if defined(WRAPPER_SIMD_AVX2) && (defined(__GNUC__) || defined(__clang__))
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return SimdLevel::AVX2;
+#elif defined(WRAPPER_SIMD_AVX2)
+            // AVX2 in CPUID leaf 7, the OS has to save the YMM registers as well
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] >= 7)
+            {
+                __cpuid(info, 1);
+                bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+                __cpuidex(info, 7, 0);
+                if (osxsave && avx && (info[1] & (1 << 5)) && (_xgetbv(0) & 6) == 6)
+                    return SimdLevel::AVX2;
+            }
+#endif
+#if defined(WRAPPER_SIMD_SSE2)
+            return SimdLevel::SSE2;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+    }
+
+    SimdLevel DetectSimdLevel()
+    {
+        static const SimdLevel level = detect();
+        return level;
+    }
+
+    SimdLevel ClampSimdLevel(SimdLevel level)
+    {
+        SimdLevel best = DetectSimdLevel();
+        return int(level) > int(best) ? best : level;
+    }
+
+    const char* SimdLevelName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::SSE2:
+            return "SSE2";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        default:
+            return "scalar";
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SIMDSUPPORT_H
+#define SIMDSUPPORT_H
+
+// x86 builds always have SSE2, the AVX2 kernels are compiled per function and
+// only called when the CPU reports AVX2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WRAPPER_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define WRAPPER_SIMD_AVX2 1
+#define WRAPPER_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER)
+#define WRAPPER_SIMD_AVX2 1
+#define WRAPPER_TARGET_AVX2
+#endif
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    enum class SimdLevel
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Best level the build and the CPU support, detected once
+    SimdLevel DetectSimdLevel();
+
+    // level limited to what DetectSimdLevel allows
+    SimdLevel ClampSimdLevel(SimdLevel level);
+
+    const char* SimdLevelName(SimdLevel level);
+}
+
+#endif
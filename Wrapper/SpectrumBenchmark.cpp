@@ -0,0 +1,177 @@
+#include "BenchmarkSupport.h"
+#include "SpectrumEngine.h"
+#include <cmath>
+#include <iomanip>
+#include <numbers>
+#include <random>
+#include <vector>
+
+// Turns a stream of IQ packets into host FFT spectra. Checks per window the
+// level of a tone centered on a bin and halfway between two, the noise floor
+// against the one the window's noise bandwidth predicts, the max, avg and min
+// merges on noise, and that every SIMD level gives the scalar spectra. Then
+// counts spectra per second by FFT size on worker pools of one thread up to
+// one per core. Runs without a device; takes the packets per run and the
+// samples per packet.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const double InputRate = 10e6;
+
+    // Tone of the given amplitude plus complex white noise of the given power
+    std::vector<AARTSAAPI_Packet> makePackets(std::vector<float>& iq, size_t packets, size_t samples, double offset, double amplitude, double noisePower)
+    {
+        iq.resize(2 * packets * samples);
+        std::mt19937 random(11);
+        std::normal_distribution<double> noise(0.0, std::sqrt(noisePower / 2));
+        for (size_t j = 0; j < packets * samples; j++)
+        {
+            double phase = 2 * std::numbers::pi * offset * double(j) / InputRate;
+            iq[2 * j] = float(amplitude * std::cos(phase) + (noisePower > 0 ? noise(random) : 0.0));
+            iq[2 * j + 1] = float(amplitude * std::sin(phase) + (noisePower > 0 ? noise(random) : 0.0));
+        }
+
+        std::vector<AARTSAAPI_Packet> list(packets);
+        for (size_t p = 0; p < packets; p++)
+        {
+            AARTSAAPI_Packet& packet = list[p];
+            packet = AARTSAAPI_Packet();
+            packet.num = packet.total = int64_t(samples);
+            packet.size = packet.stride = 2;
+            packet.fp32 = iq.data() + 2 * p * samples;
+            packet.stepFrequency = InputRate;
+            packet.spanFrequency = InputRate;
+            packet.startFrequency = 2400e6 - packet.spanFrequency / 2;
+            packet.startTime = 1000.0 + double(p * samples) / InputRate;
+            packet.endTime = packet.startTime + double(samples) / InputRate;
+        }
+        list[0].flags = AARTSAAPI_PACKET_STREAM_START;
+        return list;
+    }
+
+    // All spectra of a packet stream, one after another
+    std::vector<float> spectraOf(const SpectrumSettings& settings, const std::vector<AARTSAAPI_Packet>& in)
+    {
+        SpectrumEngine engine(settings);
+        std::vector<float> all;
+        for (const AARTSAAPI_Packet& packet : in)
+        {
+            AARTSAAPI_Packet out;
+            engine.process(packet, out);
+            all.insert(all.end(), out.fp32, out.fp32 + out.num * out.stride);
+        }
+        return all;
+    }
+
+    double peakOf(const std::vector<float>& spectra)
+    {
+        return spectra.empty() ? -400.0 : double(*std::max_element(spectra.begin(), spectra.end()));
+    }
+
+    // Mean of the bins in dB, averaged as power
+    double meanPowerDb(const std::vector<float>& spectra)
+    {
+        double sum = 0;
+        for (float db : spectra)
+            sum += std::pow(10.0, double(db) / 10);
+        return 10 * std::log10(sum / double(std::max<size_t>(1, spectra.size())));
+    }
+
+    const char* windowName(SpectrumWindow window)
+    {
+        const char* names[] = { "Hamming", "Hann", "Uniform", "Blackman", "Blackman Harris", "Flat Top" };
+        return names[int(window)];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t packets = NumberArgument<size_t>(argc, argv, 1, 200);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 65536);
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    // Accuracy with 1024 bins: a tone of amplitude 0.5 reads -6.02 dB
+    const size_t bins = 1024;
+    const double binWidth = InputRate / bins, noisePower = 1e-6;
+    std::vector<float> iq;
+    std::cout << "Accuracy       : " << bins << " bins, tone at -6.02 dB, noise " << 10 * std::log10(noisePower) << " dB per sample" << std::endl
+        << "window           noise bw  tone on bin  between bins  noise floor error" << std::endl;
+    for (SpectrumWindow window : { SpectrumWindow::Hamming, SpectrumWindow::Hann, SpectrumWindow::Uniform, SpectrumWindow::Blackman,
+             SpectrumWindow::BlackmanHarris, SpectrumWindow::FlatTop })
+    {
+        SpectrumSettings settings(bins);
+        settings.window = window;
+        double onBin = peakOf(spectraOf(settings, makePackets(iq, 4, 16384, 100 * binWidth, 0.5, 0)));
+        double between = peakOf(spectraOf(settings, makePackets(iq, 4, 16384, 100.5 * binWidth, 0.5, 0)));
+        double noiseBandwidth = SpectrumWindowTable::get(window, bins)->noiseBandwidth;
+        double expected = 10 * std::log10(noisePower * noiseBandwidth / bins);
+        double floorError = meanPowerDb(spectraOf(settings, makePackets(iq, 16, 16384, 0, 0, noisePower))) - expected;
+        std::cout << std::left << std::setw(16) << windowName(window) << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << noiseBandwidth << std::setw(13) << onBin << std::setw(14) << between << std::setw(19) << floorError << std::endl;
+    }
+
+    // Merges of 16 Welch averages of 4 frames each on noise, relative to the noise floor
+    {
+        std::vector<AARTSAAPI_Packet> in = makePackets(iq, 16, 65536, 0, 0, noisePower);
+        double expected = 10 * std::log10(noisePower * SpectrumWindowTable::get(SpectrumWindow::Hamming, bins)->noiseBandwidth / bins);
+        std::cout << std::endl << "Merge          : 16 averages of 4 frames on noise, mean bin relative to the floor" << std::endl;
+        for (SpectrumMerge merge : { SpectrumMerge::Max, SpectrumMerge::Avg, SpectrumMerge::Min })
+        {
+            SpectrumSettings settings(bins);
+            settings.average = 4;
+            settings.aggregate = 16;
+            settings.merge = merge;
+            std::cout << (merge == SpectrumMerge::Max ? "max" : merge == SpectrumMerge::Avg ? "avg" : "min") << std::setw(11)
+                << meanPowerDb(spectraOf(settings, in)) - expected << " dB" << std::endl;
+        }
+    }
+
+    // Every level against the scalar spectra
+    {
+        std::vector<AARTSAAPI_Packet> in = makePackets(iq, 8, 10000, 123456.0, 0.1, noisePower);
+        SpectrumSettings settings(bins);
+        settings.average = 3;
+        settings.level = SimdLevel::Scalar;
+        std::vector<float> reference = spectraOf(settings, in);
+        for (SimdLevel level : { SimdLevel::SSE2, SimdLevel::AVX2 })
+        {
+            settings.level = level;
+            if (ClampSimdLevel(level) == level && spectraOf(settings, in) != reference)
+            {
+                std::cerr << SimdLevelName(level) << " spectra differ from the scalar ones" << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    // Throughput
+    std::vector<AARTSAAPI_Packet> in = makePackets(iq, 8, samples, 123456.0, 0.1, noisePower);
+    std::cout << std::endl << "Throughput     : spectra/s, Hamming, overlap 0.5, " << SimdLevelName(DetectSimdLevel()) << std::endl << "fft size";
+    for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+        std::cout << std::setw(8) << threads << " thr";
+    std::cout << std::endl;
+    for (size_t size : { size_t(256), size_t(1024), size_t(4096), size_t(16384), size_t(65536) })
+    {
+        std::cout << std::setw(8) << size << std::setprecision(0);
+        for (size_t threads = 1; threads <= cores || threads == 1; threads *= 2)
+        {
+            WorkerPool pool{ WorkerPoolSettings(threads) };
+            SpectrumEngine engine{ SpectrumSettings(size) };
+            AARTSAAPI_Packet out;
+            size_t spectra = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t p = 0; p < packets; p++)
+            {
+                // The timestamps restart every 8 packets, like a new segment
+                spectra += engine.process(in[p % in.size()], out, &pool);
+                DoNotOptimize(out.fp32);
+            }
+            std::cout << std::setw(12) << double(spectra) / SecondsSince(start);
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include "SpectrumEngine.h"
+#include "IqPower.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Work per parallelFor task, in FFT points and in bins
+        const size_t PointsPerTask = 16384;
+        const size_t BinsPerTask = 1024;
+
+        // Cosine sum coefficients a0, a1, ... of w[n] = a0 - a1 cos(2 pi n / N) + a2 cos(4 pi n / N) - ...
+        std::vector<double> coefficientsOf(SpectrumWindow window)
+        {
+            switch (window)
+            {
+            case SpectrumWindow::Hamming:
+                return { 0.54, 0.46 };
+            case SpectrumWindow::Hann:
+                return { 0.5, 0.5 };
+            case SpectrumWindow::Blackman:
+                return { 0.42, 0.5, 0.08 };
+            case SpectrumWindow::BlackmanHarris:
+                return { 0.35875, 0.48829, 0.14128, 0.01168 };
+            case SpectrumWindow::FlatTop:
+                return { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+            default:
+                return { 1.0 };
+            }
+        }
+    }
+
+    std::shared_ptr<const SpectrumWindowTable> SpectrumWindowTable::get(SpectrumWindow window, size_t size)
+    {
+        static std::mutex lock;
+        static std::map<std::pair<int, size_t>, std::shared_ptr<const SpectrumWindowTable>> tables;
+        std::lock_guard<std::mutex> guard(lock);
+        std::shared_ptr<const SpectrumWindowTable>& table = tables[std::make_pair(int(window), size)];
+        if (table)
+            return table;
+
+        // Periodic form, the one a DFT frame repeats with
+        std::vector<double> a = coefficientsOf(window), w(size);
+        double sum = 0, squares = 0;
+        for (size_t n = 0; n < size; n++)
+        {
+            double value = 0, sign = 1;
+            for (size_t k = 0; k < a.size(); k++, sign = -sign)
+                value += sign * a[k] * std::cos(2 * std::numbers::pi * double(k * n) / double(size));
+            w[n] = value;
+            sum += value;
+            squares += value * value;
+        }
+
+        auto built = std::make_shared<SpectrumWindowTable>();
+        built->paired.resize(2 * size);
+        for (size_t n = 0; n < size; n++)
+            built->paired[2 * n] = built->paired[2 * n + 1] = float(w[n] / sum);
+        built->noiseBandwidth = double(size) * squares / (sum * sum);
+        table = built;
+        return table;
+    }
+
+    SpectrumEngine::SpectrumEngine(const SpectrumSettings& settings)
+        : m_settings(settings)
+    {
+        size_t size = 2;
+        while (size < m_settings.fftSize)
+            size *= 2;
+        m_settings.fftSize = size;
+        m_settings.overlap = std::min(std::max(m_settings.overlap, 0.0), 0.99);
+        m_settings.average = std::max<size_t>(1, m_settings.average);
+        m_settings.aggregate = std::max<size_t>(1, m_settings.aggregate);
+        m_settings.level = ClampSimdLevel(m_settings.level);
+        m_hop = std::max<size_t>(1, size - size_t(std::lround(m_settings.overlap * double(size))));
+        m_plan = FftPlan::get(size);
+        m_window = SpectrumWindowTable::get(m_settings.window, size);
+        reset();
+    }
+
+    void SpectrumEngine::reset()
+    {
+        restartFrames();
+        m_timing.reset();
+    }
+
+    void SpectrumEngine::restartFrames()
+    {
+        m_buffer.clear();
+        m_bufferStart = 0;
+        m_sum.assign(m_settings.fftSize, 0.0f);
+        m_merged.assign(m_settings.fftSize, 0.0f);
+        m_averaged = m_aggregated = 0;
+        m_spectrumStart = 0;
+    }
+
+    void SpectrumEngine::transformFrames(size_t first, size_t last, std::vector<std::complex<float>>& scratch)
+    {
+        const size_t size = m_settings.fftSize, half = size / 2;
+        scratch.resize(size);
+        float* x = reinterpret_cast<float*>(scratch.data());
+        const float* w = m_window->paired.data();
+        for (size_t f = first; f < last; f++)
+        {
+            const float* iq = &m_buffer[2 * f * m_hop];
+            for (size_t k = 0; k < 2 * size; k++)
+                x[k] = iq[k] * w[k];
+            m_plan->forward(scratch.data(), m_settings.level);
+
+            // Negative frequencies first
+            float* power = &m_power[f * size];
+            PowerIq(x + size, half, power, m_settings.level);
+            PowerIq(x, half, power + half, m_settings.level);
+        }
+    }
+
+    void SpectrumEngine::mergeBins(size_t first, size_t last, size_t frames)
+    {
+        const size_t size = m_settings.fftSize, count = last - first;
+        const float averageScale = 1.0f / float(m_settings.average), aggregateScale = 1.0f / float(m_settings.aggregate);
+        size_t averaged = m_averaged, aggregated = m_aggregated, spectra = 0;
+        float* sum = &m_sum[first];
+        float* merged = &m_merged[first];
+        for (size_t f = 0; f < frames; f++)
+        {
+            const float* power = &m_power[f * size + first];
+            for (size_t b = 0; b < count; b++)
+                sum[b] += power[b];
+            if (++averaged < m_settings.average)
+                continue;
+
+            for (size_t b = 0; b < count; b++)
+            {
+                float estimate = sum[b] * averageScale;
+                sum[b] = 0;
+                if (aggregated == 0)
+                    merged[b] = estimate;
+                else if (m_settings.merge == SpectrumMerge::Min)
+                    merged[b] = std::min(merged[b], estimate);
+                else if (m_settings.merge == SpectrumMerge::Max)
+                    merged[b] = std::max(merged[b], estimate);
+                else
+                    merged[b] += estimate;
+            }
+            averaged = 0;
+            if (++aggregated < m_settings.aggregate)
+                continue;
+
+            float* out = &m_output[spectra * size + first];
+            if (m_settings.merge == SpectrumMerge::Avg)
+            {
+                for (size_t b = 0; b < count; b++)
+                    merged[b] *= aggregateScale;
+            }
+            PowerToDb(merged, count, out, DefaultPowerFloorDb, m_settings.level);
+            aggregated = 0;
+            spectra++;
+        }
+    }
+
+    size_t SpectrumEngine::process(const AARTSAAPI_Packet& in, AARTSAAPI_Packet& out, WorkerPool* pool)
+    {
+        const size_t size = m_settings.fftSize;
+        out = in;
+        out.num = out.total = 0;
+        out.size = out.stride = int64_t(size);
+        out.fp32 = nullptr;
+        out.flags &= ~StreamStartFlags;
+        if (in.size < 2 || in.num <= 0 || !in.fp32 || in.stepFrequency <= 0)
+        {
+            m_timing.skip(in);
+            return 0;
+        }
+        if (m_timing.advance(in))
+            restartFrames();
+
+        AppendIq(m_buffer, in.fp32, size_t(in.num), in.stride);
+        const size_t available = m_buffer.size() / 2;
+        const size_t frames = available >= size ? (available - size) / m_hop + 1 : 0;
+
+        // Spectra the frames complete, with the first frame of each, replaying
+        // the counts mergeBins keeps per bin range
+        size_t averaged = m_averaged, aggregated = m_aggregated, spectra = 0;
+        int64_t firstStart = m_spectrumStart, lastEnd = 0;
+        for (size_t f = 0; f < frames; f++)
+        {
+            int64_t start = m_bufferStart + int64_t(f * m_hop);
+            if (averaged == 0 && aggregated == 0)
+                m_spectrumStart = start;
+            if (++averaged < m_settings.average)
+                continue;
+            averaged = 0;
+            if (++aggregated < m_settings.aggregate)
+                continue;
+            aggregated = 0;
+            if (spectra++ == 0)
+                firstStart = m_spectrumStart;
+            lastEnd = start + int64_t(size);
+        }
+
+        m_power.resize(frames * size);
+        m_output.resize(spectra * size);
+        const size_t framesPerTask = std::max<size_t>(1, PointsPerTask / size);
+        const size_t frameTasks = (frames + framesPerTask - 1) / framesPerTask;
+        const size_t binTasks = (size + BinsPerTask - 1) / BinsPerTask;
+        m_scratch.resize(std::max<size_t>(m_scratch.size(), frameTasks));
+        auto transform = [&](size_t task) { transformFrames(task * framesPerTask, std::min(frames, (task + 1) * framesPerTask), m_scratch[task]); };
+        auto merge = [&](size_t task) { mergeBins(task * BinsPerTask, std::min(size, (task + 1) * BinsPerTask), frames); };
+        if (pool)
+        {
+            pool->parallelFor(frameTasks, transform);
+            pool->parallelFor(binTasks, merge);
+        }
+        else
+        {
+            for (size_t task = 0; task < frameTasks; task++)
+                transform(task);
+            for (size_t task = 0; task < binTasks; task++)
+                merge(task);
+        }
+        m_averaged = averaged;
+        m_aggregated = aggregated;
+
+        size_t drop = std::min(available, frames * m_hop);
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + std::ptrdiff_t(2 * drop));
+        m_bufferStart += int64_t(drop);
+
+        const double rate = m_timing.rate(), center = in.startFrequency + in.spanFrequency / 2;
+        out.startFrequency = center - rate / 2;
+        out.spanFrequency = rate;
+        out.stepFrequency = rate / double(size);
+        out.rbwFrequency = out.stepFrequency * m_window->noiseBandwidth;
+        out.num = out.total = int64_t(spectra);
+        if (spectra)
+        {
+            out.startTime = m_timing.time0() + double(firstStart) / rate;
+            out.endTime = m_timing.time0() + double(lastEnd) / rate;
+            out.fp32 = m_output.data();
+            out.flags |= m_timing.takeFlags();
+        }
+        return spectra;
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef SPECTRUMENGINE_H
+#define SPECTRUMENGINE_H
+
+#include "Fft.h"
+#include "SimdSupport.h"
+#include "StreamTiming.h"
+#include "WorkerPool.h"
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // The windows of device/fft0/fftwindow
+    enum class SpectrumWindow
+    {
+        Hamming,
+        Hann,
+        Uniform,
+        Blackman,
+        BlackmanHarris,
+        FlatTop
+    };
+
+    // The modes of device/fft0/fftmergemode
+    enum class SpectrumMerge
+    {
+        Avg,
+        Sum,
+        Min,
+        Max
+    };
+
+    struct SpectrumSettings
+    {
+        size_t fftSize;             // rounded up to a power of two
+        SpectrumWindow window;
+        double overlap;             // part of a frame shared with the previous one, 0 up to below 1
+        size_t average;             // frames whose powers are averaged into one estimate, Welch's method with overlap
+        SpectrumMerge merge;
+        size_t aggregate;           // estimates merged into one output spectrum, like device/fft0/fftaggregate
+        SimdLevel level;
+
+        explicit SpectrumSettings(size_t fftSize = 2048)
+            : fftSize(fftSize), window(SpectrumWindow::Hamming), overlap(0.5), average(1), merge(SpectrumMerge::Avg), aggregate(1),
+              level(DetectSimdLevel())
+        {
+        }
+    };
+
+    // Window of the given size scaled to a sum of 1, so a tone centered on a
+    // bin reads its power, with every value twice for interleaved IQ. Built
+    // once per window and size, shared like FftPlan::get.
+    struct SpectrumWindowTable
+    {
+        std::vector<float> paired;
+        double noiseBandwidth;      // equivalent noise bandwidth in bins
+
+        static std::shared_ptr<const SpectrumWindowTable> get(SpectrumWindow window, size_t size);
+    };
+
+    // Host FFT spectra of an IQ stream, in the layout of the device spectra
+    // (device/outputformat spectra): dB values of fftSize bins per spectrum,
+    // lowest frequency first, size and stride fftSize, num spectra per
+    // packet, stepFrequency the bin spacing and rbwFrequency the noise
+    // bandwidth of the window. A tone of amplitude A centered on a bin reads
+    // 20 * log10(A).
+    //
+    // Frames of fftSize samples start every fftSize * (1 - overlap) samples.
+    // The powers of `average` frames are averaged, `aggregate` of these
+    // averages merged per bin into one output spectrum. The frames of a
+    // packet are transformed on the pool, the merges spread over it by bins.
+    // State carries over from packet to packet; a gap, detected from the
+    // timestamps or AARTSAAPI_PACKET_SEGMENT_START, or a rate change drops the
+    // partial spectrum and marks the next output packet with
+    // AARTSAAPI_PACKET_SEGMENT_START.
+    class SpectrumEngine
+    {
+    public:
+        explicit SpectrumEngine(const SpectrumSettings& settings = SpectrumSettings());
+
+        const SpectrumSettings& settings() const { return m_settings; }
+
+        // Input samples from one frame start to the next
+        size_t hop() const { return m_hop; }
+
+        // Computes the spectra an IQ packet (size 2, or the first receiver of
+        // Rx12) completes. out points into the engine and stays valid until
+        // the next call; it may have no spectra. Returns out.num.
+        size_t process(const AARTSAAPI_Packet& in, AARTSAAPI_Packet& out, WorkerPool* pool = nullptr);
+
+        // Drops buffered samples, partial spectra and the timing
+        void reset();
+
+    private:
+        void restartFrames();
+        void transformFrames(size_t first, size_t last, std::vector<std::complex<float>>& scratch);
+        void mergeBins(size_t first, size_t last, size_t frames);
+
+        SpectrumSettings m_settings;
+        size_t m_hop;
+        std::shared_ptr<const FftPlan> m_plan;
+        std::shared_ptr<const SpectrumWindowTable> m_window;
+
+        std::vector<float> m_buffer;                // samples from the next frame start on
+        int64_t m_bufferStart;                      // stream index of the first buffer sample
+        StreamTiming m_timing;
+
+        // Partial spectrum, per bin in output order
+        std::vector<float> m_sum;                   // power of the frames of the current average
+        std::vector<float> m_merged;                // merge of the completed averages
+        size_t m_averaged;                          // frames in m_sum
+        size_t m_aggregated;                        // averages in m_merged
+        int64_t m_spectrumStart;                    // stream index of the first frame of the partial spectrum
+
+        std::vector<float> m_power;                 // per frame of the current packet
+        std::vector<int64_t> m_frameStart;          // stream index per frame
+        std::vector<std::vector<std::complex<float>>> m_scratch;    // per frame task
+        std::vector<float> m_output;                // dB per completed spectrum
+    };
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Fixed ring of preallocated slots between one producer and one consumer
+    // thread. Slots are filled and read in place, so elements that own buffers
+    // keep them across laps. The producer reserves the next free slot, fills it
+    // and commits it, the consumer reads the front slot and pops it.
+    template <typename T>
+    class SpscRing
+    {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit SpscRing(size_t capacity)
+            : m_head(0), m_cachedTail(0), m_tail(0), m_cachedHead(0)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        size_t capacity() const { return m_slots.size(); }
+
+        // Producer side, null when the ring is full
+        T* reserve()
+        {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_cachedTail >= m_slots.size())
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head - m_cachedTail >= m_slots.size())
+                    return nullptr;
+            }
+            return &m_slots[size_t(head) & m_mask];
+        }
+
+        void commit()
+        {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer side, null when the ring is empty
+        T* front()
+        {
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_cachedHead)
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail == m_cachedHead)
+                    return nullptr;
+            }
+            return &m_slots[size_t(tail) & m_mask];
+        }
+
+        void pop()
+        {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Exact from either side for its own index, approximate otherwise
+        size_t size() const
+        {
+            uint64_t tail = m_tail.load(std::memory_order_acquire);
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            return head > tail ? size_t(head - tail) : 0;
+        }
+
+        // Direct slot access for setting up the preallocated elements, only while
+        // neither side runs
+        T& slot(size_t index) { return m_slots[index]; }
+
+    private:
+        std::vector<T> m_slots;
+        size_t m_mask;
+
+        // Each side owns one cache line with its index and its cached copy of the
+        // other index, so polling an empty or full ring stays in the local cache
+        alignas(64) std::atomic<uint64_t> m_head;
+        uint64_t m_cachedTail;
+        alignas(64) std::atomic<uint64_t> m_tail;
+        uint64_t m_cachedHead;
+    };
+}
+
+#endif
@@ -0,0 +1,309 @@
+#include "StreamAligner.h"
+#include "AaroniaRtsaSdkWrapper.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        // Realignment rounds before giving up until more data arrived, each round
+        // moves the target time forward
+        const int MaxAlignRounds = 64;
+    }
+
+    StreamAligner::StreamAligner(size_t channels, size_t blockSamples)
+        : m_channels(channels), m_blockSamples(std::max<size_t>(1, blockSamples)), m_aligned(false), m_pendingDiscontinuity(false)
+    {
+        reset();
+    }
+
+    void StreamAligner::reset()
+    {
+        for (Channel& ch : m_channels)
+        {
+            ch.packets.clear();
+            ch.first = 0;
+            ch.position = 0;
+            ch.available = 0;
+            ch.lastEnd = -1;
+            ch.released = 0;
+            ch.skipped = 0;
+        }
+        m_aligned = false;
+        m_pendingDiscontinuity = false;
+        m_gaps.clear();
+    }
+
+    void StreamAligner::push(size_t channel, const AARTSAAPI_Packet& packet)
+    {
+        Channel& ch = m_channels[channel];
+        HeldPacket held;
+        held.packet = packet;
+        held.gapBefore = false;
+
+        if (ch.lastEnd >= 0)
+        {
+            double halfSample = packet.stepFrequency > 0 ? 0.5 / packet.stepFrequency : 0.0;
+            if (std::fabs(packet.startTime - ch.lastEnd) > halfSample || (packet.flags & AARTSAAPI_PACKET_SEGMENT_START))
+            {
+                held.gapBefore = true;
+                m_gaps.push_back(StreamGap{ channel, ch.lastEnd, packet.startTime });
+            }
+        }
+
+        ch.lastEnd = packet.endTime;
+        ch.available += packet.num > 0 ? packet.num : 0;
+        ch.packets.push_back(held);
+    }
+
+    size_t StreamAligner::takeReleased(size_t channel)
+    {
+        size_t released = m_channels[channel].released;
+        m_channels[channel].released = 0;
+        return released;
+    }
+
+    double StreamAligner::nextTime(const Channel& ch) const
+    {
+        const AARTSAAPI_Packet& packet = ch.packets[ch.first].packet;
+        return packet.startTime + double(ch.position) / packet.stepFrequency;
+    }
+
+    void StreamAligner::skip(Channel& ch, int64_t samples)
+    {
+        while (samples > 0 && ch.first < ch.packets.size())
+        {
+            int64_t remaining = ch.packets[ch.first].packet.num - ch.position;
+            int64_t step = std::min(samples, remaining);
+            ch.position += step;
+            ch.available -= step;
+            ch.skipped += uint64_t(step);
+            samples -= step;
+            if (ch.position >= ch.packets[ch.first].packet.num)
+            {
+                ch.first++;
+                ch.position = 0;
+            }
+        }
+    }
+
+    bool StreamAligner::gapWithin(const Channel& ch, int64_t samples, int64_t& beforeGap) const
+    {
+        if (ch.first >= ch.packets.size())
+            return false;
+        if (ch.position == 0 && ch.packets[ch.first].gapBefore)
+        {
+            beforeGap = 0;
+            return true;
+        }
+
+        int64_t count = ch.packets[ch.first].packet.num - ch.position;
+        for (size_t i = ch.first + 1; i < ch.packets.size() && count < samples; i++)
+        {
+            if (ch.packets[i].gapBefore)
+            {
+                beforeGap = count;
+                return true;
+            }
+            count += ch.packets[i].packet.num;
+        }
+        return false;
+    }
+
+    bool StreamAligner::align()
+    {
+        for (int round = 0; round < MaxAlignRounds; round++)
+        {
+            for (Channel& ch : m_channels)
+            {
+                if (ch.available <= 0)
+                    return false;
+
+                // A gap at the current sample needs no further handling, the
+                // alignment restarts there anyway
+                if (ch.position == 0)
+                    ch.packets[ch.first].gapBefore = false;
+            }
+
+            double target = nextTime(m_channels[0]);
+            for (const Channel& ch : m_channels)
+                target = std::max(target, nextTime(ch));
+
+            bool aligned = true;
+            for (Channel& ch : m_channels)
+            {
+                double rate = ch.packets[ch.first].packet.stepFrequency;
+                int64_t offset = int64_t(std::llround((target - nextTime(ch)) * rate));
+                if (offset <= 0)
+                    continue;
+
+                int64_t beforeGap;
+                if (gapWithin(ch, offset, beforeGap))
+                {
+                    skip(ch, beforeGap);
+                    aligned = false;
+                    continue;
+                }
+                if (offset >= ch.available)
+                {
+                    // All held samples lie before the target
+                    skip(ch, ch.available);
+                    return false;
+                }
+                skip(ch, offset);
+            }
+
+            // Packet boundaries may move a channel by a fraction of a sample, check again
+            for (const Channel& ch : m_channels)
+            {
+                double halfSample = 0.5 / ch.packets[ch.first].packet.stepFrequency;
+                if (std::fabs(nextTime(ch) - target) > halfSample)
+                    aligned = false;
+            }
+            if (aligned)
+                return true;
+        }
+        return false;
+    }
+
+    bool StreamAligner::next(AlignedBlock& block)
+    {
+        // The previous block is done with, hand its packets back
+        for (Channel& ch : m_channels)
+        {
+            for (; ch.first > 0; ch.first--)
+            {
+                ch.packets.pop_front();
+                ch.released++;
+            }
+        }
+
+        const int64_t blockSamples = int64_t(m_blockSamples);
+        for (;;)
+        {
+            if (!m_aligned)
+            {
+                if (!align())
+                    return false;
+                m_aligned = true;
+                m_pendingDiscontinuity = true;
+            }
+
+            for (const Channel& ch : m_channels)
+            {
+                if (ch.available < blockSamples)
+                    return false;
+            }
+
+            // A block never spans a gap, drop the samples before it and realign
+            bool gap = false;
+            for (Channel& ch : m_channels)
+            {
+                int64_t beforeGap;
+                if (gapWithin(ch, blockSamples, beforeGap))
+                {
+                    skip(ch, beforeGap);
+                    gap = true;
+                }
+            }
+            if (!gap)
+                break;
+            m_aligned = false;
+        }
+
+        block.startTime = nextTime(m_channels[0]);
+        block.samples = m_blockSamples;
+        block.discontinuity = m_pendingDiscontinuity;
+        m_pendingDiscontinuity = false;
+        block.channels.resize(m_channels.size());
+
+        for (size_t c = 0; c < m_channels.size(); c++)
+        {
+            Channel& ch = m_channels[c];
+            std::vector<AlignedSegment>& segments = block.channels[c];
+            segments.clear();
+
+            int64_t remaining = blockSamples;
+            while (remaining > 0)
+            {
+                const AARTSAAPI_Packet& packet = ch.packets[ch.first].packet;
+                int64_t take = std::min(remaining, packet.num - ch.position);
+                segments.push_back(AlignedSegment{ packet.fp32 + ch.position * packet.stride, size_t(take), packet.stride });
+
+                ch.position += take;
+                ch.available -= take;
+                remaining -= take;
+                if (ch.position >= packet.num)
+                {
+                    ch.first++;
+                    ch.position = 0;
+                }
+            }
+        }
+        return true;
+    }
+
+    AlignedStreamReader::AlignedStreamReader(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, const std::vector<int32_t>& sdkChannels,
+        size_t blockSamples, const PacketWaitSettings& wait)
+        : m_sdkWrapper(sdkWrapper), m_device(dhandle), m_sdkChannels(sdkChannels), m_aligner(sdkChannels.size(), blockSamples),
+          m_waiters(sdkChannels.size(), PacketWaiter(wait))
+    {
+    }
+
+    AARTSAAPI_Result AlignedStreamReader::consumeReleased()
+    {
+        for (size_t c = 0; c < m_sdkChannels.size(); c++)
+        {
+            size_t released = m_aligner.takeReleased(c);
+            if (released)
+            {
+                AARTSAAPI_Result res = m_sdkWrapper.ConsumePackets(m_device, m_sdkChannels[c], int32_t(released));
+                if (res != AARTSAAPI_OK)
+                    return res;
+            }
+        }
+        return AARTSAAPI_OK;
+    }
+
+    AARTSAAPI_Result AlignedStreamReader::next(AlignedBlock& block, std::chrono::nanoseconds timeout, const CancelToken* cancel)
+    {
+        if (m_sdkChannels.empty())
+            return AARTSAAPI_ERROR_INVALID_CHANNEL;
+
+        auto start = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            bool ready = m_aligner.next(block);
+            AARTSAAPI_Result res = consumeReleased();
+            if (res != AARTSAAPI_OK)
+                return res;
+            if (ready)
+                return AARTSAAPI_OK;
+
+            // Fetch for the first channel that needs data
+            size_t c = 0;
+            for (size_t i = 1; i < m_sdkChannels.size(); i++)
+            {
+                if (m_aligner.needsData(i) && !m_aligner.needsData(c))
+                    c = i;
+            }
+
+            std::chrono::nanoseconds remaining = timeout;
+            if (timeout != std::chrono::nanoseconds::max())
+            {
+                remaining = timeout - std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                if (remaining <= std::chrono::nanoseconds::zero())
+                    return AARTSAAPI_EMPTY;
+            }
+
+            AARTSAAPI_Packet packet;
+            int32_t index = int32_t(m_aligner.held(c));
+            res = m_waiters[c].wait([&]() { return m_sdkWrapper.GetPacket(m_device, m_sdkChannels[c], index, &packet); }, remaining, cancel);
+            if (res != AARTSAAPI_OK)
+                return res;
+            m_aligner.push(c, packet);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef STREAMALIGNER_H
+#define STREAMALIGNER_H
+
+#include "PacketWait.h"
+#include <aaroniartsaapi.h>
+#include <deque>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    class AaroniaRtsaSdkWrapper;
+
+    // Run of consecutive samples of one channel inside a packet payload
+    struct AlignedSegment
+    {
+        const float* data;      // first sample
+        size_t samples;
+        int64_t stride;         // floats from one sample to the next
+    };
+
+    // Block of the same number of samples on every channel, starting at the same
+    // time. The segments point into the packets held by the aligner.
+    struct AlignedBlock
+    {
+        double startTime;
+        size_t samples;
+        bool discontinuity;     // first block after the start or a gap on any channel
+        std::vector<std::vector<AlignedSegment>> channels;
+
+        AlignedBlock() : startTime(0), samples(0), discontinuity(false) {}
+    };
+
+    // Missing (or, when endTime < startTime, overlapping) part of one channel
+    struct StreamGap
+    {
+        size_t channel;
+        double startTime, endTime;
+    };
+
+    // Aligns the IQ streams of any number of channels sample exactly by their
+    // packet startTime and stepFrequency and cuts them into blocks of a fixed
+    // length. Packets are referenced, not copied, so a block may span packet
+    // boundaries. The packets stay with the aligner until takeReleased hands them
+    // back, the caller consumes them from the SDK queue only then.
+    //
+    // A gap on one channel, found from timestamps or AARTSAAPI_PACKET_SEGMENT_START,
+    // ends the current alignment. All channels then skip to the first time they
+    // all have samples for and the next block is flagged as discontinuity.
+    class StreamAligner
+    {
+    public:
+        StreamAligner(size_t channels, size_t blockSamples);
+
+        size_t channels() const { return m_channels.size(); }
+        size_t blockSamples() const { return m_blockSamples; }
+
+        void push(size_t channel, const AARTSAAPI_Packet& packet);
+
+        // Packets pushed and not yet released, the SDK queue index of the next packet
+        size_t held(size_t channel) const { return m_channels[channel].packets.size(); }
+
+        // Channel has too few samples for the next block
+        bool needsData(size_t channel) const { return m_channels[channel].available < int64_t(m_blockSamples); }
+
+        // Fills block with the next aligned block, false if a channel needs data.
+        // The previous block must no longer be used.
+        bool next(AlignedBlock& block);
+
+        // Packets no block refers to anymore, to be consumed from the SDK queue
+        size_t takeReleased(size_t channel);
+
+        // Gaps seen since the last clearGaps
+        const std::vector<StreamGap>& gaps() const { return m_gaps; }
+        void clearGaps() { m_gaps.clear(); }
+
+        // Samples dropped to align the channels
+        uint64_t skippedSamples(size_t channel) const { return m_channels[channel].skipped; }
+
+        void reset();
+
+    private:
+        struct HeldPacket
+        {
+            AARTSAAPI_Packet packet;
+            bool gapBefore;
+        };
+
+        struct Channel
+        {
+            std::deque<HeldPacket> packets;
+            size_t first;           // packet holding the next sample, packets before it wait for release
+            int64_t position;       // next sample in packets[first]
+            int64_t available;      // samples from position to the end of the last packet
+            double lastEnd;         // end time of the last pushed packet, negative before the first
+            size_t released;
+            uint64_t skipped;
+        };
+
+        double nextTime(const Channel& ch) const;
+        void skip(Channel& ch, int64_t samples);
+        bool gapWithin(const Channel& ch, int64_t samples, int64_t& beforeGap) const;
+        bool align();
+
+        std::vector<Channel> m_channels;
+        size_t m_blockSamples;
+        bool m_aligned;
+        bool m_pendingDiscontinuity;
+        std::vector<StreamGap> m_gaps;
+    };
+
+    // Reads the channels of one device through the SDK queue into a StreamAligner,
+    // e.g. the two channels of a raw device with receiverchannel Rx1+Rx2.
+    class AlignedStreamReader
+    {
+    public:
+        AlignedStreamReader(AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_Device* dhandle, const std::vector<int32_t>& sdkChannels,
+            size_t blockSamples, const PacketWaitSettings& wait = PacketWaitSettings());
+
+        // AARTSAAPI_EMPTY on timeout or cancellation
+        AARTSAAPI_Result next(AlignedBlock& block, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max(), const CancelToken* cancel = nullptr);
+
+        StreamAligner& aligner() { return m_aligner; }
+
+    private:
+        AARTSAAPI_Result consumeReleased();
+
+        AaroniaRtsaSdkWrapper& m_sdkWrapper;
+        AARTSAAPI_Device* m_device;
+        std::vector<int32_t> m_sdkChannels;
+        StreamAligner m_aligner;
+        std::vector<PacketWaiter> m_waiters;
+    };
+}
+
+#endif
@@ -0,0 +1,297 @@
+#include "BenchmarkSupport.h"
+#include "StreamAligner.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+// Aligns two IQ channels into blocks the way AlignedStreamReader feeds them,
+// one packet at a time to the channel that needs data. Checks a run where
+// channel 1 starts later, has jittered timestamps and loses a packet, and
+// channel 0 has a SEGMENT_START: every sample of every block against its
+// stream index on both channels, the block times, the discontinuity flags,
+// the gaps, the skipped samples and the packets handed back for
+// ConsumePackets, all against a model of where each block has to start. Then
+// counts aligned samples per second by block size. Runs without a device;
+// takes the packets per channel of the timed runs and the samples per packet.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const double SampleRate = 1e6;
+    const double StreamStart = 1000.0;
+
+    // Packets of one channel, sample k of the stream carries I = k and
+    // Q = channel + 1
+    struct ChannelFeed
+    {
+        int64_t first;                          // stream index of the first sample
+        std::vector<float> payload;
+        std::vector<AARTSAAPI_Packet> packets;
+        std::vector<int64_t> ends;              // stream index after the last sample, per packet
+    };
+
+    // Leaves out packet dropped and flags packet segmentStart; odd packets are
+    // stamped jitter samples late
+    ChannelFeed makeFeed(size_t channel, int64_t first, size_t packets, size_t samples, int64_t stride, size_t dropped, size_t segmentStart,
+        double jitter)
+    {
+        ChannelFeed feed;
+        feed.first = first;
+        feed.payload.resize(packets * samples * size_t(stride));
+        for (size_t p = 0; p < packets; p++)
+        {
+            const int64_t start = first + int64_t(p * samples);
+            float* data = feed.payload.data() + p * samples * size_t(stride);
+            for (size_t j = 0; j < samples; j++)
+            {
+                data[j * size_t(stride)] = float(start + int64_t(j));
+                data[j * size_t(stride) + 1] = float(channel + 1);
+            }
+            if (p == dropped)
+                continue;
+
+            AARTSAAPI_Packet packet = AARTSAAPI_Packet();
+            packet.num = packet.total = int64_t(samples);
+            packet.size = 2;
+            packet.stride = stride;
+            packet.fp32 = data;
+            packet.stepFrequency = SampleRate;
+            packet.startTime = StreamStart + (double(start) + (p % 2 ? jitter : 0.0)) / SampleRate;
+            packet.endTime = packet.startTime + double(samples) / SampleRate;
+            if (p == 0)
+                packet.flags |= AARTSAAPI_PACKET_STREAM_START;
+            if (p == segmentStart)
+                packet.flags |= AARTSAAPI_PACKET_SEGMENT_START;
+            feed.packets.push_back(packet);
+            feed.ends.push_back(start + int64_t(samples));
+        }
+        return feed;
+    }
+
+    // Samples [first, resume) missing on a channel; first == resume for a
+    // SEGMENT_START without missing samples
+    struct ExpectedGap
+    {
+        size_t channel;
+        int64_t first, resume;
+    };
+
+    size_t packetsEndingBy(const ChannelFeed& feed, int64_t index)
+    {
+        return size_t(std::upper_bound(feed.ends.begin(), feed.ends.end(), index) - feed.ends.begin());
+    }
+
+    bool fail(const std::string& message)
+    {
+        std::cerr << "StreamAligner check failed: " << message << std::endl;
+        return false;
+    }
+
+    bool checkAlignment(size_t blockSamples)
+    {
+        const int64_t block = int64_t(blockSamples);
+        // Realigned behind the loss at sample 16480, blocks of 160 then end
+        // right at the SEGMENT_START at sample 40000
+        const int64_t offset = 352;
+        const size_t droppedPacket = 20, segmentPacket = 40;
+        std::vector<ChannelFeed> feeds;
+        feeds.push_back(makeFeed(0, 0, 100, 1000, 2, SIZE_MAX, segmentPacket, 0.0));
+        feeds.push_back(makeFeed(1, offset, 130, 768, 4, droppedPacket, SIZE_MAX, 0.2));
+        const std::vector<ExpectedGap> expectedGaps = {
+            { 1, offset + int64_t(droppedPacket * 768), offset + int64_t((droppedPacket + 1) * 768) },
+            { 0, int64_t(segmentPacket * 1000), int64_t(segmentPacket * 1000) } };
+        const int64_t streamEnd = std::min(feeds[0].ends.back(), feeds[1].ends.back());
+
+        // Model: blocks follow on each other unless a gap starts within the
+        // next block, then the next block starts where the gap ends
+        std::vector<int64_t> position = { feeds[0].first, feeds[1].first };
+        std::vector<uint64_t> expectedSkipped(2, 0);
+        int64_t previousEnd = 0;
+        bool firstBlock = true;
+        auto expectNext = [&](int64_t& start, bool& discontinuity)
+        {
+            start = std::max(position[0], position[1]);
+            discontinuity = firstBlock;
+            for (bool moved = true; moved;)
+            {
+                moved = false;
+                for (const ExpectedGap& gap : expectedGaps)
+                {
+                    if (gap.resume >= start && gap.first < start + block)
+                    {
+                        discontinuity = true;
+                        moved = gap.resume != start;
+                        start = gap.resume;
+                    }
+                }
+            }
+        };
+
+        StreamAligner aligner(2, blockSamples);
+        AlignedBlock aligned;
+        std::vector<size_t> pushed(2, 0), consumed(2, 0);
+        size_t blocks = 0, discontinuities = 0;
+        for (;;)
+        {
+            bool ready = aligner.next(aligned);
+            for (size_t c = 0; c < 2; c++)
+                consumed[c] += aligner.takeReleased(c);
+            if (!ready)
+            {
+                // Same choice of channel as AlignedStreamReader
+                size_t c = aligner.needsData(1) && !aligner.needsData(0) ? 1 : 0;
+                if (pushed[c] == feeds[c].packets.size())
+                    break;
+                aligner.push(c, feeds[c].packets[pushed[c]++]);
+                continue;
+            }
+
+            int64_t start;
+            bool discontinuity;
+            expectNext(start, discontinuity);
+            if (start + block > streamEnd)
+                return fail("block " + std::to_string(blocks) + " beyond the end of the data");
+            for (size_t c = 0; c < 2; c++)
+            {
+                int64_t skipped = start - position[c];
+                for (const ExpectedGap& gap : expectedGaps)
+                {
+                    if (gap.channel == c && gap.first >= position[c] && gap.resume <= start)
+                        skipped -= gap.resume - gap.first;
+                }
+                expectedSkipped[c] += uint64_t(skipped);
+                position[c] = start + block;
+            }
+
+            if (aligned.samples != blockSamples || aligned.channels.size() != 2)
+                return fail("block " + std::to_string(blocks) + " has the wrong shape");
+            if (std::fabs(aligned.startTime - (StreamStart + double(start) / SampleRate)) > 0.5 / SampleRate)
+                return fail("block " + std::to_string(blocks) + " starts at the wrong time");
+            if (aligned.discontinuity != discontinuity)
+                return fail("block " + std::to_string(blocks) + " has the discontinuity flag " + (aligned.discontinuity ? "set" : "clear"));
+            for (size_t c = 0; c < 2; c++)
+            {
+                int64_t index = start;
+                for (const AlignedSegment& segment : aligned.channels[c])
+                {
+                    for (size_t j = 0; j < segment.samples; j++, index++)
+                    {
+                        const float* s = segment.data + j * size_t(segment.stride);
+                        if (s[0] != float(index) || s[1] != float(c + 1))
+                            return fail("channel " + std::to_string(c) + " of block " + std::to_string(blocks) + " is off at sample "
+                                + std::to_string(index - start));
+                    }
+                }
+                if (index != start + block)
+                    return fail("channel " + std::to_string(c) + " of block " + std::to_string(blocks) + " has the wrong length");
+
+                // Handed back are the packets before the previous block's end,
+                // and those skipped to reach this block
+                if (consumed[c] < packetsEndingBy(feeds[c], previousEnd) || consumed[c] > packetsEndingBy(feeds[c], start))
+                    return fail(std::to_string(consumed[c]) + " packets of channel " + std::to_string(c) + " handed back at block " + std::to_string(blocks));
+            }
+
+            blocks++;
+            discontinuities += aligned.discontinuity ? 1 : 0;
+            previousEnd = start + block;
+            firstBlock = false;
+        }
+
+        int64_t start;
+        bool discontinuity;
+        expectNext(start, discontinuity);
+        if (start + block <= streamEnd)
+            return fail("stopped after " + std::to_string(blocks) + " blocks with data left");
+        for (size_t c = 0; c < 2; c++)
+        {
+            if (aligner.skippedSamples(c) != expectedSkipped[c])
+                return fail("channel " + std::to_string(c) + " skipped " + std::to_string(aligner.skippedSamples(c)) + " samples, expected "
+                    + std::to_string(expectedSkipped[c]));
+            if (consumed[c] + aligner.held(c) != pushed[c])
+                return fail("packets of channel " + std::to_string(c) + " lost between push and takeReleased");
+        }
+
+        const std::vector<StreamGap>& gaps = aligner.gaps();
+        if (gaps.size() != expectedGaps.size())
+            return fail(std::to_string(gaps.size()) + " gaps reported");
+        for (size_t k = 0; k < gaps.size(); k++)
+        {
+            const ExpectedGap& expected = expectedGaps[k];
+            if (gaps[k].channel != expected.channel
+                || std::fabs(gaps[k].startTime - (StreamStart + double(expected.first) / SampleRate)) > 0.5 / SampleRate
+                || std::fabs(gaps[k].endTime - (StreamStart + double(expected.resume) / SampleRate)) > 0.5 / SampleRate)
+                return fail("gap " + std::to_string(k) + " reported at the wrong place");
+        }
+
+        std::cout << std::setw(6) << blockSamples << std::setw(8) << blocks << std::setw(17) << discontinuities
+            << std::setw(10) << consumed[0] << " of " << std::left << std::setw(5) << pushed[0] << std::right
+            << std::setw(6) << consumed[1] << " of " << std::left << std::setw(5) << pushed[1] << std::right
+            << std::setw(9) << aligner.skippedSamples(0) << std::setw(7) << aligner.skippedSamples(1) << std::endl;
+        return true;
+    }
+
+    // Aligned samples per second and channel of two continuous channels
+    double samplesPerSecond(size_t packets, size_t samples, size_t blockSamples)
+    {
+        // The payload repeats every few packets, only the timestamps run on
+        const size_t distinct = 64;
+        std::vector<float> payload(2 * distinct * samples, 0.25f);
+        StreamAligner aligner(2, blockSamples);
+        AlignedBlock block;
+        std::vector<size_t> pushed(2, 0);
+        size_t blocks = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            bool ready = aligner.next(block);
+            for (size_t c = 0; c < 2; c++)
+                aligner.takeReleased(c);
+            if (ready)
+            {
+                blocks++;
+                DoNotOptimize(block.channels[1].back().data);
+                continue;
+            }
+
+            size_t c = aligner.needsData(1) && !aligner.needsData(0) ? 1 : 0;
+            if (pushed[c] == packets)
+                break;
+            const size_t p = pushed[c]++;
+            AARTSAAPI_Packet packet = AARTSAAPI_Packet();
+            packet.num = packet.total = int64_t(samples);
+            packet.size = packet.stride = 2;
+            packet.fp32 = payload.data() + 2 * (p % distinct) * samples;
+            packet.stepFrequency = SampleRate;
+            packet.startTime = StreamStart + double(p * samples) / SampleRate;
+            packet.endTime = packet.startTime + double(samples) / SampleRate;
+            aligner.push(c, packet);
+        }
+        return double(blocks * blockSamples) / SecondsSince(start);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t packets = NumberArgument<size_t>(argc, argv, 1, 20000);
+    const size_t samples = NumberArgument<size_t>(argc, argv, 2, 1024);
+    const size_t blockSizes[] = { 64, 160, 1000, 4096, 16384 };
+
+    std::cout << "Check          : channel 0 from sample 0 in packets of 1000 with SEGMENT_START at sample 40000," << std::endl
+        << "                 channel 1 from sample 352 in packets of 768 with stride 4, timestamps 0.2 samples late" << std::endl
+        << "                 on odd packets and packet 20 lost" << std::endl
+        << "block  blocks  discontinuities  consumed 0    consumed 1    skipped 0    1" << std::endl;
+    for (size_t blockSamples : blockSizes)
+    {
+        if (!checkAlignment(blockSamples))
+            return -1;
+    }
+
+    std::cout << std::endl << "Throughput     : two continuous channels, " << samples << " samples per packet, MSamples/s per channel" << std::endl
+        << "block  MSamples/s" << std::endl << std::fixed << std::setprecision(1);
+    for (size_t blockSamples : blockSizes)
+        std::cout << std::setw(6) << blockSamples << std::setw(12) << samplesPerSecond(packets, samples, blockSamples) / 1e6 << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "StreamTiming.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AarRtsaSdkWrapper
+{
+
+    void StreamTiming::reset()
+    {
+        m_timed = false;
+        m_time0 = m_rate = m_nextTime = 0;
+        m_pendingFlags = 0;
+    }
+
+    bool StreamTiming::restartNeeded(const AARTSAAPI_Packet& in) const
+    {
+        return !m_timed || (in.flags & StreamStartFlags) || in.stepFrequency != m_rate
+            || std::fabs(in.startTime - m_nextTime) > 0.5 / in.stepFrequency;
+    }
+
+    bool StreamTiming::advance(const AARTSAAPI_Packet& in)
+    {
+        bool restart = restartNeeded(in);
+        if (restart)
+        {
+            if (m_timed)
+                m_pendingFlags |= AARTSAAPI_PACKET_SEGMENT_START;
+            m_timed = true;
+            m_time0 = in.startTime;
+            m_rate = in.stepFrequency;
+        }
+        m_pendingFlags |= in.flags & StreamStartFlags;
+        m_nextTime = in.startTime + double(in.num) / in.stepFrequency;
+        return restart;
+    }
+
+    uint64_t StreamTiming::takeFlags()
+    {
+        uint64_t flags = m_pendingFlags;
+        m_pendingFlags = 0;
+        return flags;
+    }
+
+    void AppendIq(std::vector<float>& buffer, const float* iq, size_t samples, int64_t stride)
+    {
+        size_t start = buffer.size();
+        buffer.resize(start + 2 * samples);
+        float* dst = buffer.data() + start;
+        if (stride == 2)
+        {
+            std::copy(iq, iq + 2 * samples, dst);
+            return;
+        }
+        for (size_t j = 0; j < samples; j++)
+        {
+            dst[2 * j] = iq[j * size_t(stride)];
+            dst[2 * j + 1] = iq[j * size_t(stride) + 1];
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef STREAMTIMING_H
+#define STREAMTIMING_H
+
+#include <aaroniartsaapi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Flags that start a stream or a segment of it
+    const uint64_t StreamStartFlags = AARTSAAPI_PACKET_STREAM_START | AARTSAAPI_PACKET_SEGMENT_START;
+
+    // Time base of an IQ stream for the stages that keep state across
+    // packets, IqResampler, Channelizer, DownConverter and SpectrumEngine. The
+    // stream restarts with its first packet, a start flag, a rate change or a
+    // gap or overlap of more than half a sample; a restart after the first
+    // packet becomes AARTSAAPI_PACKET_SEGMENT_START on the next output packet,
+    // together with the start flags of the input since the last one.
+    class StreamTiming
+    {
+    public:
+        StreamTiming() { reset(); }
+
+        // Whether in, a packet with samples, restarts the stream
+        bool restartNeeded(const AARTSAAPI_Packet& in) const;
+
+        // Takes in as the next packet with samples, moving the time base to it
+        // on a restart. Returns whether it restarted; the caller then drops its
+        // filter state.
+        bool advance(const AARTSAAPI_Packet& in);
+
+        // Keeps the start flags of a packet without samples for the next output
+        void skip(const AARTSAAPI_Packet& in) { m_pendingFlags |= in.flags & StreamStartFlags; }
+
+        // Start flags for the next output packet with samples, cleared by taking them
+        uint64_t takeFlags();
+
+        // Start time and sample rate of the stream since the last restart
+        double time0() const { return m_time0; }
+        double rate() const { return m_rate; }
+
+        // Forgets the time base and the pending flags
+        void reset();
+
+    private:
+        bool m_timed;                   // a packet set the time base
+        double m_time0, m_rate, m_nextTime;
+        uint64_t m_pendingFlags;
+    };
+
+    // Appends samples I/Q pairs, stride floats apart, to buffer as interleaved I/Q
+    void AppendIq(std::vector<float>& buffer, const float* iq, size_t samples, int64_t stride);
+}
+
+#endif
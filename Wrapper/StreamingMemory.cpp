@@ -0,0 +1,228 @@
+#include "StreamingMemory.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const size_t HugePage = 2 * 1024 * 1024;
+
+        size_t roundUp(size_t value, size_t multiple)
+        {
+            return (value + multiple - 1) / multiple * multiple;
+        }
+
+        size_t smallPage()
+        {
+#if defined(_WIN32)
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return size_t(info.dwPageSize);
+#elif defined(__linux__)
+            long page = sysconf(_SC_PAGESIZE);
+            return page > 0 ? size_t(page) : 4096;
+#else
+            return 4096;
+#endif
+        }
+
+        void touch(void* data, size_t bytes, size_t page)
+        {
+            volatile char* p = static_cast<volatile char*>(data);
+            for (size_t offset = 0; offset < bytes; offset += page)
+                p[offset] = 0;
+        }
+
+#if defined(__linux__)
+        // AnonHugePages of the mapping starting at begin, from /proc/self/smaps
+        size_t hugeBytesOf(const void* begin)
+        {
+            std::ifstream smaps("/proc/self/smaps");
+            std::string line;
+            bool inside = false;
+            uintptr_t address = uintptr_t(begin);
+            while (std::getline(smaps, line))
+            {
+                size_t dash = line.find('-');
+                if (dash != std::string::npos && dash < 17 && line.find(' ') > dash)
+                {
+                    uintptr_t start = uintptr_t(std::strtoull(line.c_str(), nullptr, 16));
+                    uintptr_t end = uintptr_t(std::strtoull(line.c_str() + dash + 1, nullptr, 16));
+                    inside = address >= start && address < end;
+                }
+                else if (inside && line.compare(0, 14, "AnonHugePages:") == 0)
+                {
+                    return size_t(std::strtoull(line.c_str() + 14, nullptr, 10)) * 1024;
+                }
+            }
+            return 0;
+        }
+#endif
+    }
+
+    StreamingBuffer::StreamingBuffer(size_t bytes, const StreamingMemorySettings& settings)
+        : m_data(nullptr), m_info()
+    {
+        if (bytes == 0)
+            return;
+        const size_t page = smallPage();
+
+#if defined(__linux__)
+        if (settings.explicitHugePages)
+        {
+            size_t size = roundUp(bytes, HugePage);
+            void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = data;
+                m_info.bytes = size;
+                m_info.pageSize = HugePage;
+                m_info.explicitHugePages = true;
+            }
+        }
+        if (!m_data)
+        {
+            // Transparent huge pages need 2 MiB aligned ranges, map more and trim
+            bool huge = settings.transparentHugePages && bytes >= HugePage;
+            size_t size = roundUp(bytes, huge ? HugePage : page);
+            size_t mapped = huge ? size + HugePage : size;
+            void* data = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data == MAP_FAILED)
+                return;
+
+            char* begin = static_cast<char*>(data);
+            if (huge)
+            {
+                char* aligned = reinterpret_cast<char*>(roundUp(uintptr_t(begin), HugePage));
+                if (aligned > begin)
+                    munmap(begin, size_t(aligned - begin));
+                if (begin + mapped > aligned + size)
+                    munmap(aligned + size, size_t(begin + mapped - (aligned + size)));
+                begin = aligned;
+                m_info.transparentHugePages = madvise(begin, size, MADV_HUGEPAGE) == 0;
+            }
+            m_data = begin;
+            m_info.bytes = size;
+            m_info.pageSize = page;
+        }
+
+        if (settings.lock)
+            m_info.locked = mlock(m_data, m_info.bytes) == 0;
+        if (settings.prefault)
+        {
+            // mlock faults the pages in already, touching them makes sure of it
+            touch(m_data, m_info.bytes, page);
+            m_info.prefaulted = true;
+        }
+        if (m_info.explicitHugePages)
+            m_info.hugeBytes = m_info.bytes;
+        else if (m_info.transparentHugePages && m_info.prefaulted)
+            m_info.hugeBytes = hugeBytesOf(m_data);
+#elif defined(_WIN32)
+        if (settings.explicitHugePages)
+        {
+            // Needs SeLockMemoryPrivilege, large pages are always locked
+            size_t large = GetLargePageMinimum();
+            if (large)
+            {
+                size_t size = roundUp(bytes, large);
+                m_data = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+                if (m_data)
+                {
+                    m_info.bytes = size;
+                    m_info.pageSize = large;
+                    m_info.explicitHugePages = true;
+                    m_info.hugeBytes = size;
+                    m_info.locked = true;
+                }
+            }
+        }
+        if (!m_data)
+        {
+            size_t size = roundUp(bytes, page);
+            m_data = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            if (!m_data)
+                return;
+            m_info.bytes = size;
+            m_info.pageSize = page;
+            if (settings.lock)
+            {
+                // VirtualLock is limited by the working set, raise it by the buffer
+                SIZE_T minimum, maximum;
+                if (GetProcessWorkingSetSize(GetCurrentProcess(), &minimum, &maximum))
+                    SetProcessWorkingSetSize(GetCurrentProcess(), minimum + size, maximum + size);
+                m_info.locked = VirtualLock(m_data, size) != 0;
+            }
+        }
+        if (settings.prefault)
+        {
+            touch(m_data, m_info.bytes, page);
+            m_info.prefaulted = true;
+        }
+#else
+        size_t size = roundUp(bytes, page);
+        m_data = ::operator new(size, std::align_val_t(page), std::nothrow);
+        if (!m_data)
+            return;
+        m_info.bytes = size;
+        m_info.pageSize = page;
+        if (settings.prefault)
+        {
+            touch(m_data, size, page);
+            m_info.prefaulted = true;
+        }
+#endif
+    }
+
+    StreamingBuffer::~StreamingBuffer()
+    {
+        reset();
+    }
+
+    StreamingBuffer::StreamingBuffer(StreamingBuffer&& other) noexcept
+        : m_data(other.m_data), m_info(other.m_info)
+    {
+        other.m_data = nullptr;
+        other.m_info = StreamingMemoryInfo();
+    }
+
+    StreamingBuffer& StreamingBuffer::operator=(StreamingBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_data = other.m_data;
+            m_info = other.m_info;
+            other.m_data = nullptr;
+            other.m_info = StreamingMemoryInfo();
+        }
+        return *this;
+    }
+
+    void StreamingBuffer::reset()
+    {
+        if (!m_data)
+            return;
+#if defined(__linux__)
+        munmap(m_data, m_info.bytes);
+#elif defined(_WIN32)
+        VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+        ::operator delete(m_data, std::align_val_t(m_info.pageSize));
+#endif
+        m_data = nullptr;
+        m_info = StreamingMemoryInfo();
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef STREAMINGMEMORY_H
+#define STREAMINGMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct StreamingMemorySettings
+    {
+        bool explicitHugePages;     // MAP_HUGETLB (large pages on Windows), needs pages reserved by the admin
+        bool transparentHugePages;  // madvise(MADV_HUGEPAGE) when explicit huge pages are not available
+        bool prefault;              // touch every page now instead of on first use
+        bool lock;                  // mlock, so the pages are never swapped or moved
+
+        StreamingMemorySettings() : explicitHugePages(true), transparentHugePages(true), prefault(true), lock(true) {}
+
+        // Plain pages, faulted in on first use, like the heap
+        static StreamingMemorySettings plain()
+        {
+            StreamingMemorySettings settings;
+            settings.explicitHugePages = settings.transparentHugePages = settings.prefault = settings.lock = false;
+            return settings;
+        }
+    };
+
+    // What the allocation actually got, each part falls back on its own
+    struct StreamingMemoryInfo
+    {
+        size_t bytes;               // mapped, rounded up to the page size
+        size_t pageSize;            // of the mapping, 2 MiB for explicit huge pages
+        bool explicitHugePages;
+        bool transparentHugePages;  // requested successfully, the kernel may still use small pages
+        size_t hugeBytes;           // backed by huge pages after prefaulting, where the OS tells (Linux smaps)
+        bool prefaulted;
+        bool locked;
+    };
+
+    // Anonymous memory for the big buffers of the streaming path: rings, pools,
+    // recordings. Tries explicit and then transparent huge pages to cut TLB
+    // misses, pre-faults and locks the pages so the data path never takes a page
+    // fault. Everything that fails falls back silently, info tells what was
+    // achieved. Freed on destruction.
+    class StreamingBuffer
+    {
+    public:
+        StreamingBuffer() : m_data(nullptr), m_info() {}
+        StreamingBuffer(size_t bytes, const StreamingMemorySettings& settings = StreamingMemorySettings());
+        ~StreamingBuffer();
+
+        StreamingBuffer(StreamingBuffer&& other) noexcept;
+        StreamingBuffer& operator=(StreamingBuffer&& other) noexcept;
+        StreamingBuffer(const StreamingBuffer&) = delete;
+        StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+        void* data() const { return m_data; }
+        size_t size() const { return m_info.bytes; }
+        const StreamingMemoryInfo& info() const { return m_info; }
+        explicit operator bool() const { return m_data != nullptr; }
+
+        void reset();
+
+    private:
+        void* m_data;
+        StreamingMemoryInfo m_info;
+    };
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "BenchmarkSupport.h"
+#include "LatencyHistogram.h"
+#include "StreamingMemory.h"
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Copies a stream of packet sized blocks into a large capture buffer, once
+// allocated from the heap and once as StreamingBuffer with huge pages,
+// pre-faulting and locking. Reports the first pass, which takes the page
+// faults of the heap buffer, the steady copy throughput, the latency of copies
+// to random places in the buffer, where TLB misses show, and random cache line
+// reads. Runs without a device; takes the buffer size in MiB and the random
+// copies.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    const size_t BlockBytes = 64 * 1024;       // about a raw IQ packet of 8192 samples
+
+    struct Result
+    {
+        double setupSeconds;
+        double firstPassGBs, steadyGBs;
+        LatencyHistogram copies;
+        double randomReadNs;
+    };
+
+    Result run(char* buffer, size_t bytes, double setupSeconds, const std::vector<char>& source, int randomCopies)
+    {
+        Result result;
+        result.setupSeconds = setupSeconds;
+        const size_t blocks = bytes / BlockBytes;
+
+        auto pass = [&]()
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < blocks; i++)
+                    std::memcpy(buffer + i * BlockBytes, source.data(), BlockBytes);
+                DoNotOptimize(buffer[0]);
+                return double(blocks * BlockBytes) / SecondsSince(start) / 1e9;
+            };
+        result.firstPassGBs = pass();
+        result.steadyGBs = 0;
+        for (int i = 0; i < 4; i++)
+            result.steadyGBs += pass() / 4;
+
+        std::mt19937_64 random(1);
+        for (int i = 0; i < randomCopies; i++)
+        {
+            char* target = buffer + random() % blocks * BlockBytes;
+            auto start = std::chrono::steady_clock::now();
+            std::memcpy(target, source.data(), BlockBytes);
+            DoNotOptimize(target[0]);
+            result.copies.add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        }
+
+        // Dependent loads, each on another page, mostly missing the TLB with small pages
+        const size_t lines = bytes / 64;
+        const int reads = 4 * 1000 * 1000;
+        uint64_t state = 1, sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < reads; i++)
+        {
+            // The next address depends on the loaded value, so the loads do not overlap
+            state = state * 6364136223846793005ull + 1442695040888963407ull + (sum & 1);
+            sum += uint64_t(buffer[(state >> 16) % lines * 64]);
+        }
+        result.randomReadNs = SecondsSince(start) / reads * 1e9;
+        DoNotOptimize(sum);
+        return result;
+    }
+
+    void print(const char* name, const Result& r)
+    {
+        std::cout << name << std::setw(9) << r.setupSeconds * 1e3 << std::setw(11) << r.firstPassGBs << std::setw(9) << r.steadyGBs
+            << std::setw(10) << r.copies.percentileNs(0.5) / 1e3 << std::setw(9) << r.copies.percentileNs(0.99) / 1e3
+            << std::setw(9) << r.copies.maxNs() / 1e3 << std::setw(10) << r.randomReadNs << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t bytes = NumberArgument<size_t>(argc, argv, 1, 512) * 1024 * 1024;
+    const int randomCopies = NumberArgument<int>(argc, argv, 2, 20000);
+
+    std::vector<char> source(BlockBytes);
+    for (size_t i = 0; i < source.size(); i++)
+        source[i] = char(i);
+
+    Result heap;
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<char[]> buffer(new char[bytes]);
+        heap = run(buffer.get(), bytes, SecondsSince(start), source, randomCopies);
+    }
+
+    Result streaming;
+    StreamingMemoryInfo info;
+    {
+        auto start = std::chrono::steady_clock::now();
+        StreamingBuffer buffer(bytes);
+        double setup = SecondsSince(start);
+        if (!buffer)
+        {
+            std::cerr << "Allocating the streaming buffer failed" << std::endl;
+            return -1;
+        }
+        info = buffer.info();
+        streaming = run(static_cast<char*>(buffer.data()), bytes, setup, source, randomCopies);
+    }
+
+    std::cout << "Buffer         : " << bytes / (1024 * 1024) << " MiB, " << BlockBytes / 1024 << " KiB blocks" << std::endl
+        << "StreamingBuffer: page " << info.pageSize / 1024 << " KiB, explicit huge pages " << (info.explicitHugePages ? "yes" : "no")
+        << ", transparent " << (info.transparentHugePages ? "yes" : "no") << " (" << info.hugeBytes / (1024 * 1024) << " MiB huge)"
+        << ", prefaulted " << (info.prefaulted ? "yes" : "no") << ", locked " << (info.locked ? "yes" : "no") << std::endl
+        << std::fixed << std::setprecision(2)
+        << "                 setup  first pass   steady   copy p50      p99      max  rand read" << std::endl
+        << "                    ms        GB/s     GB/s         us       us       us         ns" << std::endl;
+    print("Heap           ", heap);
+    print("StreamingBuffer", streaming);
+
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include "StringTranscoder.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WRAPPER_TRANSCODE_SSE2 1
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        const uint32_t ReplacementCharacter = 0xFFFD;
+
+        inline bool isContinuation(unsigned char c)
+        {
+            return (c & 0xC0) == 0x80;
+        }
+
+        // Decode one UTF-8 sequence starting at src[i], advances i
+        inline uint32_t decodeUtf8(const unsigned char* src, size_t length, size_t& i)
+        {
+            unsigned char c = src[i];
+            if (c < 0x80)
+            {
+                i += 1;
+                return c;
+            }
+            if ((c & 0xE0) == 0xC0 && i + 1 < length && isContinuation(src[i + 1]))
+            {
+                uint32_t cp = (uint32_t(c & 0x1F) << 6) | (src[i + 1] & 0x3F);
+                i += 2;
+                return cp >= 0x80 ? cp : ReplacementCharacter;
+            }
+            if ((c & 0xF0) == 0xE0 && i + 2 < length && isContinuation(src[i + 1]) && isContinuation(src[i + 2]))
+            {
+                uint32_t cp = (uint32_t(c & 0x0F) << 12) | (uint32_t(src[i + 1] & 0x3F) << 6) | (src[i + 2] & 0x3F);
+                i += 3;
+                return (cp >= 0x800 && (cp < 0xD800 || cp > 0xDFFF)) ? cp : ReplacementCharacter;
+            }
+            if ((c & 0xF8) == 0xF0 && i + 3 < length && isContinuation(src[i + 1]) && isContinuation(src[i + 2]) && isContinuation(src[i + 3]))
+            {
+                uint32_t cp = (uint32_t(c & 0x07) << 18) | (uint32_t(src[i + 1] & 0x3F) << 12) | (uint32_t(src[i + 2] & 0x3F) << 6) | (src[i + 3] & 0x3F);
+                i += 4;
+                return (cp >= 0x10000 && cp <= 0x10FFFF) ? cp : ReplacementCharacter;
+            }
+            i += 1;
+            return ReplacementCharacter;
+        }
+
+        // Decode one code point from a wchar_t string, advances i
+        inline uint32_t decodeWide(const wchar_t* src, size_t length, size_t& i)
+        {
+            uint32_t c = uint32_t(src[i]);
+            if (sizeof(wchar_t) == 2)
+            {
+                c &= 0xFFFF;
+                if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length)
+                {
+                    uint32_t low = uint32_t(src[i + 1]) & 0xFFFF;
+                    if (low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        i += 2;
+                        return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                }
+                i += 1;
+                return (c >= 0xD800 && c <= 0xDFFF) ? ReplacementCharacter : c;
+            }
+            i += 1;
+            return (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) ? ReplacementCharacter : c;
+        }
+
+#if defined(WRAPPER_TRANSCODE_SSE2)
+
+        // 16 ASCII bytes to 16 wchar_t
+        inline bool asciiBlockToWide(const char* src, wchar_t* dst)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            if (_mm_movemask_epi8(bytes) != 0)
+                return false;
+
+            __m128i zero = _mm_setzero_si128();
+            __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            __m128i* out = reinterpret_cast<__m128i*>(dst);
+            if (sizeof(wchar_t) == 2)
+            {
+                _mm_storeu_si128(out + 0, lo);
+                _mm_storeu_si128(out + 1, hi);
+            }
+            else
+            {
+                _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+            }
+            return true;
+        }
+
+        // 16 ASCII wchar_t to 16 bytes
+        inline bool asciiBlockToUtf8(const wchar_t* src, char* dst)
+        {
+            const __m128i* in = reinterpret_cast<const __m128i*>(src);
+            __m128i zero = _mm_setzero_si128();
+            __m128i bytes;
+            if (sizeof(wchar_t) == 2)
+            {
+                __m128i a = _mm_loadu_si128(in + 0), b = _mm_loadu_si128(in + 1);
+                __m128i high = _mm_srli_epi16(_mm_or_si128(a, b), 7);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+                    return false;
+                bytes = _mm_packus_epi16(a, b);
+            }
+            else
+            {
+                __m128i a = _mm_loadu_si128(in + 0), b = _mm_loadu_si128(in + 1);
+                __m128i c = _mm_loadu_si128(in + 2), d = _mm_loadu_si128(in + 3);
+                __m128i high = _mm_srli_epi32(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), 7);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF)
+                    return false;
+                bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bytes);
+            return true;
+        }
+
+#else
+
+        inline bool asciiBlockToWide(const char* src, wchar_t* dst)
+        {
+            uint64_t words[2];
+            std::memcpy(words, src, 16);
+            if ((words[0] | words[1]) & 0x8080808080808080ULL)
+                return false;
+            for (int k = 0; k < 16; k++)
+                dst[k] = wchar_t(static_cast<unsigned char>(src[k]));
+            return true;
+        }
+
+        inline bool asciiBlockToUtf8(const wchar_t* src, char* dst)
+        {
+            uint32_t bits = 0;
+            for (int k = 0; k < 16; k++)
+                bits |= uint32_t(src[k]);
+            if (bits >= 0x80)
+                return false;
+            for (int k = 0; k < 16; k++)
+                dst[k] = char(src[k]);
+            return true;
+        }
+
+#endif
+    }
+
+    size_t Utf8ToWide(const char* src, size_t srcLength, wchar_t* dst, size_t dstCapacity)
+    {
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+        size_t limit = dstCapacity ? dstCapacity - 1 : 0;
+        size_t i = 0, o = 0;
+
+        while (i < srcLength)
+        {
+            if (i + 16 <= srcLength && o + 16 <= limit && asciiBlockToWide(src + i, dst + o))
+            {
+                i += 16;
+                o += 16;
+                continue;
+            }
+
+            uint32_t cp = decodeUtf8(in, srcLength, i);
+            if (sizeof(wchar_t) == 2 && cp >= 0x10000)
+            {
+                cp -= 0x10000;
+                if (o + 1 < limit)
+                {
+                    dst[o] = wchar_t(0xD800 + (cp >> 10));
+                    dst[o + 1] = wchar_t(0xDC00 + (cp & 0x3FF));
+                }
+                else
+                    limit = o < limit ? o : limit;  // never split a surrogate pair
+                o += 2;
+            }
+            else
+            {
+                if (o < limit)
+                    dst[o] = wchar_t(cp);
+                o += 1;
+            }
+        }
+
+        if (dstCapacity)
+            dst[o < limit ? o : limit] = 0;
+        return o;
+    }
+
+    size_t WideToUtf8(const wchar_t* src, size_t srcLength, char* dst, size_t dstCapacity)
+    {
+        size_t limit = dstCapacity ? dstCapacity - 1 : 0;
+        size_t i = 0, o = 0;
+
+        while (i < srcLength)
+        {
+            if (i + 16 <= srcLength && o + 16 <= limit && asciiBlockToUtf8(src + i, dst + o))
+            {
+                i += 16;
+                o += 16;
+                continue;
+            }
+
+            uint32_t cp = decodeWide(src, srcLength, i);
+            char bytes[4];
+            size_t n;
+            if (cp < 0x80)
+            {
+                bytes[0] = char(cp);
+                n = 1;
+            }
+            else if (cp < 0x800)
+            {
+                bytes[0] = char(0xC0 | (cp >> 6));
+                bytes[1] = char(0x80 | (cp & 0x3F));
+                n = 2;
+            }
+            else if (cp < 0x10000)
+            {
+                bytes[0] = char(0xE0 | (cp >> 12));
+                bytes[1] = char(0x80 | ((cp >> 6) & 0x3F));
+                bytes[2] = char(0x80 | (cp & 0x3F));
+                n = 3;
+            }
+            else
+            {
+                bytes[0] = char(0xF0 | (cp >> 18));
+                bytes[1] = char(0x80 | ((cp >> 12) & 0x3F));
+                bytes[2] = char(0x80 | ((cp >> 6) & 0x3F));
+                bytes[3] = char(0x80 | (cp & 0x3F));
+                n = 4;
+            }
+
+            // Never write a partial sequence
+            if (o + n <= limit)
+                std::memcpy(dst + o, bytes, n);
+            else
+                limit = o < limit ? o : limit;
+            o += n;
+        }
+
+        if (dstCapacity)
+            dst[o < limit ? o : limit] = 0;
+        return o;
+    }
+
+    size_t WideLength(const wchar_t* src, size_t capacity)
+    {
+        size_t len = 0;
+        while (len < capacity && src[len] != L'\0')
+            len++;
+        return len;
+    }
+
+    void WideToUtf8(const wchar_t* src, size_t srcLength, std::string& dst)
+    {
+        // ASCII needs one byte per code unit, try the existing capacity first
+        size_t capacity = dst.capacity() > srcLength ? dst.capacity() : srcLength;
+        dst.resize(capacity);
+        size_t needed = WideToUtf8(src, srcLength, &dst[0], capacity + 1);
+        if (needed > capacity)
+        {
+            dst.resize(needed);
+            WideToUtf8(src, srcLength, &dst[0], needed + 1);
+        }
+        dst.resize(needed);
+    }
+}
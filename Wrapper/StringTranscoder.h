@@ -0,0 +1,61 @@
+#ifndef STRINGTRANSCODER_H
+#define STRINGTRANSCODER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // UTF-8 <-> wchar_t transcoding into caller supplied buffers. wchar_t is UTF-32 on
+    // Linux and UTF-16 on Windows. Runs of ASCII, which covers nearly all config names,
+    // values and option lists, are converted 16 characters at a time with SSE2 where
+    // available. Malformed input is replaced by U+FFFD instead of failing the call.
+    //
+    // Both conversions behave like snprintf: at most dstCapacity - 1 code units are
+    // written followed by a terminating zero, and the return value is the number of
+    // code units the complete conversion needs, excluding the terminator. A result
+    // >= dstCapacity means the output was truncated.
+
+    size_t Utf8ToWide(const char* src, size_t srcLength, wchar_t* dst, size_t dstCapacity);
+    size_t WideToUtf8(const wchar_t* src, size_t srcLength, char* dst, size_t dstCapacity);
+
+    // Length of a zero terminated wchar_t string in a fixed size SDK array
+    size_t WideLength(const wchar_t* src, size_t capacity);
+
+    // Converts into an existing string, reusing its capacity
+    void WideToUtf8(const wchar_t* src, size_t srcLength, std::string& dst);
+
+    // Zero terminated wide copy of a UTF-8 string for passing to the SDK. Short strings
+    // stay in the inline buffer, longer ones fall back to the heap.
+    class WideStringBuffer
+    {
+    public:
+        explicit WideStringBuffer(const std::string& str)
+            : m_ptr(m_inline)
+        {
+            size_t needed = Utf8ToWide(str.data(), str.size(), m_inline, InlineCapacity);
+            if (needed >= InlineCapacity)
+            {
+                m_heap.resize(needed + 1);
+                Utf8ToWide(str.data(), str.size(), m_heap.data(), m_heap.size());
+                m_ptr = m_heap.data();
+            }
+        }
+
+        WideStringBuffer(const WideStringBuffer&) = delete;
+        WideStringBuffer& operator=(const WideStringBuffer&) = delete;
+
+        const wchar_t* c_str() const { return m_ptr; }
+
+    private:
+        static const size_t InlineCapacity = 256;
+
+        wchar_t m_inline[InlineCapacity];
+        std::vector<wchar_t> m_heap;
+        const wchar_t* m_ptr;
+    };
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "ThreadPolicy.h"
+#include "LatencyHistogram.h"
+#include <cerrno>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace AarRtsaSdkWrapper
+{
+
+    namespace
+    {
+        bool pinCurrentThread(int cpu)
+        {
+            if (cpu < 0)
+                return true;
+#if defined(_WIN32)
+            return cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+            return false;
+#endif
+        }
+
+        bool setRealtimePriority(int priority)
+        {
+            if (priority <= 0)
+                return true;
+#if defined(_WIN32)
+            return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+            sched_param param = {};
+            int lowest = sched_get_priority_min(SCHED_FIFO), highest = sched_get_priority_max(SCHED_FIFO);
+            param.sched_priority = priority < lowest ? lowest : (priority > highest ? highest : priority);
+            return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+        }
+
+        bool lockMemory(bool lock)
+        {
+            if (!lock)
+                return true;
+#if defined(_WIN32)
+            // VirtualLock works per range only, buffers have to lock themselves
+            return false;
+#else
+            return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#endif
+        }
+
+        bool nameCurrentThread(const std::string& name)
+        {
+            if (name.empty())
+                return true;
+#if defined(__linux__)
+            // Linux limits thread names to 15 characters
+            return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#elif defined(__APPLE__)
+            return pthread_setname_np(name.c_str()) == 0;
+#else
+            return false;
+#endif
+        }
+
+        void sleepUntil(std::chrono::steady_clock::time_point deadline)
+        {
+#if defined(__linux__)
+            // Absolute monotonic sleep, steady_clock is CLOCK_MONOTONIC with libstdc++ and libc++
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            timespec ts;
+            ts.tv_sec = time_t(ns / 1000000000);
+            ts.tv_nsec = long(ns % 1000000000);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+                ;
+#else
+            std::this_thread::sleep_until(deadline);
+#endif
+        }
+    }
+
+    ThreadPolicyResult ApplyThreadPolicy(const ThreadPolicy& policy)
+    {
+        ThreadPolicyResult result;
+        result.pinned = pinCurrentThread(policy.cpu);
+        result.realtime = setRealtimePriority(policy.realtimePriority);
+        result.memoryLocked = lockMemory(policy.lockMemory);
+        result.named = nameCurrentThread(policy.name);
+        return result;
+    }
+
+    bool Succeeded(const ThreadPolicyResult& result)
+    {
+        return result.pinned && result.realtime && result.memoryLocked && result.named;
+    }
+
+    ThreadSwitches CurrentThreadSwitches()
+    {
+        ThreadSwitches switches = {};
+#if defined(__linux__)
+        rusage usage;
+        if (getrusage(RUSAGE_THREAD, &usage) == 0)
+        {
+            switches.voluntary = uint64_t(usage.ru_nvcsw);
+            switches.involuntary = uint64_t(usage.ru_nivcsw);
+        }
+#endif
+        return switches;
+    }
+
+    SchedulingLatencyReport MeasureSchedulingLatency(std::chrono::nanoseconds duration, std::chrono::nanoseconds period)
+    {
+        LatencyHistogram histogram;
+        ThreadSwitches before = CurrentThreadSwitches();
+
+        auto start = std::chrono::steady_clock::now();
+        auto end = start + duration;
+        for (auto deadline = start + period; deadline < end; deadline += period)
+        {
+            sleepUntil(deadline);
+            auto late = std::chrono::steady_clock::now() - deadline;
+            histogram.add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(late).count()));
+        }
+
+        ThreadSwitches after = CurrentThreadSwitches();
+        SchedulingLatencyReport report;
+        report.wakeups = histogram.count();
+        report.meanNs = histogram.meanNs();
+        report.p50Ns = histogram.percentileNs(0.5);
+        report.p99Ns = histogram.percentileNs(0.99);
+        report.maxNs = histogram.maxNs();
+        report.switches.voluntary = after.voluntary - before.voluntary;
+        report.switches.involuntary = after.involuntary - before.involuntary;
+        return report;
+    }
+}
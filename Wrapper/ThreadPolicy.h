@@ -0,0 +1,65 @@
+#ifndef THREADPOLICY_H
+#define THREADPOLICY_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace AarRtsaSdkWrapper
+{
+
+    // Scheduling of a streaming thread: acquisition, processing or transmit
+    struct ThreadPolicy
+    {
+        int cpu;                    // core to pin the thread to, -1 to let it migrate
+        int realtimePriority;       // SCHED_FIFO priority 1..99 (time critical on Windows), 0 for normal scheduling
+        bool lockMemory;            // lock all current and future pages of the process into RAM
+        std::string name;           // shown by top, perf and debuggers, empty to keep
+
+        ThreadPolicy() : cpu(-1), realtimePriority(0), lockMemory(false) {}
+    };
+
+    // What ApplyThreadPolicy could set, the rest usually lacks privileges
+    // (CAP_SYS_NICE, RLIMIT_RTPRIO or RLIMIT_MEMLOCK on Linux)
+    struct ThreadPolicyResult
+    {
+        bool pinned;
+        bool realtime;
+        bool memoryLocked;
+        bool named;
+    };
+
+    // Applies the policy to the calling thread. Parts that are not requested
+    // count as applied.
+    ThreadPolicyResult ApplyThreadPolicy(const ThreadPolicy& policy);
+
+    bool Succeeded(const ThreadPolicyResult& result);
+
+    // Context switches of the calling thread since it started. Involuntary ones
+    // mean the scheduler took the core away, voluntary ones that the thread
+    // blocked or slept. Zero where the platform has no per thread counters.
+    struct ThreadSwitches
+    {
+        uint64_t voluntary;
+        uint64_t involuntary;
+    };
+
+    ThreadSwitches CurrentThreadSwitches();
+
+    struct SchedulingLatencyReport
+    {
+        uint64_t wakeups;
+        double meanNs;
+        uint64_t p50Ns, p99Ns, maxNs;       // lateness of the wake ups
+        ThreadSwitches switches;            // during the measurement
+    };
+
+    // Measurement mode: sleeps on the calling thread until the next period for
+    // the given duration and records how late each wake up comes, like
+    // cyclictest. Run it on a thread with the policy of the streaming thread,
+    // under the load it will see, to check the policy.
+    SchedulingLatencyReport MeasureSchedulingLatency(std::chrono::nanoseconds duration,
+        std::chrono::nanoseconds period = std::chrono::milliseconds(1));
+}
+
+#endif
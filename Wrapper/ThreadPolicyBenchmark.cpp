@@ -0,0 +1,80 @@
+#include "BenchmarkSupport.h"
+#include "ThreadPolicy.h"
+#include <atomic>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+// Scheduling latency and involuntary context switches of a thread waking up every
+// millisecond, like a streaming loop polling the SDK queue. Once on an idle
+// machine, then with a busy thread on every core, with the default policy and
+// with the thread pinned and on SCHED_FIFO. Runs without a device; takes the
+// seconds per run and the real-time priority. Without the privilege for
+// SCHED_FIFO the last run only pins the thread.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    SchedulingLatencyReport measure(const ThreadPolicy& policy, std::chrono::nanoseconds duration, bool& applied)
+    {
+        SchedulingLatencyReport report;
+        std::thread thread([&]()
+            {
+                applied = Succeeded(ApplyThreadPolicy(policy));
+                report = MeasureSchedulingLatency(duration);
+            });
+        thread.join();
+        return report;
+    }
+
+    void print(const char* name, const SchedulingLatencyReport& report)
+    {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(9) << report.p50Ns / 1e3 << std::setw(9) << report.p99Ns / 1e3 << std::setw(10) << report.maxNs / 1e3
+            << std::setw(12) << report.switches.involuntary << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double seconds = NumberArgument<double>(argc, argv, 1, 2.0);
+    const int priority = NumberArgument<int>(argc, argv, 2, 50);
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(seconds));
+
+    ThreadPolicy normal;
+    normal.name = "latency";
+    ThreadPolicy realtime = normal;
+    realtime.cpu = 0;
+    realtime.realtimePriority = priority;
+
+    bool applied;
+    std::cout << "Wake up lateness in us  p50      p99       max  involuntary" << std::endl;
+    print("Idle, default", measure(normal, duration, applied));
+
+    // A competing busy thread per core, like a renderer or other processing
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> load;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < cores; i++)
+    {
+        load.emplace_back([&]()
+            {
+                uint64_t spins = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                    DoNotOptimize(++spins);
+            });
+    }
+
+    print("Loaded, default", measure(normal, duration, applied));
+    SchedulingLatencyReport pinned = measure(realtime, duration, applied);
+    print(applied ? "Loaded, pinned FIFO" : "Loaded, pinned only", pinned);
+
+    stop = true;
+    for (std::thread& thread : load)
+        thread.join();
+
+    if (!applied)
+        std::cout << "SCHED_FIFO was refused, run with CAP_SYS_NICE or a raised RLIMIT_RTPRIO" << std::endl;
+    return 0;
+}
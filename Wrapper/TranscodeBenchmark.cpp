@@ -0,0 +1,148 @@
+#include "BenchmarkSupport.h"
+#include "StringTranscoder.h"
+#include <algorithm>
+#include <codecvt>
+#include <iomanip>
+#include <locale>
+#include <type_traits>
+#include <vector>
+
+// Compares the std::wstring_convert conversion the wrapper used before with the
+// allocation free transcoder, on the kind of strings passing through the wrapper:
+// config paths, values, units and option lists. Checks the transcoder against it
+// first, and its truncation into short buffers of input ending in code points
+// beyond the BMP. Runs without a device.
+
+using namespace AarRtsaSdkWrapper;
+
+namespace
+{
+    // UTF-16 for a 2 byte wchar_t, UTF-32 otherwise, like the transcoder
+    typedef std::conditional_t<sizeof(wchar_t) == 2, std::codecvt_utf8_utf16<wchar_t>, std::codecvt_utf8<wchar_t>> ReferenceCodecvt;
+
+    std::wstring referenceToWide(const std::string& str)
+    {
+        std::wstring_convert<ReferenceCodecvt> converter;
+        return converter.from_bytes(str);
+    }
+
+    std::string referenceToUtf8(const std::wstring& wstr)
+    {
+        std::wstring_convert<ReferenceCodecvt> converter;
+        return converter.to_bytes(wstr);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations = NumberArgument<int>(argc, argv, 1, 200000);
+
+    const std::vector<std::string> corpus = {
+        "main/centerfreq",
+        "main/demodcenterfreq",
+        "device/receiverclock",
+        "device/fft0/fftmergemode",
+        "device/outputformat",
+        "Iq",
+        "92MHz",
+        "dBm",
+        "\xC2\xB0" "C",
+        "\xC2\xB5s",
+        "92MHz;122MHz;184MHz;245MHz;491MHz;76MHz;61MHz;46MHz",
+        "Hamming;Hann;Uniform;Blackman;Blackman Harris;Blackman Harris 7;Flat Top;Kaiser 3;Kaiser 4;Kaiser 5;Kaiser 6;Kaiser 7;Kaiser 8;Kaiser 9;Kaiser 10;Kaiser 11;Kaiser 12",
+        "Auto;Off;Low Pass 6GHz;Low Pass 3GHz;Low Pass 2GHz;Low Pass 1GHz;Low Pass 500MHz;Band Pass 2.4GHz ISM;Band Pass 5GHz ISM",
+    };
+
+    // Check the transcoder against the reference before timing it
+
+    std::vector<std::wstring> wideCorpus;
+    size_t bytes = 0;
+    for (const std::string& str : corpus)
+    {
+        std::wstring expected = referenceToWide(str);
+        wideCorpus.push_back(expected);
+        bytes += str.size();
+
+        if (AaroniaRtsaSdkWrapper::string_to_wstring(str) != expected || AaroniaRtsaSdkWrapper::wstring_to_string(expected) != str)
+        {
+            std::cerr << "Transcoder mismatch for \"" << str << "\"" << std::endl;
+            return -1;
+        }
+    }
+
+    // Truncation into short buffers, also of input ending in a code point
+    // beyond the BMP, a surrogate pair with a 2 byte wchar_t: the longest
+    // prefix of whole code points, terminated within the capacity
+
+    const std::vector<std::string> overlong = {
+        "aaaaaaaaaa\xF0\x9F\x98\x80",
+        "device/fft0/fftmergemode \xF0\x9F\x98\x80",
+        "\xC2\xB5s \xF0\x9F\x98\x80\xF0\x9F\x98\x80",
+    };
+    for (const std::string& str : overlong)
+    {
+        std::wstring expected = referenceToWide(str);
+        for (size_t capacity = 1; capacity <= expected.size() + 1; capacity++)
+        {
+            std::vector<wchar_t> buffer(capacity + 4, L'#');
+            size_t length = Utf8ToWide(str.data(), str.size(), buffer.data(), capacity);
+            size_t kept = std::min(expected.size(), capacity - 1);
+            if (kept > 0 && kept < expected.size() && expected[kept - 1] >= 0xD800 && expected[kept - 1] < 0xDC00)
+                kept--;
+            auto end = std::find(buffer.begin(), buffer.begin() + std::ptrdiff_t(capacity), L'\0');
+            if (length != expected.size() || end == buffer.begin() + std::ptrdiff_t(capacity)
+                || std::wstring(buffer.begin(), end) != expected.substr(0, kept) || buffer[capacity] != L'#')
+            {
+                std::cerr << "Transcoder truncation mismatch for \"" << str << "\" into " << capacity << " units" << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    // Reference conversion, one converter and two allocations per call
+
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (size_t k = 0; k < corpus.size(); k++)
+        {
+            std::wstring wide = referenceToWide(corpus[k]);
+            std::string narrow = referenceToUtf8(wideCorpus[k]);
+            checksum += wide.size() + narrow.size();
+        }
+    }
+    double reference = SecondsSince(start);
+
+    // Transcoder into reused buffers
+
+    wchar_t wideBuffer[256];
+    std::string narrow;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (size_t k = 0; k < corpus.size(); k++)
+        {
+            size_t wideLength = Utf8ToWide(corpus[k].data(), corpus[k].size(), wideBuffer, 256);
+            WideToUtf8(wideCorpus[k].data(), wideCorpus[k].size(), narrow);
+            checksum -= wideLength + narrow.size();
+        }
+    }
+    double transcoder = SecondsSince(start);
+    DoNotOptimize(checksum);
+
+    if (checksum != 0)
+    {
+        std::cerr << "Checksum mismatch" << std::endl;
+        return -1;
+    }
+
+    double conversions = 2.0 * iterations * corpus.size();
+    double megabytes = 2.0 * iterations * bytes / 1.0e6;
+    std::cout << std::fixed << std::setprecision(1)
+        << "std::wstring_convert : " << reference / conversions * 1e9 << " ns/string, " << megabytes / reference << " MB/s" << std::endl
+        << "StringTranscoder     : " << transcoder / conversions * 1e9 << " ns/string, " << megabytes / transcoder << " MB/s" << std::endl
+        << "Speedup              : " << reference / transcoder << "x" << std::endl;
+
+    return 0;
+}
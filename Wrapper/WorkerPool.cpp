@@ -0,0 +1,90 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+namespace AarRtsaSdkWrapper
+{
+
+    WorkerPool::WorkerPool(const WorkerPoolSettings& settings)
+        : m_generation(0), m_busy(0), m_stop(false), m_task(nullptr), m_count(0), m_next(0), m_policiesApplied(0)
+    {
+        size_t threads = settings.threads;
+        if (threads == 0)
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+        for (size_t i = 1; i < threads; i++)
+        {
+            ThreadPolicy policy = settings.thread;
+            policy.cpu = settings.cpus.empty() ? -1 : settings.cpus[(i - 1) % settings.cpus.size()];
+            m_workers.emplace_back([this, policy]()
+                {
+                    if (Succeeded(ApplyThreadPolicy(policy)))
+                        m_policiesApplied.fetch_add(1);
+                    run();
+                });
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (std::thread& worker : m_workers)
+            worker.join();
+    }
+
+    void WorkerPool::runTasks()
+    {
+        for (size_t i; (i = m_next.fetch_add(1, std::memory_order_relaxed)) < m_count;)
+            (*m_task)(i);
+    }
+
+    void WorkerPool::run()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;)
+        {
+            m_start.wait(lock, [&]() { return m_stop || m_generation != seen; });
+            if (m_stop)
+                return;
+            seen = m_generation;
+
+            lock.unlock();
+            runTasks();
+            lock.lock();
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+
+    void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+    {
+        if (count == 0)
+            return;
+        if (m_workers.empty() || count == 1)
+        {
+            for (size_t i = 0; i < count; i++)
+                task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_task = &task;
+            m_count = count;
+            m_next.store(0, std::memory_order_relaxed);
+            m_busy = m_workers.size();
+            m_generation++;
+        }
+        m_start.notify_all();
+        runTasks();
+
+        // Every worker has to see this call through before the task goes away
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_done.wait(lock, [&]() { return m_busy == 0; });
+        m_task = nullptr;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include "ThreadPolicy.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AarRtsaSdkWrapper
+{
+
+    struct WorkerPoolSettings
+    {
+        size_t threads;             // including the calling thread, 0 for one per core
+        ThreadPolicy thread;        // applied to every worker, cpu is taken from cpus
+        std::vector<int> cpus;      // cores of worker 1, 2, ..., repeated; empty for none
+
+        WorkerPoolSettings() : threads(0) {}
+        explicit WorkerPoolSettings(size_t threads) : threads(threads) {}
+    };
+
+    // Fixed set of threads for the processing stages that split a block of
+    // work into independent tasks, e.g. one per channel or per FFT frame. The
+    // calling thread takes part, so a pool of one thread runs everything
+    // inline. One parallelFor at a time; tasks must not call parallelFor.
+    class WorkerPool
+    {
+    public:
+        explicit WorkerPool(const WorkerPoolSettings& settings = WorkerPoolSettings());
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        size_t threads() const { return m_workers.size() + 1; }
+
+        // Calls task(i) for every i below count, spread over the threads, and
+        // returns when all calls returned. Tasks are handed out one at a time,
+        // so uneven tasks balance.
+        void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+        // Workers whose thread policy took effect completely
+        size_t policiesApplied() const { return m_policiesApplied.load(); }
+
+    private:
+        void run();
+        void runTasks();
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_lock;
+        std::condition_variable m_start, m_done;
+        uint64_t m_generation;                      // under m_lock, counts parallelFor calls
+        size_t m_busy;                              // under m_lock, workers still in the current call
+        bool m_stop;                                // under m_lock
+        const std::function<void(size_t)>* m_task;
+        size_t m_count;
+        std::atomic<size_t> m_next;
+        std::atomic<size_t> m_policiesApplied;
+    };
+}
+
+#endif
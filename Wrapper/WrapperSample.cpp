@@ -40,8 +40,10 @@ void TreeConfig(AarRtsaSdkWrapper::AaroniaRtsaSdkWrapper& sdkWrapper, AARTSAAPI_
 
 
 
-int main() {
-    AarRtsaSdkWrapper::AaroniaRtsaSdkWrapper sdkWrapper(CFG_AARONIA_SDK_DIRECTORY);
+int main(int argc, char* argv[]) {
+    // Optional first argument: path of the RTSA API library or its directory,
+    // e.g. the build output of the simulated backend
+    AarRtsaSdkWrapper::AaroniaRtsaSdkWrapper sdkWrapper(argc > 1 ? argv[1] : CFG_AARONIA_SDK_DIRECTORY);
 
     if (!sdkWrapper.isSuccessfullyLoaded()) {
         std::cerr << "Failed to load Aaronia RTSA SDK library." << std::endl;
@@ -133,5 +135,11 @@ int main() {
     sdkWrapper.Close(&SdkHandle);
     sdkWrapper.Shutdown();  
 
+    if (AarRtsaSdkWrapper::CallProfiler::enabled())
+    {
+        std::cout << std::endl << "SDK CALLS:" << std::endl;
+        AarRtsaSdkWrapper::CallProfiler::dump(std::cout);
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,9 @@
+#ifndef HELPER_H
+#define HELPER_H
+
+#define CFG_AARONIA_RTSA_INSTALL_DIRECTORY "/opt/aaronia-rtsa-suite/Aaronia-RTSA-Suite-PRO"
+#define CFG_AARONIA_XML_LOOKUP_DIRECTORY "/opt/aaronia-rtsa-suite/Aaronia-RTSA-Suite-PRO"
+#define CFG_CPP_RTSAAPI_DLIB "libAaroniaRTSAAPI.so"
+#define CFG_AARONIA_SDK_DIRECTORY "/tmp/sdkroot"
+
+#endif